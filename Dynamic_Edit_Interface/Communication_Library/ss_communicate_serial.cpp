@@ -62,7 +62,17 @@ void CommunicateSerial::SetDataCallback(DataCallback callback)
     impl_->SetDataCallback(callback);
 }
 
+void CommunicateSerial::SetRxBufferCallback(RxBufferCallback callback)
+{
+    impl_->SetRxBufferCallback(callback);
+}
+
 void CommunicateSerial::SetErrorCallback(ErrorCallback callback)
 {
     impl_->SetErrorCallback(callback);
 }
+
+CommunicateStats CommunicateSerial::GetStats() const
+{
+    return impl_->GetStats();
+}
@@ -24,7 +24,9 @@ public:
     ConnectionInfo GetCommunicateInfo() override;
 
     void SetDataCallback(DataCallback callback) override;
+    void SetRxBufferCallback(RxBufferCallback callback) override;
     void SetErrorCallback(ErrorCallback callback) override;
+    CommunicateStats GetStats() const override;
 
 private:
     std::shared_ptr<CommunicateSerialPrivate> impl_;
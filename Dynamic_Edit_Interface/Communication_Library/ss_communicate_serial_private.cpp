@@ -2,6 +2,10 @@
 #include <iostream>
 #include <chrono>
 
+#ifndef _WIN32
+#include <poll.h>
+#endif
+
 using namespace boost::asio;
 
 CommunicateSerialPrivate::CommunicateSerialPrivate()
@@ -90,6 +94,7 @@ bool CommunicateSerialPrivate::Connect(ConnectionInfo connect_info)
         }
 
         connected_.store(true);
+        stats_.OnConnected();
 
         if (!is_running_.load())
         {
@@ -150,18 +155,22 @@ int64_t CommunicateSerialPrivate::WriteData(const char* data, int64_t len)
 
     try
     {
+        const auto t0 = std::chrono::steady_clock::now();
         boost::system::error_code ec;
         const size_t n = write(serial_, buffer(data, (size_t)len), ec);
         if (ec)
         {
+            stats_.OnWriteError();
             if (error_call_back_)
                 error_call_back_(ec.value(), "Serial write failed: " + ec.message());
             return -1;
         }
+        stats_.OnWrite(n, CommunicateStatsCounters::ElapsedUs(t0));
         return (int64_t)n;
     }
     catch (const std::exception& e)
     {
+        stats_.OnWriteError();
         if (error_call_back_)
             error_call_back_(-1, std::string("Serial write exception: ") + e.what());
         return -1;
@@ -176,6 +185,22 @@ ConnectionInfo CommunicateSerialPrivate::GetCommunicateInfo()
 void CommunicateSerialPrivate::SetDataCallback(DataCallback callback)
 {
     data_call_back_ = callback;
+    if (!callback)
+    {
+        rx_buffer_call_back_ = nullptr;
+        return;
+    }
+
+    // 旧接口：在缓冲池回调之上做一次拷贝适配
+    rx_buffer_call_back_ = [callback](const std::string& peer_id, const CommunicateRxBufferPtr& buffer) {
+        callback(peer_id, std::vector<char>(buffer->data(), buffer->data() + buffer->size()));
+    };
+}
+
+void CommunicateSerialPrivate::SetRxBufferCallback(RxBufferCallback callback)
+{
+    data_call_back_ = nullptr;
+    rx_buffer_call_back_ = callback;
 }
 
 void CommunicateSerialPrivate::SetErrorCallback(ErrorCallback callback)
@@ -183,10 +208,13 @@ void CommunicateSerialPrivate::SetErrorCallback(ErrorCallback callback)
     error_call_back_ = callback;
 }
 
-void CommunicateSerialPrivate::ReceiveLoop_()
+CommunicateStats CommunicateSerialPrivate::GetStats() const
 {
-    std::array<char, 4096> buffer;
+    return stats_.Snapshot();
+}
 
+void CommunicateSerialPrivate::ReceiveLoop_()
+{
     while (is_running_.load())
     {
         if (!IsConnected())
@@ -197,11 +225,25 @@ void CommunicateSerialPrivate::ReceiveLoop_()
 
         try
         {
+#ifndef _WIN32
+            // POSIX 下另一线程 close 不会唤醒阻塞中的 read：先带超时等可读，保证析构能 join
+            pollfd pfd{};
+            pfd.fd = serial_.native_handle();
+            pfd.events = POLLIN;
+            if (::poll(&pfd, 1, 100) <= 0)
+                continue;
+            if (!is_running_.load() || !IsConnected())
+                continue;
+#endif
+            // 每次读取从池里取一块，回调方持有期间不会被复写
+            std::shared_ptr<CommunicateRxBuffer> block = rx_pool_.Acquire();
+
             boost::system::error_code ec;
-            const size_t bytes = serial_.read_some(boost::asio::buffer(buffer), ec);
+            const size_t bytes = serial_.read_some(boost::asio::buffer(block->WritableData(), block->Capacity()), ec);
 
             if (ec)
             {
+                stats_.OnReadError();
                 if (error_call_back_)
                     error_call_back_(ec.value(), "Serial read failed: " + ec.message());
 
@@ -210,11 +252,14 @@ void CommunicateSerialPrivate::ReceiveLoop_()
                 continue;
             }
 
-            if (bytes > 0 && data_call_back_)
+            if (bytes > 0)
+                stats_.OnRead(bytes);
+
+            if (bytes > 0 && rx_buffer_call_back_)
             {
-                std::vector<char> vec_tmp(buffer.begin(), buffer.begin() + bytes);
+                block->SetSize(bytes);
                 // 串口没 ip，给个固定标识
-                data_call_back_(connect_info_.com_port_, vec_tmp);
+                rx_buffer_call_back_(connect_info_.com_port_, block);
             }
         }
         catch (const std::exception& e)
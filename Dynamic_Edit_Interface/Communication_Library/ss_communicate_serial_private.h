@@ -27,10 +27,14 @@ public:
     ConnectionInfo GetCommunicateInfo();
 
     void SetDataCallback(DataCallback callback);
+    void SetRxBufferCallback(RxBufferCallback callback);
     void SetErrorCallback(ErrorCallback callback);
 
+    CommunicateStats GetStats() const;
+
 public:
     DataCallback data_call_back_;
+    RxBufferCallback rx_buffer_call_back_;
     ErrorCallback error_call_back_;
     ConnectionInfo connect_info_;
 
@@ -45,4 +49,10 @@ private:
     std::shared_ptr<std::thread> read_thread_;
     std::atomic_bool is_running_{ false };
     std::atomic_bool connected_{ false };
+
+    // 接收缓冲池（接收线程独占 Acquire）
+    CommunicateRxBufferPool rx_pool_;
+
+    // 收发统计（写线程 / 接收线程直接累加）
+    CommunicateStatsCounters stats_;
 };
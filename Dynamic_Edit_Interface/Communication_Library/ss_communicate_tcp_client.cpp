@@ -65,7 +65,17 @@ void CommunicateTcpClient::SetDataCallback(DataCallback callback)
     communicate_tcp_client_impl_->SetDataCallback(callback);
 }
 
+void CommunicateTcpClient::SetRxBufferCallback(RxBufferCallback callback)
+{
+    communicate_tcp_client_impl_->SetRxBufferCallback(callback);
+}
+
 void CommunicateTcpClient::SetErrorCallback(ErrorCallback callback)
 {
     communicate_tcp_client_impl_->SetErrorCallback(callback);
 }
+
+CommunicateStats CommunicateTcpClient::GetStats() const
+{
+    return communicate_tcp_client_impl_->GetStats();
+}
@@ -20,7 +20,9 @@ public:
     virtual int64_t WriteData(const char* data, int64_t len) override;
     virtual ConnectionInfo GetCommunicateInfo() override;
     virtual void SetDataCallback(DataCallback callback) override;
+    virtual void SetRxBufferCallback(RxBufferCallback callback) override;
     virtual void SetErrorCallback(ErrorCallback callback) override;
+    virtual CommunicateStats GetStats() const override;
 private:
     std::shared_ptr<CommunicateTcpClientPrivate> communicate_tcp_client_impl_;
 };
@@ -2,6 +2,14 @@
 
 #include <iostream>
 
+#ifdef __linux__
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#endif
+
 using boost::asio::ip::tcp;
 
 CommunicateTcpClientPrivate::CommunicateTcpClientPrivate()
@@ -44,32 +52,49 @@ bool CommunicateTcpClientPrivate::Connect(ConnectionInfo connect_info)
         // 先断开旧连接
         Disconnect();
 
-        tcp::resolver resolver(io_context_);
         boost::system::error_code ec;
 
-        auto endpoints = resolver.resolve(connect_info_.ip_, std::to_string(connect_info_.port_), ec);
-        if (ec)
+        if (connect_info_.connect_timeout_ms_ > 0)
         {
-            ReportError_(ec.value(), "TCP resolve failed: " + ec.message());
-            connected_.store(false);
-            return false;
+            if (!TimedConnect_(connect_info_.connect_timeout_ms_, ec))
+            {
+                ReportError_(ec.value(), "TCP connect failed: " + ec.message());
+                connected_.store(false);
+                return false;
+            }
         }
-
-        boost::asio::connect(socket_, endpoints, ec);
-        if (ec)
+        else
         {
-            ReportError_(ec.value(), "TCP connect failed: " + ec.message());
-            connected_.store(false);
-            return false;
+            tcp::resolver resolver(io_context_);
+
+            auto endpoints = resolver.resolve(connect_info_.ip_, std::to_string(connect_info_.port_), ec);
+            if (ec)
+            {
+                ReportError_(ec.value(), "TCP resolve failed: " + ec.message());
+                connected_.store(false);
+                return false;
+            }
+
+            boost::asio::connect(socket_, endpoints, ec);
+            if (ec)
+            {
+                ReportError_(ec.value(), "TCP connect failed: " + ec.message());
+                connected_.store(false);
+                return false;
+            }
         }
 
+        ApplySocketOptions_();
+
         connected_.store(true);
+        stats_.OnConnected();
 
         if (!is_running_.load())
         {
             is_running_.store(true);
             read_thread_.reset(new std::thread(&CommunicateTcpClientPrivate::ReceiveLoop_, this));
         }
+        ApplyIoAffinity_();
 
         std::cout << "TCP Client connected: " << connect_info_.ip_ << ":" << connect_info_.port_ << std::endl;
         return true;
@@ -82,6 +107,62 @@ bool CommunicateTcpClientPrivate::Connect(ConnectionInfo connect_info)
     }
 }
 
+bool CommunicateTcpClientPrivate::TimedConnect_(int timeout_ms, boost::system::error_code& out_ec)
+{
+    // 异步解析 + 连接，只在当前线程跑 io_context_，到期即放弃
+    // 超时后仍卡在系统解析里的回调由 abandoned 挡住，之后再跑到也不会碰 socket_
+    struct State
+    {
+        bool done = false;
+        bool abandoned = false;
+        boost::system::error_code ec;
+    };
+    auto state = std::make_shared<State>();
+    auto resolver = std::make_shared<tcp::resolver>(io_context_);
+
+    io_context_.restart();
+    resolver->async_resolve(connect_info_.ip_, std::to_string(connect_info_.port_),
+        [this, state, resolver](const boost::system::error_code& rec, tcp::resolver::results_type results) {
+            if (state->abandoned) return;
+            if (rec)
+            {
+                state->ec = rec;
+                state->done = true;
+                return;
+            }
+            boost::asio::async_connect(socket_, results,
+                [state](const boost::system::error_code& cec, const tcp::endpoint&) {
+                    if (state->abandoned) return;
+                    state->ec = cec;
+                    state->done = true;
+                });
+        });
+
+    // 不用 run_for：上一次超时遗留的解析仍算作 work，会把本次拖满整个超时
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!state->done)
+    {
+        if (io_context_.run_one_until(deadline) == 0)
+            break;
+    }
+
+    if (!state->done)
+    {
+        state->abandoned = true;
+        resolver->cancel();
+
+        boost::system::error_code ec;
+        socket_.close(ec);
+        io_context_.poll(); // 跑掉已取消的 connect 回调
+
+        out_ec = boost::asio::error::timed_out;
+        return false;
+    }
+
+    out_ec = state->ec;
+    return !out_ec;
+}
+
 bool CommunicateTcpClientPrivate::IsConnected() const
 {
     // socket_.is_open() 只能说明句柄开着，不代表真的连着
@@ -130,18 +211,22 @@ int64_t CommunicateTcpClientPrivate::WriteData(const char* data, int64_t len)
 
     try
     {
+        const auto t0 = std::chrono::steady_clock::now();
         boost::system::error_code ec;
         const size_t n = boost::asio::write(socket_, boost::asio::buffer(data, (size_t)len), ec);
         if (ec)
         {
+            stats_.OnWriteError();
             ReportError_(ec.value(), "TCP write failed: " + ec.message());
             connected_.store(false);
             return -1;
         }
+        stats_.OnWrite(n, CommunicateStatsCounters::ElapsedUs(t0));
         return (int64_t)n;
     }
     catch (const std::exception& e)
     {
+        stats_.OnWriteError();
         ReportError_(-1, std::string("TCP write exception: ") + e.what());
         connected_.store(false);
         return -1;
@@ -156,6 +241,22 @@ ConnectionInfo CommunicateTcpClientPrivate::GetCommunicateInfo()
 void CommunicateTcpClientPrivate::SetDataCallback(DataCallback callback)
 {
     data_call_back_ = callback;
+    if (!callback)
+    {
+        rx_buffer_call_back_ = nullptr;
+        return;
+    }
+
+    // 旧接口：在缓冲池回调之上做一次拷贝适配
+    rx_buffer_call_back_ = [callback](const std::string& peer_id, const CommunicateRxBufferPtr& buffer) {
+        callback(peer_id, std::vector<char>(buffer->data(), buffer->data() + buffer->size()));
+    };
+}
+
+void CommunicateTcpClientPrivate::SetRxBufferCallback(RxBufferCallback callback)
+{
+    data_call_back_ = nullptr;
+    rx_buffer_call_back_ = callback;
 }
 
 void CommunicateTcpClientPrivate::SetErrorCallback(ErrorCallback callback)
@@ -163,10 +264,13 @@ void CommunicateTcpClientPrivate::SetErrorCallback(ErrorCallback callback)
     error_call_back_ = callback;
 }
 
-void CommunicateTcpClientPrivate::ReceiveLoop_()
+CommunicateStats CommunicateTcpClientPrivate::GetStats() const
 {
-    std::array<char, 4096> buffer;
+    return stats_.Snapshot();
+}
 
+void CommunicateTcpClientPrivate::ReceiveLoop_()
+{
     while (is_running_.load())
     {
         if (!IsConnected())
@@ -177,12 +281,16 @@ void CommunicateTcpClientPrivate::ReceiveLoop_()
 
         try
         {
+            // 每次读取从池里取一块，回调方持有期间不会被复写
+            std::shared_ptr<CommunicateRxBuffer> block = rx_pool_.Acquire();
+
             boost::system::error_code ec;
-            const size_t bytes = socket_.read_some(boost::asio::buffer(buffer), ec);
+            const size_t bytes = socket_.read_some(boost::asio::buffer(block->WritableData(), block->Capacity()), ec);
 
             if (ec)
             {
                 // 连接被对端关闭/网络错误
+                stats_.OnReadError();
                 ReportError_(ec.value(), "TCP read failed: " + ec.message());
                 connected_.store(false);
 
@@ -191,10 +299,16 @@ void CommunicateTcpClientPrivate::ReceiveLoop_()
                 continue;
             }
 
-            if (bytes > 0 && data_call_back_)
+            // QUICKACK 不是持久选项，每次收包后重新置位
+            RearmQuickAck_();
+
+            if (bytes > 0)
+                stats_.OnRead(bytes);
+
+            if (bytes > 0 && rx_buffer_call_back_)
             {
-                std::vector<char> vec_tmp(buffer.begin(), buffer.begin() + bytes);
-                data_call_back_(connect_info_.ip_, vec_tmp);
+                block->SetSize(bytes);
+                rx_buffer_call_back_(connect_info_.ip_, block);
             }
         }
         catch (const std::exception& e)
@@ -205,3 +319,77 @@ void CommunicateTcpClientPrivate::ReceiveLoop_()
         }
     }
 }
+
+void CommunicateTcpClientPrivate::ApplySocketOptions_()
+{
+    // 选项设置失败只上报，不影响连接本身
+    boost::system::error_code ec;
+
+    if (connect_info_.tcp_no_delay_)
+    {
+        socket_.set_option(tcp::no_delay(true), ec);
+        if (ec) ReportError_(ec.value(), "TCP set TCP_NODELAY failed: " + ec.message());
+    }
+    if (connect_info_.send_buffer_size_ > 0)
+    {
+        socket_.set_option(boost::asio::socket_base::send_buffer_size(connect_info_.send_buffer_size_), ec);
+        if (ec) ReportError_(ec.value(), "TCP set SO_SNDBUF failed: " + ec.message());
+    }
+    if (connect_info_.recv_buffer_size_ > 0)
+    {
+        socket_.set_option(boost::asio::socket_base::receive_buffer_size(connect_info_.recv_buffer_size_), ec);
+        if (ec) ReportError_(ec.value(), "TCP set SO_RCVBUF failed: " + ec.message());
+    }
+
+#ifdef __linux__
+    if (connect_info_.socket_priority_ >= 0)
+    {
+        socket_.set_option(boost::asio::detail::socket_option::integer<SOL_SOCKET, SO_PRIORITY>(connect_info_.socket_priority_), ec);
+        if (ec) ReportError_(ec.value(), "TCP set SO_PRIORITY failed: " + ec.message());
+    }
+#ifdef SO_BUSY_POLL
+    if (connect_info_.busy_poll_us_ > 0)
+    {
+        socket_.set_option(boost::asio::detail::socket_option::integer<SOL_SOCKET, SO_BUSY_POLL>(connect_info_.busy_poll_us_), ec);
+        if (ec) ReportError_(ec.value(), "TCP set SO_BUSY_POLL failed: " + ec.message());
+    }
+#endif
+    RearmQuickAck_();
+#endif
+    // Windows 下 QUICKACK / SO_PRIORITY / SO_BUSY_POLL 没有对应项，忽略
+}
+
+void CommunicateTcpClientPrivate::RearmQuickAck_()
+{
+#if defined(__linux__) && defined(TCP_QUICKACK)
+    if (!connect_info_.tcp_quick_ack_ || !socket_.is_open())
+        return;
+
+    boost::system::error_code ec;
+    socket_.set_option(boost::asio::detail::socket_option::boolean<IPPROTO_TCP, TCP_QUICKACK>(true), ec);
+#endif
+}
+
+void CommunicateTcpClientPrivate::ApplyIoAffinity_()
+{
+    const int cpu = connect_info_.io_cpu_affinity_;
+    if (cpu < 0 || !read_thread_)
+        return;
+
+#if defined(_WIN32)
+    if (cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8))
+    {
+        ReportError_(-1, "TCP set io cpu affinity failed: cpu index out of range");
+        return;
+    }
+    if (SetThreadAffinityMask(read_thread_->native_handle(), static_cast<DWORD_PTR>(1) << cpu) == 0)
+        ReportError_(static_cast<int>(GetLastError()), "TCP set io cpu affinity failed");
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    const int rc = pthread_setaffinity_np(read_thread_->native_handle(), sizeof(set), &set);
+    if (rc != 0)
+        ReportError_(rc, "TCP set io cpu affinity failed");
+#endif
+}
@@ -30,10 +30,14 @@ public:
     ConnectionInfo GetCommunicateInfo();
 
     void SetDataCallback(DataCallback callback);
+    void SetRxBufferCallback(RxBufferCallback callback);
     void SetErrorCallback(ErrorCallback callback);
 
+    CommunicateStats GetStats() const;
+
 public:
     DataCallback data_call_back_;
+    RxBufferCallback rx_buffer_call_back_;
     ErrorCallback error_call_back_;
     ConnectionInfo connect_info_;
 
@@ -41,6 +45,14 @@ private:
     void ReceiveLoop_();
     void ReportError_(int code, const std::string& msg);
 
+    // connect_timeout_ms_ > 0 时使用：解析 + 连接总时长不超过 timeout_ms
+    bool TimedConnect_(int timeout_ms, boost::system::error_code& out_ec);
+
+    // 按 connect_info_ 设置低延迟相关 socket 选项
+    void ApplySocketOptions_();
+    void ApplyIoAffinity_();
+    void RearmQuickAck_();
+
 private:
     boost::asio::io_context io_context_;
     boost::asio::ip::tcp::socket socket_;
@@ -48,4 +60,10 @@ private:
     std::shared_ptr<std::thread> read_thread_;
     std::atomic_bool is_running_{ false };
     std::atomic_bool connected_{ false };
+
+    // 接收缓冲池（接收线程独占 Acquire）
+    CommunicateRxBufferPool rx_pool_;
+
+    // 收发统计（写线程 / 接收线程直接累加）
+    CommunicateStatsCounters stats_;
 };
@@ -63,6 +63,12 @@ bool SS_LightResourceSystem::GetTemplate(const std::string& template_id, SS_Ligh
     return manager_->GetTemplate(template_id, out_tpl);
 }
 
+std::shared_ptr<const SS_LightControllerTemplate> SS_LightResourceSystem::GetTemplateShared(const std::string& template_id) const
+{
+    if (!manager_) return nullptr;
+    return manager_->GetTemplateShared(template_id);
+}
+
 bool SS_LightResourceSystem::ReloadInstances(std::string& out_error)
 {
     out_error.clear();
@@ -99,6 +105,12 @@ bool SS_LightResourceSystem::GetInstance(const std::string& instance_id, SS_Ligh
     return manager_->GetInstance(instance_id, out_inst);
 }
 
+std::shared_ptr<const SS_LightControllerInstance> SS_LightResourceSystem::GetInstanceShared(const std::string& instance_id) const
+{
+    if (!manager_) return nullptr;
+    return manager_->GetInstanceShared(instance_id);
+}
+
 bool SS_LightResourceSystem::CreateInstanceFromTemplate(
     const std::string& template_id,
     const std::string& display_name,
@@ -143,6 +155,62 @@ bool SS_LightResourceSystem::SaveInstanceById(const std::string& instance_id, st
     return manager_->SaveInstanceById(instance_id, out_error);
 }
 
+bool SS_LightResourceSystem::SaveInstanceDeferred(const std::string& instance_id, std::string& out_error)
+{
+    out_error.clear();
+    if (!manager_)
+    {
+        //out_error = "SaveInstanceDeferred: system not initialized.";
+        out_error = "延迟保存实例：系统尚未初始化。";
+        return false;
+    }
+    return manager_->SaveInstanceDeferred(instance_id, out_error);
+}
+
+bool SS_LightResourceSystem::FlushPendingSaves(std::string& out_error)
+{
+    out_error.clear();
+    if (!manager_)
+    {
+        //out_error = "FlushPendingSaves: system not initialized.";
+        out_error = "写出待保存实例：系统尚未初始化。";
+        return false;
+    }
+    return manager_->FlushPendingSaves(out_error);
+}
+
+void SS_LightResourceSystem::SetPersistOptions(const SS_LightPersistOptions& opts)
+{
+    if (!manager_) return;
+    manager_->SetPersistOptions(opts);
+}
+
+void SS_LightResourceSystem::GetPersistOptions(SS_LightPersistOptions& out_opts) const
+{
+    out_opts = SS_LightPersistOptions{};
+    if (!manager_) return;
+    manager_->GetPersistOptions(out_opts);
+}
+
+void SS_LightResourceSystem::GetPersistStats(SS_LightPersistStats& out_stats) const
+{
+    out_stats = SS_LightPersistStats{};
+    if (!manager_) return;
+    manager_->GetPersistStats(out_stats);
+}
+
+bool SS_LightResourceSystem::CompactJournal(std::string& out_error)
+{
+    out_error.clear();
+    if (!manager_)
+    {
+        //out_error = "CompactJournal: system not initialized.";
+        out_error = "折叠修改日志：系统尚未初始化。";
+        return false;
+    }
+    return manager_->CompactJournal(out_error);
+}
+
 bool SS_LightResourceSystem::DeleteInstanceById(const std::string& instance_id, std::string& out_error)
 {
     out_error.clear();
@@ -155,6 +223,76 @@ bool SS_LightResourceSystem::DeleteInstanceById(const std::string& instance_id,
     return manager_->DeleteInstanceById(instance_id, out_error);
 }
 
+bool SS_LightResourceSystem::SaveRecipe(const SS_LightRecipe& recipe, std::string& out_error)
+{
+    out_error.clear();
+    if (!manager_)
+    {
+        //out_error = "SaveRecipe: system not initialized.";
+        out_error = "保存配方：系统尚未初始化。";
+        return false;
+    }
+    return manager_->SaveRecipe(recipe, out_error);
+}
+
+bool SS_LightResourceSystem::CaptureRecipe(
+    const std::string& instance_id,
+    const std::string& recipe_id,
+    const std::string& display_name,
+    std::string& out_error)
+{
+    out_error.clear();
+    if (!manager_)
+    {
+        //out_error = "CaptureRecipe: system not initialized.";
+        out_error = "生成配方：系统尚未初始化。";
+        return false;
+    }
+    return manager_->CaptureRecipe(instance_id, recipe_id, display_name, out_error);
+}
+
+bool SS_LightResourceSystem::DeleteRecipe(const std::string& instance_id, const std::string& recipe_id, std::string& out_error)
+{
+    out_error.clear();
+    if (!manager_)
+    {
+        //out_error = "DeleteRecipe: system not initialized.";
+        out_error = "删除配方：系统尚未初始化。";
+        return false;
+    }
+    return manager_->DeleteRecipe(instance_id, recipe_id, out_error);
+}
+
+std::vector<std::string> SS_LightResourceSystem::ListRecipeIds(const std::string& instance_id) const
+{
+    if (!manager_) return {};
+    return manager_->ListRecipeIds(instance_id);
+}
+
+bool SS_LightResourceSystem::GetRecipe(const std::string& instance_id, const std::string& recipe_id, SS_LightRecipe& out_recipe) const
+{
+    if (!manager_) return false;
+    return manager_->GetRecipe(instance_id, recipe_id, out_recipe);
+}
+
+bool SS_LightResourceSystem::ApplyRecipe(
+    const std::string& instance_id,
+    const std::string& recipe_id,
+    bool full,
+    SS_LightRecipeApplyResult& out_result,
+    std::string& out_error)
+{
+    out_error.clear();
+    out_result = SS_LightRecipeApplyResult{};
+    if (!manager_)
+    {
+        //out_error = "ApplyRecipe: system not initialized.";
+        out_error = "应用配方：系统尚未初始化。";
+        return false;
+    }
+    return manager_->ApplyRecipe(instance_id, recipe_id, full, out_result, out_error);
+}
+
 bool SS_LightResourceSystem::RenameController(const std::string& instance_id, const std::string& new_display_name)
 {
     if (!manager_) return false;
@@ -239,6 +377,22 @@ bool SS_LightResourceSystem::SetChannelIndex(const std::string& instance_id,
     return manager_->SetChannelIndex(instance_id, channel_id, new_channel_index, out_error);
 }
 
+bool SS_LightResourceSystem::ResolveChannelHandle(const std::string& instance_id,
+    const std::string& channel_id,
+    int& out_handle,
+    std::string& out_error) const
+{
+    out_handle = -1;
+    out_error.clear();
+    if (!manager_)
+    {
+        //out_error = "ResolveChannelHandle: system not initialized.";
+        out_error = "解析通道句柄：系统未初始化。";
+        return false;
+    }
+    return manager_->ResolveChannelHandle(instance_id, channel_id, out_handle, out_error);
+}
+
 
 bool SS_LightResourceSystem::ConnectInstance(const std::string& instance_id, std::string& out_error)
 {
@@ -252,6 +406,64 @@ bool SS_LightResourceSystem::ConnectInstance(const std::string& instance_id, std
     return manager_->ConnectInstance(instance_id, out_error);
 }
 
+bool SS_LightResourceSystem::ConnectAll(const SS_LightConnectBatchOptions& opts, uint64_t& out_batch_id, std::string& out_error)
+{
+    out_error.clear();
+    out_batch_id = 0;
+    if (!manager_)
+    {
+        //out_error = "ConnectAll: system not initialized.";
+        out_error = "全部连接：系统尚未初始化。";
+        return false;
+    }
+    return manager_->ConnectAll(opts, out_batch_id, out_error);
+}
+
+bool SS_LightResourceSystem::ConnectInstances(
+    const std::vector<std::string>& instance_ids,
+    const SS_LightConnectBatchOptions& opts,
+    uint64_t& out_batch_id,
+    std::string& out_error)
+{
+    out_error.clear();
+    out_batch_id = 0;
+    if (!manager_)
+    {
+        //out_error = "ConnectInstances: system not initialized.";
+        out_error = "批量连接：系统尚未初始化。";
+        return false;
+    }
+    return manager_->ConnectInstances(instance_ids, opts, out_batch_id, out_error);
+}
+
+void SS_LightResourceSystem::CancelConnectBatch()
+{
+    if (!manager_) return;
+    manager_->CancelConnectBatch();
+}
+
+bool SS_LightResourceSystem::IsConnectBatchRunning() const
+{
+    if (!manager_) return false;
+    return manager_->IsConnectBatchRunning();
+}
+
+bool SS_LightResourceSystem::DiscoverDevices(
+    const SS_LightDiscoveryOptions& opts,
+    std::vector<SS_LightDiscoveryCandidate>& out_candidates,
+    std::string& out_error)
+{
+    out_error.clear();
+    out_candidates.clear();
+    if (!manager_)
+    {
+        //out_error = "DiscoverDevices: system not initialized.";
+        out_error = "自动发现：系统尚未初始化。";
+        return false;
+    }
+    return manager_->DiscoverDevices(opts, out_candidates, out_error);
+}
+
 bool SS_LightResourceSystem::DisconnectInstance(const std::string& instance_id, std::string& out_error)
 {
     out_error.clear();
@@ -264,6 +476,54 @@ bool SS_LightResourceSystem::DisconnectInstance(const std::string& instance_id,
     return manager_->DisconnectInstance(instance_id, out_error);
 }
 
+bool SS_LightResourceSystem::StartTrafficRecording(const std::string& capture_path, std::string& out_error)
+{
+    out_error.clear();
+    if (!manager_)
+    {
+        //out_error = "StartTrafficRecording: system not initialized.";
+        out_error = "开始抓包：系统尚未初始化。";
+        return false;
+    }
+    return manager_->StartTrafficRecording(capture_path, out_error);
+}
+
+void SS_LightResourceSystem::StopTrafficRecording()
+{
+    if (!manager_) return;
+    manager_->StopTrafficRecording();
+}
+
+bool SS_LightResourceSystem::SetInstanceReplaySource(const std::string& instance_id, const std::string& capture_path, double speed, std::string& out_error)
+{
+    out_error.clear();
+    if (!manager_)
+    {
+        //out_error = "SetInstanceReplaySource: system not initialized.";
+        out_error = "设置回放源：系统尚未初始化。";
+        return false;
+    }
+    return manager_->SetInstanceReplaySource(instance_id, capture_path, speed, out_error);
+}
+
+bool SS_LightResourceSystem::GetConnectionStats(const std::string& instance_id, SS_LightConnectionStats& out_stats, std::string& out_error) const
+{
+    out_error.clear();
+    if (!manager_)
+    {
+        //out_error = "GetConnectionStats: system not initialized.";
+        out_error = "获取连接统计：系统尚未初始化。";
+        return false;
+    }
+    return manager_->GetConnectionStats(instance_id, out_stats, out_error);
+}
+
+void SS_LightResourceSystem::SetStatsEventInterval(int interval_ms)
+{
+    if (!manager_) return;
+    manager_->SetStatsEventInterval(interval_ms);
+}
+
 bool SS_LightResourceSystem::SetParameterValue(const SS_LightParamSetRequest& req, SS_LightParamSetResult& out_result)
 {
     if (!manager_) return false;
@@ -276,6 +536,58 @@ bool SS_LightResourceSystem::SetParameterAndSend(const SS_LightParamSetRequest&
     return manager_->SetParameterAndSend(req, out_result);
 }
 
+bool SS_LightResourceSystem::ApplyBatch(
+    const std::string& instance_id,
+    const std::vector<SS_LightParamSetRequest>& reqs,
+    SS_LightBatchResult& out_result,
+    std::string& out_error)
+{
+    out_error.clear();
+    out_result = SS_LightBatchResult{};
+    if (!manager_)
+    {
+        //out_error = "ApplyBatch: system not initialized.";
+        out_error = "批量写入参数：系统尚未初始化。";
+        return false;
+    }
+    return manager_->ApplyBatch(instance_id, reqs, out_result, out_error);
+}
+
+bool SS_LightResourceSystem::SubmitParameterCoalesced(
+    const SS_LightParamSetRequest& req,
+    std::vector<SS_LightCoalescedResult>& out_sent,
+    std::string& out_error)
+{
+    out_error.clear();
+    out_sent.clear();
+    if (!manager_)
+    {
+        //out_error = "SubmitParameterCoalesced: system not initialized.";
+        out_error = "合并发送参数：系统尚未初始化。";
+        return false;
+    }
+    return manager_->SubmitParameterCoalesced(req, out_sent, out_error);
+}
+
+void SS_LightResourceSystem::FlushParameterUpdates(const std::string& instance_id, bool force, std::vector<SS_LightCoalescedResult>& out_sent)
+{
+    out_sent.clear();
+    if (!manager_) return;
+    manager_->FlushParameterUpdates(instance_id, force, out_sent);
+}
+
+bool SS_LightResourceSystem::HasPendingParameterUpdates(const std::string& instance_id) const
+{
+    if (!manager_) return false;
+    return manager_->HasPendingParameterUpdates(instance_id);
+}
+
+void SS_LightResourceSystem::SetCoalesceOptions(const SS_LightCoalesceOptions& opts)
+{
+    if (!manager_) return;
+    manager_->SetCoalesceOptions(opts);
+}
+
 bool SS_LightResourceSystem::UpdateConnectionConfig(
     const std::string& instance_id,
     const SS_LightConnectionConfig& conn,
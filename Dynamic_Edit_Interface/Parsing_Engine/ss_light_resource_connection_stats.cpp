@@ -0,0 +1,158 @@
+// ss_light_resource_connection_stats.cpp
+#include "ss_light_resource_connection_stats.h"
+
+#include "../../include/Communication_Library/ss_communicate_interface.h"
+
+uint64_t SS_LightConnectionStatsCollector::NowUs_()
+{
+    // +1 保证有效时刻不为 0（0 表示无在途请求）
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count()) + 1;
+}
+
+void SS_LightConnectionStatsCollector::ExpireAwaiting_(uint64_t now_us) const
+{
+    uint64_t since = awaiting_since_us_.load(std::memory_order_relaxed);
+    if (since == 0 || now_us < since || now_us - since < reply_timeout_us_.load(std::memory_order_relaxed))
+        return;
+
+    // 与 OnRx/OnError/并发的过期检查竞争：只有清掉该时刻的一方计数
+    if (awaiting_since_us_.compare_exchange_strong(since, 0, std::memory_order_relaxed))
+    {
+        timeouts_.fetch_add(1, std::memory_order_relaxed);
+        expired_unreported_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool SS_LightConnectionStatsCollector::IsAwaitingReply() const
+{
+    if (awaiting_since_us_.load(std::memory_order_relaxed) == 0)
+        return false;
+    ExpireAwaiting_(NowUs_());
+    return awaiting_since_us_.load(std::memory_order_relaxed) != 0;
+}
+
+void SS_LightConnectionStatsCollector::OnSend(size_t bytes, uint64_t latency_us)
+{
+    frames_tx_.fetch_add(1, std::memory_order_relaxed);
+    bytes_tx_.fetch_add(bytes, std::memory_order_relaxed);
+    send_latency_.Record(latency_us);
+
+    // 连续发送未等到应答时以最近一次为准（被覆盖前已过期的先计超时）
+    const uint64_t now = NowUs_();
+    ExpireAwaiting_(now);
+    awaiting_since_us_.store(now, std::memory_order_relaxed);
+}
+
+void SS_LightConnectionStatsCollector::OnRx(size_t bytes)
+{
+    frames_rx_.fetch_add(1, std::memory_order_relaxed);
+    bytes_rx_.fetch_add(bytes, std::memory_order_relaxed);
+
+    const uint64_t since = awaiting_since_us_.exchange(0, std::memory_order_relaxed);
+    if (since != 0)
+    {
+        const uint64_t now = NowUs_();
+        rtt_.Record(now > since ? now - since : 0);
+    }
+}
+
+void SS_LightConnectionStatsCollector::OnError(int code)
+{
+    if (code == 2005)
+    {
+        // 在途请求还没过本地超时：正常计数
+        // 已被本地超时计过：抵消一次，不重复计数
+        if (awaiting_since_us_.exchange(0, std::memory_order_relaxed) == 0)
+        {
+            uint64_t n = expired_unreported_.load(std::memory_order_relaxed);
+            while (n > 0 && !expired_unreported_.compare_exchange_weak(n, n - 1, std::memory_order_relaxed)) {}
+            if (n > 0)
+                return;
+        }
+        timeouts_.fetch_add(1, std::memory_order_relaxed);
+    }
+    else if (code == 2006)
+    {
+        crc_failures_.fetch_add(1, std::memory_order_relaxed);
+        awaiting_since_us_.store(0, std::memory_order_relaxed);
+    }
+}
+
+void SS_LightConnectionStatsCollector::OnConnected()
+{
+    connected_.store(true, std::memory_order_relaxed);
+    connects_.fetch_add(1, std::memory_order_relaxed);
+    awaiting_since_us_.store(0, std::memory_order_relaxed);
+    expired_unreported_.store(0, std::memory_order_relaxed);
+}
+
+void SS_LightConnectionStatsCollector::SetLinkSource(SS_LightTransport::LinkStatsSource source)
+{
+    std::lock_guard<std::mutex> lk(link_mtx_);
+    link_source_ = std::move(source);
+}
+
+void SS_LightConnectionStatsCollector::Snapshot(SS_LightConnectionStats& out_stats) const
+{
+    out_stats = SS_LightConnectionStats{};
+    ExpireAwaiting_(NowUs_());
+    out_stats.connected = connected_.load(std::memory_order_relaxed);
+
+    out_stats.frames_tx = frames_tx_.load(std::memory_order_relaxed);
+    out_stats.frames_rx = frames_rx_.load(std::memory_order_relaxed);
+    out_stats.bytes_tx = bytes_tx_.load(std::memory_order_relaxed);
+    out_stats.bytes_rx = bytes_rx_.load(std::memory_order_relaxed);
+    out_stats.send_failures = send_failures_.load(std::memory_order_relaxed);
+    out_stats.timeouts = timeouts_.load(std::memory_order_relaxed);
+    out_stats.crc_failures = crc_failures_.load(std::memory_order_relaxed);
+    out_stats.retries = retries_.load(std::memory_order_relaxed);
+
+    const uint64_t connects = connects_.load(std::memory_order_relaxed);
+    out_stats.reconnects = connects > 1 ? connects - 1 : 0;
+
+    ToLightLatencyStats(send_latency_.Snapshot(), out_stats.send_latency);
+    ToLightLatencyStats(rtt_.Snapshot(), out_stats.rtt);
+
+    std::lock_guard<std::mutex> lk(link_mtx_);
+    if (link_source_)
+        link_source_(out_stats.link);
+}
+
+void ToLightLatencyStats(const CommunicateLatencySnapshot& in, SS_LightLatencyStats& out)
+{
+    out.count = in.count;
+    out.total_us = in.total_us;
+    out.max_us = in.max_us;
+    out.p50_us = in.PercentileUs(0.50);
+    out.p99_us = in.PercentileUs(0.99);
+
+    // 去掉末尾的空桶，事件里不带一长串 0
+    size_t used = in.buckets.size();
+    while (used > 0 && in.buckets[used - 1] == 0) --used;
+    out.buckets.assign(in.buckets.begin(), in.buckets.begin() + used);
+}
+
+SS_LightTransport::LinkStatsSource MakeLinkStatsSource(std::weak_ptr<CommunicateInterface> comm, bool shared)
+{
+    if (comm.expired())
+        return nullptr;
+
+    return [comm, shared](SS_LightLinkStats& out_stats) -> bool {
+        std::shared_ptr<CommunicateInterface> c = comm.lock();
+        if (!c) return false;
+
+        const CommunicateStats s = c->GetStats();
+        out_stats.available = true;
+        out_stats.shared = shared;
+        out_stats.bytes_tx = s.bytes_tx;
+        out_stats.bytes_rx = s.bytes_rx;
+        out_stats.writes = s.writes;
+        out_stats.reads = s.reads;
+        out_stats.write_errors = s.write_errors;
+        out_stats.read_errors = s.read_errors;
+        out_stats.connects = s.connects;
+        ToLightLatencyStats(s.write_latency, out_stats.write_latency);
+        return true;
+    };
+}
@@ -0,0 +1,89 @@
+// ss_light_resource_connection_stats.h
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+#include "ss_light_resource_models.h"
+#include "ss_light_resource_transport.h"
+#include "../../include/Communication_Library/ss_communicate_stats.h"
+
+class CommunicateInterface;
+
+// 单个实例的连接统计
+// - 计数/直方图全部是 relaxed 原子，收发线程直接累加，Snapshot 可在任意线程调用
+// - 只有链路来源（link source）的替换和读取走一把小锁，保证 transport 重建时不会读到已释放的连接
+class SS_LightConnectionStatsCollector
+{
+public:
+    SS_LightConnectionStatsCollector() = default;
+
+    // 发送后超过该时间仍无应答即按超时计（TCP 直连没有 transport 上报的 2005）
+    // runtime 连接时按模板 reply_timeout_ms 设置；会自己报 2005 的 transport 另加上线路时间，以 transport 的判定为准
+    void SetReplyTimeoutMs(int ms) { reply_timeout_us_.store(static_cast<uint64_t>(ms > 0 ? ms : SS_LightTemplateInfo::kDefaultReplyTimeoutMs) * 1000, std::memory_order_relaxed); }
+
+    // 发送成功：记录帧/字节和 SendBytes 耗时，并作为 RTT 起点
+    void OnSend(size_t bytes, uint64_t latency_us);
+    void OnSendFailed() { send_failures_.fetch_add(1, std::memory_order_relaxed); }
+
+    // 收到数据：发送后的首个应答计入 RTT
+    void OnRx(size_t bytes);
+
+    // transport 错误码：2005 应答超时，2006 应答校验/成帧失败
+    // 已由本地超时计过数的请求，transport 之后再报的 2005 不重复计数
+    void OnError(int code);
+
+    void OnConnected();
+    void OnDisconnected() { connected_.store(false, std::memory_order_relaxed); }
+    void OnRetry() { retries_.fetch_add(1, std::memory_order_relaxed); }
+
+    // 最近一次发送尚未收到应答（也未超时）；顺带处理本地超时
+    bool IsAwaitingReply() const;
+
+    void SetLinkSource(SS_LightTransport::LinkStatsSource source);
+
+    // instance_id 由调用方填写
+    void Snapshot(SS_LightConnectionStats& out_stats) const;
+
+private:
+    static uint64_t NowUs_();
+
+    // 在途请求超过 reply_timeout_us_ 时计一次超时并清除在途状态（可在任意线程调用）
+    void ExpireAwaiting_(uint64_t now_us) const;
+
+private:
+    std::atomic_bool connected_{ false };
+    std::atomic<uint64_t> connects_{ 0 };
+
+    std::atomic<uint64_t> frames_tx_{ 0 };
+    std::atomic<uint64_t> frames_rx_{ 0 };
+    std::atomic<uint64_t> bytes_tx_{ 0 };
+    std::atomic<uint64_t> bytes_rx_{ 0 };
+    std::atomic<uint64_t> send_failures_{ 0 };
+    mutable std::atomic<uint64_t> timeouts_{ 0 };
+    std::atomic<uint64_t> crc_failures_{ 0 };
+    std::atomic<uint64_t> retries_{ 0 };
+
+    CommunicateLatencyHistogram send_latency_;
+    CommunicateLatencyHistogram rtt_;
+
+    // 最近一次尚未收到应答的发送时刻（us，0 = 无）
+    // 本地超时在只读路径（IsAwaitingReply/Snapshot）上触发，相关原子为 mutable
+    mutable std::atomic<uint64_t> awaiting_since_us_{ 0 };
+    // 本地超时已计数、transport 尚未报 2005 的请求数
+    mutable std::atomic<uint64_t> expired_unreported_{ 0 };
+    std::atomic<uint64_t> reply_timeout_us_{ static_cast<uint64_t>(SS_LightTemplateInfo::kDefaultReplyTimeoutMs) * 1000 };
+
+    mutable std::mutex link_mtx_;
+    SS_LightTransport::LinkStatsSource link_source_;
+};
+
+// CommunicateLibrary 统计 -> 对外模型
+void ToLightLatencyStats(const CommunicateLatencySnapshot& in, SS_LightLatencyStats& out);
+
+// 按 CommunicateInterface 生成链路统计来源；只持有 weak_ptr，连接释放后返回 false
+SS_LightTransport::LinkStatsSource MakeLinkStatsSource(std::weak_ptr<CommunicateInterface> comm, bool shared);
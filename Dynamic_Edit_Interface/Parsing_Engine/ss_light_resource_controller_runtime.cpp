@@ -1,27 +1,221 @@
 // ss_light_resource_controller_runtime.cpp
 #include "ss_light_resource_controller_runtime.h"
 
-SS_LightControllerRuntime::SS_LightControllerRuntime() = default;
+#include <algorithm>
+#include <cctype>
+#include <chrono>
 
-void SS_LightControllerRuntime::BindTemplate(const SS_LightControllerTemplate& tpl)
+static bool IsModbusTcpMbap_(const SS_LightByteTransmissionParams& p)
 {
-    tpl_ = tpl;
+    std::string h = p.message_header_type;
+    for (auto& c : h) c = (char)std::tolower((unsigned char)c);
+    return h == "modbustcp_mbap";
+}
+
+static const std::shared_ptr<const SS_LightControllerTemplate>& EmptyTemplate_()
+{
+    static const std::shared_ptr<const SS_LightControllerTemplate> empty = std::make_shared<const SS_LightControllerTemplate>();
+    return empty;
+}
+
+SS_LightControllerRuntime::SS_LightControllerRuntime()
+    : snapshot_(std::make_shared<const SS_LightControllerInstance>())
+    , tpl_(EmptyTemplate_())
+    , stats_(std::make_shared<SS_LightConnectionStatsCollector>())
+{
+}
+
+SS_LightControllerRuntime::~SS_LightControllerRuntime()
+{
+    // transport 析构时仍会回调 disconnected，先于 stats_ 释放
+    if (transport_)
+        ResetTransport_();
+
+    // collector 可能仍被定时统计线程持有
+    stats_->OnDisconnected();
+}
+
+void SS_LightControllerRuntime::BindTemplate(std::shared_ptr<const SS_LightControllerTemplate> tpl)
+{
+    tpl_ = tpl ? std::move(tpl) : EmptyTemplate_();
+    ++template_revision_;
+    inst_.param_values.BindIndex(tpl_->param_index);
 }
 
 void SS_LightControllerRuntime::BindInstance(const SS_LightControllerInstance& inst)
 {
+    WriteScope ws(*this);
     inst_ = inst;
+    inst_.param_values.BindIndex(tpl_->param_index);
+    connect_state_.store(inst_.connection.connect_state);
+    ReindexChannels();
+}
+
+SS_LightControllerRuntime::WriteScope::WriteScope(SS_LightControllerRuntime& rt, bool publish)
+    : rt_(rt)
+    , lk_(rt.write_mtx_)
+{
+    ++rt_.write_depth_;
+    if (publish)
+        rt_.publish_pending_ = true;
+}
+
+SS_LightControllerRuntime::WriteScope::~WriteScope()
+{
+    // lk_ 在析构体之后才释放，这里仍持有写锁
+    if (--rt_.write_depth_ != 0)
+        return;
+
+    // 先记日志再让修改可见：重启后能恢复的一定不少于别人已经看到的
+    if (!rt_.model_events_.empty() && rt_.journal_)
+        rt_.journal_->Append(rt_.model_events_);
+
+    if (rt_.publish_pending_)
+    {
+        rt_.publish_pending_ = false;
+        rt_.PublishSnapshot_();
+    }
+
+    // 仍在写锁内发布：同一实例的事件顺序与修改顺序一致
+    if (!rt_.model_events_.empty())
+    {
+        std::vector<SS_LightEvent> events;
+        events.swap(rt_.model_events_);
+        if (rt_.event_bus_)
+        {
+            for (const auto& ev : events)
+                rt_.event_bus_->Publish(ev);
+        }
+    }
+}
+
+void SS_LightControllerRuntime::QueueModelEvent(SS_LightEvent ev)
+{
+    if (!event_bus_ && !journal_)
+        return;
+    model_events_.push_back(std::move(ev));
+}
+
+void SS_LightControllerRuntime::PublishSnapshot_()
+{
+    std::lock_guard<std::mutex> lk(publish_mtx_);
+    inst_.connection.connect_state = connect_state_.load();
+    std::atomic_store(&snapshot_,
+        std::shared_ptr<const SS_LightControllerInstance>(std::make_shared<SS_LightControllerInstance>(inst_)));
+}
+
+void SS_LightControllerRuntime::PatchSnapshotConnectState_(bool connected)
+{
+    // 与 PublishSnapshot_ 互斥：先改的原子状态一定会出现在之后发布的快照里
+    std::lock_guard<std::mutex> lk(publish_mtx_);
+    std::shared_ptr<const SS_LightControllerInstance> cur = std::atomic_load(&snapshot_);
+    if (!cur || cur->connection.connect_state == connected)
+        return;
+
+    auto next = std::make_shared<SS_LightControllerInstance>(*cur);
+    next->connection.connect_state = connected;
+    std::atomic_store(&snapshot_, std::shared_ptr<const SS_LightControllerInstance>(std::move(next)));
+}
+
+void SS_LightControllerRuntime::ReindexChannels()
+{
+    RebuildChannelIndex_();
+}
+
+void SS_LightControllerRuntime::RebuildChannelIndex_() const
+{
+    channel_handles_.clear();
+    channel_index_handles_.clear();
+    channel_handles_.reserve(inst_.channels.size());
+    for (size_t i = 0; i < inst_.channels.size(); ++i)
+    {
+        const SS_LightChannelItem& ch = inst_.channels[i];
+        channel_handles_.emplace(ch.channel_id, static_cast<int>(i));
+        channel_index_handles_.emplace(ch.index, static_cast<int>(i));
+    }
+    indexed_channel_count_ = inst_.channels.size();
+}
+
+int SS_LightControllerRuntime::FindChannelHandle(const std::string& channel_id) const
+{
+    if (indexed_channel_count_ != inst_.channels.size())
+        RebuildChannelIndex_();
+
+    for (int attempt = 0; attempt < 2; ++attempt)
+    {
+        auto it = channel_handles_.find(channel_id);
+        if (it == channel_handles_.end())
+            return -1;
+
+        const int h = it->second;
+        if (static_cast<size_t>(h) < inst_.channels.size() && inst_.channels[h].channel_id == channel_id)
+            return h;
+
+        // 通道表被改过但没 Reindex：重建后再查一次
+        RebuildChannelIndex_();
+    }
+    return -1;
+}
+
+int SS_LightControllerRuntime::FindChannelHandleByIndex(int channel_index) const
+{
+    if (indexed_channel_count_ != inst_.channels.size())
+        RebuildChannelIndex_();
+
+    for (int attempt = 0; attempt < 2; ++attempt)
+    {
+        auto it = channel_index_handles_.find(channel_index);
+        if (it == channel_index_handles_.end())
+            return -1;
+
+        const int h = it->second;
+        if (static_cast<size_t>(h) < inst_.channels.size() && inst_.channels[h].index == channel_index)
+            return h;
+
+        RebuildChannelIndex_();
+    }
+    return -1;
 }
 
-bool SS_LightControllerRuntime::Connect(std::string& out_error)
+int SS_LightControllerRuntime::ResolveRequestChannel_(const SS_LightParamSetRequest& req) const
+{
+    const int h = req.channel_handle;
+    if (h >= 0 && static_cast<size_t>(h) < inst_.channels.size() && inst_.channels[h].channel_id == req.channel_id)
+        return h;
+    return FindChannelHandle(req.channel_id);
+}
+
+bool SS_LightControllerRuntime::Connect(std::string& out_error, int connect_timeout_ms)
 {
     out_error.clear();
 
     PublishConnectEvent_(SS_LightEventType::INSTANCE_CONNECTING, "connecting...");
 
+    // 串口走共享总线（同一 RS-485 上多台控制器共用一个串口句柄）
+    // Modbus TCP 走网关连接池（同一 ip:port 共用一条 TCP 连接）
+    // 连接方式变化时重建 transport
+    if (transport_ && transport_connect_type_ != inst_.connection.connect_type)
+        ResetTransport_();
+
     if (!transport_)
     {
-        transport_ = CreateDefaultLightTransport();
+        if (!replay_path_.empty())
+            transport_ = CreateReplayLightTransport(replay_path_, inst_.info.instance_id, replay_speed_);
+        else if (inst_.connection.connect_type == SS_LIGHT_CONNECT_TYPE::SERIAL)
+            transport_ = CreateSerialBusLightTransport(
+                tpl_->info.protocol_type, tpl_->info.byte_transmission_params,
+                tpl_->info.inter_command_gap_ms, tpl_->info.reply_timeout_ms);
+        else if (inst_.connection.connect_type == SS_LIGHT_CONNECT_TYPE::SOCKET &&
+            tpl_->info.protocol_type == SS_LIGHT_PROTOCOL_TYPE::BYTE &&
+            IsModbusTcpMbap_(tpl_->info.byte_transmission_params))
+            transport_ = CreateTcpGatewayLightTransport(tpl_->info.byte_transmission_params);
+        else
+            transport_ = CreateDefaultLightTransport();
+        transport_connect_type_ = inst_.connection.connect_type;
+
+        if (transport_ && recorder_)
+            transport_ = CreateRecordingLightTransport(std::move(transport_), recorder_, inst_.info.instance_id);
+
         if (!transport_)
         {
             out_error = "连接：无法创建传输通道。";
@@ -32,7 +226,18 @@ bool SS_LightControllerRuntime::Connect(std::string& out_error)
 
     BindTransportCallbacksIfNeeded_();
 
-    const bool ok = transport_->Connect(inst_.connection, out_error);
+    bool ok = false;
+    if (connect_timeout_ms > 0 && inst_.connection.socket_parameter.connect_timeout_ms <= 0)
+    {
+        SS_LightConnectionConfig conn = inst_.connection;
+        conn.socket_parameter.connect_timeout_ms = connect_timeout_ms;
+        ok = transport_->Connect(conn, out_error);
+    }
+    else
+    {
+        ok = transport_->Connect(inst_.connection, out_error);
+    }
+
     if (!ok)
     {
         PublishConnectEvent_(SS_LightEventType::INSTANCE_CONNECT_FAILED, out_error);
@@ -40,8 +245,22 @@ bool SS_LightControllerRuntime::Connect(std::string& out_error)
     }
 
     // 标记 instance 内状态（可选）
+    connect_state_.store(true);
     inst_.connection.connect_state = true;
 
+    // 统计的本地超时与 transport 用同一个 reply_timeout_ms；
+    // 串口总线从应答收完才开始计时，这里加上请求和最长应答的线上时间，不抢在总线之前判超时
+    int reply_timeout_ms = tpl_->info.reply_timeout_ms;
+    if (replay_path_.empty() && inst_.connection.connect_type == SS_LIGHT_CONNECT_TYPE::SERIAL)
+    {
+        const int64_t wire_us = SS_LightSerialBus::ComputeWireTimeUs(inst_.connection.serial_parameter, 2 * 256);
+        reply_timeout_ms += static_cast<int>((wire_us + 999) / 1000);
+    }
+    stats_->SetReplyTimeoutMs(reply_timeout_ms);
+
+    stats_->OnConnected();
+    stats_->SetLinkSource(transport_->GetLinkStatsSource());
+
     PublishConnectEvent_(SS_LightEventType::INSTANCE_CONNECTED, "connected");
     return true;
 }
@@ -55,16 +274,52 @@ void SS_LightControllerRuntime::Disconnect()
     else
     {
         // 兜底：从未连接过/transport 不存在时，也让 UI 收到一次“已断开”
+        connect_state_.store(false);
         inst_.connection.connect_state = false;
         PublishConnectEvent_(SS_LightEventType::INSTANCE_DISCONNECTED, "断开连接（无传输通道）");
     }
 }
 
+void SS_LightControllerRuntime::SetReplaySource(const std::string& capture_path, double speed)
+{
+    if (capture_path == replay_path_ && speed == replay_speed_)
+        return;
+
+    replay_path_ = capture_path;
+    replay_speed_ = speed;
+
+    // 真实连接和回放源互斥：切换时丢弃旧 transport，下次 Connect 重建
+    if (transport_)
+        ResetTransport_();
+}
+
+void SS_LightControllerRuntime::ResetTransport_()
+{
+    stats_->SetLinkSource(nullptr);
+    transport_->Disconnect();
+    transport_.reset();
+    transport_cb_bound_ = false;
+}
+
+void SS_LightControllerRuntime::GetConnectionStats(SS_LightConnectionStats& out_stats) const
+{
+    stats_->Snapshot(out_stats);
+    out_stats.instance_id = LoadSnapshot()->info.instance_id;   // 任意线程可调，不读 inst_
+}
+
 bool SS_LightControllerRuntime::IsConnected() const
 {
     return transport_ && transport_->IsConnected();
 }
 
+bool SS_LightControllerRuntime::PeekConnected() const
+{
+    std::unique_lock<std::recursive_mutex> lk(write_mtx_, std::try_to_lock);
+    if (!lk.owns_lock())
+        return connect_state_.load();
+    return IsConnected();
+}
+
 bool SS_LightControllerRuntime::SetParamAndBuildCommand(
     const SS_LightParamSetRequest& req,
     SS_LightParamSetResult& out_result)
@@ -102,7 +357,7 @@ bool SS_LightControllerRuntime::SetParamAndSend(
     if (payload.protocol_type == SS_LIGHT_PROTOCOL_TYPE::STRING)
     {
         std::vector<uint8_t> bytes(payload.string_cmd.begin(), payload.string_cmd.end());
-        if (!transport_->SendBytes(bytes, err))
+        if (!SendAndCount_(bytes, err))
         {
             out_result.ok = false;
             out_result.message = "SendBytes failed: " + err;
@@ -117,7 +372,7 @@ bool SS_LightControllerRuntime::SetParamAndSend(
 
     if (payload.protocol_type == SS_LIGHT_PROTOCOL_TYPE::BYTE)
     {
-        if (!transport_->SendBytes(payload.frame_bytes, err))
+        if (!SendAndCount_(payload.frame_bytes, err))
         {
             out_result.ok = false;
             out_result.message = "SendBytes failed: " + err;
@@ -146,24 +401,45 @@ bool SS_LightControllerRuntime::BuildAndMaybeSave_(
     out_result.command_out.clear();
     out_payload = SS_LightBuiltPayload{};
 
+    // 0~2) 找参数定义、校验请求、确定 effective location
+    const SS_LightParamDef* def = nullptr;
+    SS_LIGHT_PARAM_LOCATION effective_loc = SS_LIGHT_PARAM_LOCATION::UNKNOWN;
+    int channel_index = 0;
+    SS_LightParamValue value;
+    if (!ResolveParam_(req, def, effective_loc, channel_index, value, out_result.message))
+        return false;
+
+    // 3) 写入 instance（保存值）
+    StoreParamValue_(req, effective_loc, value);
+
+    // 4~6) 生成命令
+    return BuildPayload_(req, *def, channel_index, value, out_result, out_payload);
+}
+
+bool SS_LightControllerRuntime::ResolveParam_(
+    const SS_LightParamSetRequest& req,
+    const SS_LightParamDef*& out_def,
+    SS_LIGHT_PARAM_LOCATION& out_loc,
+    int& out_channel_index,
+    SS_LightParamValue& out_value,
+    std::string& out_error) const
+{
+    out_def = nullptr;
+    out_loc = SS_LIGHT_PARAM_LOCATION::UNKNOWN;
+    out_channel_index = 0;
+
     // 0) 找参数定义
-    auto it = tpl_.params.find(req.param_key);
-    if (it == tpl_.params.end())
+    auto it = tpl_->params.find(req.param_key);
+    if (it == tpl_->params.end())
     {
-        out_result.message = "模板中未找到相关参数：" + req.param_key;
+        out_error = "模板中未找到相关参数：" + req.param_key;
         return false;
     }
     const SS_LightParamDef& def = it->second;
 
-    // 1) 校验请求
-    {
-        std::string err;
-        if (!ValidateRequestAgainstTemplate_(req, def, err))
-        {
-            out_result.message = err;
-            return false;
-        }
-    }
+    // 1) 校验请求（顺带解析通道号）
+    if (!ValidateRequestAgainstTemplate_(req, def, out_channel_index, out_error))
+        return false;
 
     // 2) effective location：request 优先，否则用 template
     SS_LIGHT_PARAM_LOCATION effective_loc = req.location;
@@ -172,20 +448,69 @@ bool SS_LightControllerRuntime::BuildAndMaybeSave_(
 
     if (effective_loc == SS_LIGHT_PARAM_LOCATION::UNKNOWN)
     {
-        out_result.message = "参数位置未知（请求和模板均为未知）。";
+        out_error = "参数位置未知（请求和模板均为未知）。";
         return false;
     }
 
-    // 3) 写入 instance（保存值）
-    if (effective_loc == SS_LIGHT_PARAM_LOCATION::GLOBAL)
+    // 3) 按值约定解析 + 校验（模板载入时已编译；模板不是由 codec 载入的才临时编译）
+    const SS_LightParamValueSpec* spec = tpl_->param_index ? tpl_->param_index->FindSpec(req.param_key, effective_loc) : nullptr;
+    SS_LightParamValueSpec fallback;
+    if (!spec)
     {
-        inst_.global_param_values[req.param_key] = req.value_str;
+        fallback = SS_LightCompileParamValueSpec(def);
+        spec = &fallback;
+    }
+
+    std::string err;
+    if (!spec->ParseAndValidate(req.value_str, out_value, err))
+    {
+        out_error = "参数 " + req.param_key + " 的值无效：" + err;
+        return false;
+    }
+
+    out_def = &def;
+    out_loc = effective_loc;
+    return true;
+}
+
+void SS_LightControllerRuntime::StoreParamValue_(
+    const SS_LightParamSetRequest& req,
+    SS_LIGHT_PARAM_LOCATION loc,
+    const SS_LightParamValue& value)
+{
+    if (loc == SS_LIGHT_PARAM_LOCATION::GLOBAL)
+    {
+        inst_.param_values.SetGlobal(req.param_key, value);
     }
     else // CHANNEL
     {
-        inst_.channel_param_values[req.param_key][req.channel_id] = req.value_str;
+        inst_.param_values.SetChannel(req.param_key, req.channel_id, value);
     }
 
+    if (event_bus_ || journal_)
+    {
+        SS_LightEventParamChanged ev;
+        ev.instance_id = inst_.info.instance_id;
+        ev.param_key = req.param_key;
+        ev.location = loc;
+        if (loc == SS_LIGHT_PARAM_LOCATION::CHANNEL)
+            ev.channel_id = req.channel_id;
+        ev.value = value.text;
+        model_events_.push_back(std::move(ev));
+    }
+}
+
+bool SS_LightControllerRuntime::BuildPayload_(
+    const SS_LightParamSetRequest& req,
+    const SS_LightParamDef& def,
+    int channel_index,
+    const SS_LightParamValue& value,
+    SS_LightParamSetResult& out_result,
+    SS_LightBuiltPayload& out_payload) const
+{
+    out_result.applied_value = value.text;
+    out_result.value_adjusted = value.text != req.value_str;
+
     // 4) commit 策略：SAVE_ONLY 不生成命令
     if (def.command.commit == SS_LIGHT_COMMAND_COMMIT::SAVE_ONLY)
     {
@@ -196,40 +521,31 @@ bool SS_LightControllerRuntime::BuildAndMaybeSave_(
         return true;
     }
 
-    // 5) 算 channel_index（仅当 CHANNEL）
-    int channel_index = 0;
-    if (effective_loc == SS_LIGHT_PARAM_LOCATION::CHANNEL)
-    {
-        if (!FindChannelIndexById_(req.channel_id, channel_index))
-        {
-            out_result.message = "通道ID未找到：" + req.channel_id;
-            return false;
-        }
-    }
+    // 5) channel_index 已在 ResolveParam_ 中解析（GLOBAL 为 0）
 
     // 6) build payload（STRING / BYTE）
-    out_payload.protocol_type = tpl_.info.protocol_type;
+    out_payload.protocol_type = tpl_->info.protocol_type;
 
     std::string err;
-    if (tpl_.info.protocol_type == SS_LIGHT_PROTOCOL_TYPE::STRING)
+    if (tpl_->info.protocol_type == SS_LIGHT_PROTOCOL_TYPE::STRING)
     {
-        if (!BuildStringCommand_(def.command, req.value_str, channel_index, out_payload.string_cmd, err))
+        if (!BuildStringCommand_(def.command, value, channel_index, out_payload.string_cmd, err))
         {
             out_result.message = err;
             return false;
         }
         out_payload.printable = out_payload.string_cmd;
     }
-    else if (tpl_.info.protocol_type == SS_LIGHT_PROTOCOL_TYPE::BYTE)
+    else if (tpl_->info.protocol_type == SS_LIGHT_PROTOCOL_TYPE::BYTE)
     {
         // byte_transmission_params 来自模板，做个最基本校验
-        if (tpl_.info.byte_transmission_params.device_address.empty())
+        if (tpl_->info.byte_transmission_params.device_address.empty())
         {
             out_result.message = "模板 byte_transmission_params.device_address 为空（BYTE 协议必须配置）";
             return false;
         }
 
-        if (!BuildByteFrame_(def.command, req.value_str, channel_index, tpl_.info.byte_transmission_params,
+        if (!BuildByteFrame_(def.command, value, channel_index, tpl_->info.byte_transmission_params,
             out_payload.frame_bytes, err))
         {
             out_result.message = err;
@@ -252,9 +568,11 @@ bool SS_LightControllerRuntime::BuildAndMaybeSave_(
 bool SS_LightControllerRuntime::ValidateRequestAgainstTemplate_(
     const SS_LightParamSetRequest& req,
     const SS_LightParamDef& def,
+    int& out_channel_index,
     std::string& out_error) const
 {
     out_error.clear();
+    out_channel_index = 0;
 
     if (req.param_key.empty())
     {
@@ -285,34 +603,21 @@ bool SS_LightControllerRuntime::ValidateRequestAgainstTemplate_(
             return false;
         }
 
-        int idx = 0;
-        if (!FindChannelIndexById_(req.channel_id, idx))
+        const int h = ResolveRequestChannel_(req);
+        if (h < 0)
         {
             out_error = "在实例通道中未找到通道编号：" + req.channel_id;
             return false;
         }
+        out_channel_index = inst_.channels[h].index;
     }
 
     return true;
 }
 
-bool SS_LightControllerRuntime::FindChannelIndexById_(const std::string& channel_id, int& out_channel_index) const
-{
-    out_channel_index = 0;
-    for (const auto& ch : inst_.channels)
-    {
-        if (ch.channel_id == channel_id)
-        {
-            out_channel_index = ch.index;
-            return true;
-        }
-    }
-    return false;
-}
-
 bool SS_LightControllerRuntime::BuildStringCommand_(
     const SS_LightCommandRule& cmd_rule,
-    const std::string& param_value_str,
+    const SS_LightParamValue& param_value,
     int channel_index,
     std::string& out_cmd,
     std::string& out_error) const
@@ -320,12 +625,12 @@ bool SS_LightControllerRuntime::BuildStringCommand_(
     out_error.clear();
     out_cmd.clear();
 
-    return protocol_factory_.BuildCommand(cmd_rule, param_value_str, channel_index, out_cmd, out_error);
+    return protocol_factory_.BuildCommand(cmd_rule, param_value, channel_index, out_cmd, out_error);
 }
 
 bool SS_LightControllerRuntime::BuildByteFrame_(
     const SS_LightCommandRule& cmd_rule,
-    const std::string& param_value_str,
+    const SS_LightParamValue& param_value,
     int channel_index,
     const SS_LightByteTransmissionParams& tx_params,
     std::vector<uint8_t>& out_frame,
@@ -336,7 +641,7 @@ bool SS_LightControllerRuntime::BuildByteFrame_(
 
     // 1) 工厂生成 payload（PDU/主体）
     std::vector<uint8_t> payload;
-    if (!protocol_factory_.BuildBytesCommand(cmd_rule, param_value_str, channel_index, payload, out_error))
+    if (!protocol_factory_.BuildBytesCommand(cmd_rule, param_value, channel_index, payload, out_error))
         return false;
 
     // 2) Wrapper 封装成最终发送帧（RTU: 加 addr/CRC; TCP: MBAP; EMPTY: passthrough）
@@ -364,6 +669,431 @@ std::string SS_LightControllerRuntime::BytesToHexString_(const std::vector<uint8
     return s;
 }
 
+void SS_LightControllerRuntime::SubmitParamCoalesced(
+    const SS_LightParamSetRequest& req,
+    std::vector<SS_LightCoalescedResult>& out_sent)
+{
+    out_sent.clear();
+
+    if (!coalesce_opts_.enabled)
+    {
+        SS_LightCoalescedResult r;
+        r.request = req;
+        SetParamAndSend(req, r.result);
+        out_sent.push_back(std::move(r));
+        return;
+    }
+
+    bool merged = false;
+    for (auto& p : coalesce_pending_)
+    {
+        if (p.req.param_key != req.param_key || p.req.channel_id != req.channel_id)
+            continue;
+
+        // 旧值还没发出就被新值覆盖
+        p.superseded.push_back(p.req.value_str);
+        p.req = req;
+        merged = true;
+        break;
+    }
+    if (!merged)
+        coalesce_pending_.push_back(CoalescePending{ req, {} });
+
+    const auto now = std::chrono::steady_clock::now();
+    if (ShouldFlushCoalesced_(now))
+        FlushCoalesced_(now, out_sent);
+}
+
+void SS_LightControllerRuntime::PollCoalesced(bool force, std::vector<SS_LightCoalescedResult>& out_sent)
+{
+    out_sent.clear();
+    if (coalesce_pending_.empty())
+        return;
+
+    const auto now = std::chrono::steady_clock::now();
+    if (force || ShouldFlushCoalesced_(now))
+        FlushCoalesced_(now, out_sent);
+}
+
+bool SS_LightControllerRuntime::ShouldFlushCoalesced_(std::chrono::steady_clock::time_point now) const
+{
+    if (coalesce_pending_.empty())
+        return false;
+
+    // 未连接时发不出去，直接走 SetParamAndSend 报错，不必等
+    if (!IsConnected())
+        return true;
+
+    if (coalesce_opts_.flush_on_idle && !stats_->IsAwaitingReply())
+        return true;
+
+    return now - last_flush_at_ >= std::chrono::milliseconds(coalesce_opts_.flush_interval_ms);
+}
+
+void SS_LightControllerRuntime::FlushCoalesced_(
+    std::chrono::steady_clock::time_point now,
+    std::vector<SS_LightCoalescedResult>& out_sent)
+{
+    std::vector<CoalescePending> pending;
+    pending.swap(coalesce_pending_);
+    last_flush_at_ = now;
+
+    out_sent.reserve(out_sent.size() + pending.size());
+    for (auto& p : pending)
+    {
+        SS_LightCoalescedResult r;
+        r.request = std::move(p.req);
+        r.superseded_values = std::move(p.superseded);
+        SetParamAndSend(r.request, r.result);
+        out_sent.push_back(std::move(r));
+    }
+}
+
+bool SS_LightControllerRuntime::ApplyParamBatch(
+    const std::vector<SS_LightParamSetRequest>& reqs,
+    SS_LightBatchResult& out_result)
+{
+    out_result = SS_LightBatchResult{};
+    out_result.results.resize(reqs.size());
+
+    // 同一 (param_key, channel_id) 只生效最后一次
+    std::vector<bool> superseded(reqs.size(), false);
+    for (size_t i = 0; i < reqs.size(); ++i)
+    {
+        for (size_t j = i + 1; j < reqs.size(); ++j)
+        {
+            if (reqs[j].param_key == reqs[i].param_key && reqs[j].channel_id == reqs[i].channel_id)
+            {
+                superseded[i] = true;
+                break;
+            }
+        }
+    }
+
+    // 1) 全部校验 + 生成帧，不动 inst_；任何一项失败整批放弃
+    std::vector<PreparedParam> prepared;
+    prepared.reserve(reqs.size());
+
+    for (size_t i = 0; i < reqs.size(); ++i)
+    {
+        SS_LightParamSetResult& r = out_result.results[i];
+
+        const SS_LightParamDef* def = nullptr;
+        PreparedParam p;
+        p.req = reqs[i];
+        p.result_index = i;
+        if (!ResolveParam_(reqs[i], def, p.loc, p.channel_index, p.value, r.message) ||
+            !BuildPayload_(reqs[i], *def, p.channel_index, p.value, r, p.payload))
+        {
+            out_result.failed_index = static_cast<int>(i);
+            out_result.message = "第 " + std::to_string(i + 1) + " 项（" + reqs[i].param_key + "）：" + r.message;
+            return false;
+        }
+
+        if (superseded[i])
+        {
+            r.command_out.clear();
+            r.message = "被同批后续请求覆盖。";
+            continue;
+        }
+
+        prepared.push_back(std::move(p));
+    }
+
+    return CommitPrepared_(prepared, out_result);
+}
+
+bool SS_LightControllerRuntime::CommitPrepared_(
+    const std::vector<PreparedParam>& prepared,
+    SS_LightBatchResult& out_result)
+{
+    bool need_send = false;
+    for (const auto& p : prepared)
+    {
+        if (p.payload.protocol_type != SS_LIGHT_PROTOCOL_TYPE::UNKNOWN)
+        {
+            need_send = true;
+            break;
+        }
+    }
+
+    if (need_send && !IsConnected())
+    {
+        out_result.message = "Not connected";
+        return false;
+    }
+
+    // 2) 一次性写入；此后不再回滚
+    for (const auto& p : prepared)
+        StoreParamValue_(p.req, p.loc, p.value);
+    out_result.applied = true;
+
+    // 批内挂起的合并值已过时，不能再晚于本批发出
+    if (!coalesce_pending_.empty())
+    {
+        coalesce_pending_.erase(std::remove_if(coalesce_pending_.begin(), coalesce_pending_.end(),
+            [&](const CoalescePending& c) {
+                for (const auto& p : prepared)
+                {
+                    if (p.req.param_key == c.req.param_key && p.req.channel_id == c.req.channel_id)
+                        return true;
+                }
+                return false;
+            }), coalesce_pending_.end());
+    }
+
+    // 3) 按请求顺序发送
+    // - STRING：无指令间隔要求时相邻命令拼成一次写入（命令自带结束符）
+    // - BYTE：每帧独立应答，逐帧交给 transport 队列（串口总线负责间隔和应答仲裁）
+    const bool merge_string = tpl_->info.protocol_type == SS_LIGHT_PROTOCOL_TYPE::STRING &&
+        tpl_->info.inter_command_gap_ms <= 0;
+    static constexpr size_t kMaxMergedStringBytes = 256;
+
+    std::vector<uint8_t> pending_bytes;
+    std::vector<size_t> pending_items;
+    std::string err;
+
+    auto flush_pending = [&]() -> bool {
+        if (pending_items.empty())
+            return true;
+
+        const bool ok = SendAndCount_(pending_bytes, err);
+        if (ok)
+            ++out_result.frames_sent;
+
+        for (size_t idx : pending_items)
+        {
+            SS_LightParamSetResult& r = out_result.results[idx];
+            if (ok)
+            {
+                r.message = "OK (sent)";
+                PublishFrameEvent_(SS_LightEventType::TX_FRAME, r.command_out);
+            }
+            else
+            {
+                r.ok = false;
+                r.message = "SendBytes failed: " + err;
+            }
+        }
+        pending_bytes.clear();
+        pending_items.clear();
+        return ok;
+    };
+
+    bool send_ok = true;
+    for (const auto& p : prepared)
+    {
+        if (p.payload.protocol_type == SS_LIGHT_PROTOCOL_TYPE::UNKNOWN)
+            continue; // SAVE_ONLY
+
+        if (!send_ok)
+        {
+            SS_LightParamSetResult& r = out_result.results[p.result_index];
+            r.ok = false;
+            r.message = "前序发送失败，未发送。";
+            continue;
+        }
+
+        if (p.payload.protocol_type == SS_LIGHT_PROTOCOL_TYPE::STRING)
+        {
+            if (!merge_string || pending_bytes.size() + p.payload.string_cmd.size() > kMaxMergedStringBytes)
+                send_ok = flush_pending();
+            if (!send_ok)
+            {
+                SS_LightParamSetResult& r = out_result.results[p.result_index];
+                r.ok = false;
+                r.message = "前序发送失败，未发送。";
+                continue;
+            }
+            pending_bytes.insert(pending_bytes.end(), p.payload.string_cmd.begin(), p.payload.string_cmd.end());
+            pending_items.push_back(p.result_index);
+        }
+        else
+        {
+            pending_bytes = p.payload.frame_bytes;
+            pending_items.push_back(p.result_index);
+        }
+
+        if (!merge_string)
+            send_ok = flush_pending();
+    }
+    if (send_ok)
+        send_ok = flush_pending();
+
+    if (!send_ok)
+    {
+        out_result.message = "SendBytes failed: " + err;
+        return false;
+    }
+
+    out_result.ok = true;
+    out_result.message = "OK";
+    return true;
+}
+
+bool SS_LightControllerRuntime::CompileRecipe(const SS_LightRecipe& recipe, uint64_t revision, std::string& out_error)
+{
+    out_error.clear();
+    bool recompiled = false;
+    return EnsureRecipeCompiled_(recipe, revision, recompiled, out_error) != nullptr;
+}
+
+bool SS_LightControllerRuntime::ApplyRecipe(
+    const SS_LightRecipe& recipe,
+    uint64_t revision,
+    bool full,
+    SS_LightRecipeApplyResult& out_result)
+{
+    out_result = SS_LightRecipeApplyResult{};
+
+    const CompiledRecipe* compiled = EnsureRecipeCompiled_(recipe, revision, out_result.recompiled, out_result.batch.message);
+    if (!compiled)
+        return false;
+
+    out_result.total = static_cast<int>(compiled->entries.size());
+
+    // 只挑与当前值不同的项；帧直接用预编译结果，不再逐项 build
+    std::vector<PreparedParam> changed;
+    for (const auto& e : compiled->entries)
+    {
+        if (!full && !IsValueDifferent_(e))
+            continue;
+
+        PreparedParam p = e;
+        p.result_index = changed.size();
+        changed.push_back(std::move(p));
+    }
+
+    out_result.changed.reserve(changed.size());
+    out_result.batch.results.resize(changed.size());
+    for (const auto& p : changed)
+    {
+        out_result.changed.push_back(p.req);
+
+        SS_LightParamSetResult& r = out_result.batch.results[p.result_index];
+        r.ok = true;
+        r.command_out = p.payload.printable;
+        r.message = p.payload.protocol_type == SS_LIGHT_PROTOCOL_TYPE::UNKNOWN ? "仅保存（提交选项为“仅保存”）。" : "OK";
+    }
+
+    if (changed.empty())
+    {
+        out_result.batch.ok = true;
+        out_result.batch.message = "无差异，未发送。";
+        return true;
+    }
+
+    return CommitPrepared_(changed, out_result.batch);
+}
+
+const SS_LightControllerRuntime::CompiledRecipe* SS_LightControllerRuntime::EnsureRecipeCompiled_(
+    const SS_LightRecipe& recipe,
+    uint64_t revision,
+    bool& out_recompiled,
+    std::string& out_error)
+{
+    out_recompiled = false;
+
+    const size_t layout = ChannelLayoutHash_();
+    auto it = recipe_cache_.find(recipe.recipe_id);
+    if (it != recipe_cache_.end() &&
+        it->second.revision == revision &&
+        it->second.template_revision == template_revision_ &&
+        it->second.channel_layout == layout)
+    {
+        return &it->second;
+    }
+
+    CompiledRecipe compiled;
+    compiled.revision = revision;
+    compiled.template_revision = template_revision_;
+    compiled.channel_layout = layout;
+
+    auto add = [&](const std::string& key, SS_LIGHT_PARAM_LOCATION loc, const std::string& channel_id, const std::string& value) -> bool {
+        PreparedParam p;
+        p.req.instance_id = inst_.info.instance_id;
+        p.req.param_key = key;
+        p.req.location = loc;
+        p.req.channel_id = channel_id;
+        p.req.value_str = value;
+
+        const SS_LightParamDef* def = nullptr;
+        SS_LightParamSetResult r;
+        if (!ResolveParam_(p.req, def, p.loc, p.channel_index, p.value, r.message) ||
+            !BuildPayload_(p.req, *def, p.channel_index, p.value, r, p.payload))
+        {
+            out_error = "配方 " + recipe.recipe_id + "：参数 " + key +
+                (channel_id.empty() ? std::string() : "（通道 " + channel_id + "）") + "：" + r.message;
+            return false;
+        }
+        compiled.entries.push_back(std::move(p));
+        return true;
+    };
+
+    for (const auto& kv : recipe.global_param_values)
+    {
+        if (!add(kv.first, SS_LIGHT_PARAM_LOCATION::GLOBAL, std::string(), kv.second))
+            return nullptr;
+    }
+    for (const auto& pk : recipe.channel_param_values)
+    {
+        for (const auto& ck : pk.second)
+        {
+            if (!add(pk.first, SS_LIGHT_PARAM_LOCATION::CHANNEL, ck.first, ck.second))
+                return nullptr;
+        }
+    }
+
+    // unordered_map 无序：固定发送顺序，便于抓包比对
+    auto channel_index = [](const PreparedParam& p) {
+        return p.loc == SS_LIGHT_PARAM_LOCATION::CHANNEL ? p.channel_index : -1;
+    };
+    std::sort(compiled.entries.begin(), compiled.entries.end(),
+        [&](const PreparedParam& a, const PreparedParam& b) {
+            const bool ga = a.loc == SS_LIGHT_PARAM_LOCATION::GLOBAL;
+            const bool gb = b.loc == SS_LIGHT_PARAM_LOCATION::GLOBAL;
+            if (ga != gb) return ga;
+            if (a.req.param_key != b.req.param_key) return a.req.param_key < b.req.param_key;
+            return channel_index(a) < channel_index(b);
+        });
+
+    out_recompiled = true;
+    CompiledRecipe& slot = recipe_cache_[recipe.recipe_id];
+    slot = std::move(compiled);
+    return &slot;
+}
+
+size_t SS_LightControllerRuntime::ChannelLayoutHash_() const
+{
+    size_t h = inst_.channels.size();
+    for (const auto& ch : inst_.channels)
+    {
+        h ^= std::hash<std::string>{}(ch.channel_id) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        h ^= static_cast<size_t>(ch.index) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    }
+    return h;
+}
+
+bool SS_LightControllerRuntime::IsValueDifferent_(const PreparedParam& p) const
+{
+    const std::string* cur = p.loc == SS_LIGHT_PARAM_LOCATION::GLOBAL
+        ? inst_.param_values.FindGlobal(p.req.param_key)
+        : inst_.param_values.FindChannel(p.req.param_key, p.req.channel_id);
+    return !cur || *cur != p.value.text;
+}
+
+bool SS_LightControllerRuntime::SendAndCount_(const std::vector<uint8_t>& bytes, std::string& out_error)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    if (!transport_->SendBytes(bytes, out_error))
+    {
+        stats_->OnSendFailed();
+        return false;
+    }
+    stats_->OnSend(bytes.size(), CommunicateStatsCounters::ElapsedUs(t0));
+    return true;
+}
+
 void SS_LightControllerRuntime::BindTransportCallbacksIfNeeded_()
 {
     if (!transport_ || transport_cb_bound_)
@@ -371,6 +1101,8 @@ void SS_LightControllerRuntime::BindTransportCallbacksIfNeeded_()
 
     // 收包
     transport_->SetRxCallback([this](const std::vector<uint8_t>& bytes) {
+        stats_->OnRx(bytes.size());
+
         // 注意：这里是 transport 线程回调，event_bus 的 handler 也会在该线程触发
         // UI 侧要用 Qt::QueuedConnection/InvokeMethod 自己切线程
         const std::string hex = BytesToHexString_(bytes, true);
@@ -378,13 +1110,17 @@ void SS_LightControllerRuntime::BindTransportCallbacksIfNeeded_()
     });
 
     // 断线
+    // transport 线程：不碰 inst_（写者可能正持有它），只改原子状态并修补已发布的快照
     transport_->SetDisconnectedCallback([this](const std::string& reason) {
-        inst_.connection.connect_state = false;
+        connect_state_.store(false);
+        PatchSnapshotConnectState_(false);
+        stats_->OnDisconnected();
         PublishConnectEvent_(SS_LightEventType::INSTANCE_DISCONNECTED, reason);
     });
 
     // 错误
     transport_->SetErrorCallback([this](int code, const std::string& msg) {
+        stats_->OnError(code);
         PublishErrorEvent_(code, msg);
     });
 
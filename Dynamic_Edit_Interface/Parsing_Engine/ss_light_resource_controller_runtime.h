@@ -4,31 +4,80 @@
 #include <vector>
 #include <cstdint>
 #include <memory>
+#include <chrono>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
 
 #include "ss_light_resource_models.h"
 #include "ss_light_resource_protocol_factory.h"
 #include "ss_light_resource_transmission_wrapper.h"
 #include "ss_light_resource_transport.h"
+#include "ss_light_resource_serial_bus.h"
+#include "ss_light_resource_tcp_gateway.h"
+#include "ss_light_resource_traffic_capture.h"
+#include "ss_light_resource_connection_stats.h"
 
 #include "ss_light_resource_events.h"
 #include "ss_light_resource_event_bus.h"
+#include "ss_light_resource_journal.h"
 
+// 线程模型
+// - 写者：读写 inst_ / transport / 缓存前进入 WriteScope；同一实例的写者串行（可重入，manager 内部嵌套调用不会自锁）
+// - 读者：LoadSnapshot() 原子取走不可变快照后无锁读取，不会被写者阻塞；最外层 WriteScope 结束时发布新快照
+// - 模型变更事件在 WriteScope 内排队，最外层结束、新快照发布后按顺序发布（收到事件时快照已是新值）
+// - 设置了修改日志时，排队的事件在发布快照前先追加进日志（只进内存缓冲，不等落盘）
+// - transport 回调线程不进 WriteScope：断线只改原子连接状态并修补快照
 class SS_LightControllerRuntime
 {
 public:
     SS_LightControllerRuntime();
+    ~SS_LightControllerRuntime();
 
-    void BindTemplate(const SS_LightControllerTemplate& tpl);
+    class WriteScope
+    {
+    public:
+        // publish = false：只读 inst_ / 内部缓存，不改值，不发布快照
+        explicit WriteScope(SS_LightControllerRuntime& rt, bool publish = true);
+        ~WriteScope();
+        WriteScope(const WriteScope&) = delete;
+        WriteScope& operator=(const WriteScope&) = delete;
+
+        // publish = false 的作用域里后来改了值
+        void MarkChanged() { rt_.publish_pending_ = true; }
+
+    private:
+        SS_LightControllerRuntime& rt_;
+        std::unique_lock<std::recursive_mutex> lk_;
+    };
+
+    // 最近一次发布的实例快照（任意线程，永不为空）
+    std::shared_ptr<const SS_LightControllerInstance> LoadSnapshot() const { return std::atomic_load(&snapshot_); }
+
+    // 模板不可变、按型号共享：只持有句柄，不拷贝；传空恢复为空模板
+    void BindTemplate(std::shared_ptr<const SS_LightControllerTemplate> tpl);
     void BindInstance(const SS_LightControllerInstance& inst);
 
-    const SS_LightControllerTemplate& GetTemplate() const { return tpl_; }
+    const SS_LightControllerTemplate& GetTemplate() const { return *tpl_; }
+    const std::shared_ptr<const SS_LightControllerTemplate>& GetTemplateShared() const { return tpl_; }
+    // 以下两个只能在 WriteScope 内使用；其它线程读实例请用 LoadSnapshot()
     const SS_LightControllerInstance& GetInstance() const { return inst_; }
     SS_LightControllerInstance& GetInstanceMutable() { return inst_; }
 
+    // 通道查找（O(1)）：channel_id / 通道号 -> inst_.channels 下标（通道句柄），-1 = 不存在
+    // - 通过 GetInstanceMutable 增删通道或改通道号后调用 ReindexChannels()
+    // - 句柄在下一次增删通道前有效；查到的下标会核对 channel_id / index，不符时自动重建
+    int FindChannelHandle(const std::string& channel_id) const;
+    int FindChannelHandleByIndex(int channel_index) const;
+    void ReindexChannels();
+
     // 连接控制
-    bool Connect(std::string& out_error);
+    // connect_timeout_ms > 0：实例未配置 socket connect_timeout_ms 时用它作为本次网口连接超时
+    bool Connect(std::string& out_error, int connect_timeout_ms = 0);
     void Disconnect();
     bool IsConnected() const;
+    // 任意线程、不阻塞：写者占用（如正在连接）时返回最近一次已知的连接状态
+    bool PeekConnected() const;
 
     // 核心入口：写入参数值 + 根据模板生成“最终发送内容”
     // - STRING：out_result.command_out = 最终字符串命令
@@ -38,7 +87,44 @@ public:
     // build + send
     bool SetParamAndSend(const SS_LightParamSetRequest& req, SS_LightParamSetResult& out_result);
 
+    // 合并发送（拖动/连续输入）：同一 (param_key, channel_id) 只保留最新值
+    // - 链路空闲（上一帧已应答/超时）或距上次发出满 flush_interval_ms 时立即发出
+    // - 否则挂起，由 PollCoalesced 到期补发；被覆盖的中间值记在结果的 superseded_values
+    // - out_sent 为本次实际发出的结果，为空表示已挂起
+    void SetCoalesceOptions(const SS_LightCoalesceOptions& opts) { coalesce_opts_ = opts; }
+    void SubmitParamCoalesced(const SS_LightParamSetRequest& req, std::vector<SS_LightCoalescedResult>& out_sent);
+    // force = true 时不论是否到期全部发出
+    void PollCoalesced(bool force, std::vector<SS_LightCoalescedResult>& out_sent);
+    bool HasPendingCoalesced() const { return !coalesce_pending_.empty(); }
+
+    // 批量写入：先整体校验并生成全部帧，任一失败则不写入任何值（out_result.failed_index）
+    // 全部通过后一次性写入 inst_，再按顺序发送；同批重复的 (param_key, channel_id) 只生效最后一次
+    // 需要发送而未连接时整批拒绝；发送中途失败时值已写入（out_result.applied）
+    bool ApplyParamBatch(const std::vector<SS_LightParamSetRequest>& reqs, SS_LightBatchResult& out_result);
+
+    // 配方：预编译帧按 recipe_id 缓存，配方修订号、模板或通道布局变化时才重新生成
+    // - CompileRecipe：校验配方并预热缓存（保存配方时调用）
+    // - ApplyRecipe：只写入/发送与当前值不同的项（full = true 时全部），写入/发送语义同 ApplyParamBatch
+    bool CompileRecipe(const SS_LightRecipe& recipe, uint64_t revision, std::string& out_error);
+    bool ApplyRecipe(const SS_LightRecipe& recipe, uint64_t revision, bool full, SS_LightRecipeApplyResult& out_result);
+    void DropRecipe(const std::string& recipe_id) { recipe_cache_.erase(recipe_id); }
+
     void SetEventBus(SS_LightEventBus* bus) { event_bus_ = bus; }
+    // 修改日志（manager 持有，生命周期长于 runtime）；未打开时 Append 直接返回
+    void SetJournal(SS_LightChangeJournal* journal) { journal_ = journal; }
+
+    // 模型变更事件（PARAM_CHANGED 由写入参数值处自动排队）；只能在 WriteScope 内调用，未设置 event bus 和日志时丢弃
+    void QueueModelEvent(SS_LightEvent ev);
+
+    // 抓包：transport 创建时套上录制装饰器（recorder 未 Open 时不落盘）
+    void SetTrafficRecorder(std::shared_ptr<SS_LightTrafficRecorder> recorder) { recorder_ = std::move(recorder); }
+
+    // 回放：capture_path 非空时下次 Connect 改用回放 transport；传空恢复真实连接
+    void SetReplaySource(const std::string& capture_path, double speed);
+
+    // 连接统计：collector 可被其它线程持有并随时 Snapshot（定时统计事件）
+    const std::shared_ptr<SS_LightConnectionStatsCollector>& GetStatsCollector() const { return stats_; }
+    void GetConnectionStats(SS_LightConnectionStats& out_stats) const;
 
 private:
     // --- core shared pipeline ---
@@ -61,19 +147,55 @@ private:
         SS_LightParamSetResult& out_result,
         SS_LightBuiltPayload& out_payload);
 
+    // BuildAndMaybeSave_ 拆开的三步；ApplyParamBatch 先全部 Resolve/Build，再统一 Store
+    // ResolveParam_ 按模板编译好的值约定把 req.value_str 解析并校验成 out_value（唯一一次解析，早于任何帧生成），
+    // 并解析出通道号（GLOBAL 为 0）；后两步只用 out_value / out_channel_index
+    bool ResolveParam_(
+        const SS_LightParamSetRequest& req,
+        const SS_LightParamDef*& out_def,
+        SS_LIGHT_PARAM_LOCATION& out_loc,
+        int& out_channel_index,
+        SS_LightParamValue& out_value,
+        std::string& out_error) const;
+
+    void StoreParamValue_(const SS_LightParamSetRequest& req, SS_LIGHT_PARAM_LOCATION loc, const SS_LightParamValue& value);
+
+    bool BuildPayload_(
+        const SS_LightParamSetRequest& req,
+        const SS_LightParamDef& def,
+        int channel_index,
+        const SS_LightParamValue& value,
+        SS_LightParamSetResult& out_result,
+        SS_LightBuiltPayload& out_payload) const;
+
+    // 已校验、已生成帧、尚未写入 inst_ 的一项
+    struct PreparedParam
+    {
+        SS_LightParamSetRequest req;
+        SS_LIGHT_PARAM_LOCATION loc = SS_LIGHT_PARAM_LOCATION::UNKNOWN;
+        int channel_index = 0;
+        SS_LightParamValue value;
+        SS_LightBuiltPayload payload;
+        size_t result_index = 0;   // 对应 SS_LightBatchResult::results 下标
+    };
+
+    // 一次性写入 inst_ 并按顺序发送（out_result.results 需已按 result_index 备好 command_out）
+    bool CommitPrepared_(const std::vector<PreparedParam>& prepared, SS_LightBatchResult& out_result);
+
     // --- helpers ---
+    // CHANNEL 参数时输出通道号
     bool ValidateRequestAgainstTemplate_(
         const SS_LightParamSetRequest& req,
         const SS_LightParamDef& def,
+        int& out_channel_index,
         std::string& out_error) const;
 
-    bool FindChannelIndexById_(
-        const std::string& channel_id,
-        int& out_channel_index) const;
+    // 优先用 req.channel_handle，不符时按 channel_id 查找
+    int ResolveRequestChannel_(const SS_LightParamSetRequest& req) const;
 
     bool BuildStringCommand_(
         const SS_LightCommandRule& cmd_rule,
-        const std::string& param_value_str,
+        const SS_LightParamValue& param_value,
         int channel_index,
         std::string& out_cmd,
         std::string& out_error) const;
@@ -81,7 +203,7 @@ private:
     // BYTE：build payload -> wrap frame
     bool BuildByteFrame_(
         const SS_LightCommandRule& cmd_rule,
-        const std::string& param_value_str,
+        const SS_LightParamValue& param_value,
         int channel_index,
         const SS_LightByteTransmissionParams& tx_params,
         std::vector<uint8_t>& out_frame,
@@ -89,20 +211,89 @@ private:
 
     static std::string BytesToHexString_(const std::vector<uint8_t>& bytes, bool with_prefix);
 
+    // --- recipes ---
+    struct CompiledRecipe
+    {
+        uint64_t revision = 0;
+        uint64_t template_revision = 0;
+        size_t channel_layout = 0;
+        std::vector<PreparedParam> entries;   // 全局参数在前，其余按 param_key / 通道号排序
+    };
+
+    // 缓存有效时直接返回，否则重新生成；失败时不改动已有缓存
+    const CompiledRecipe* EnsureRecipeCompiled_(
+        const SS_LightRecipe& recipe,
+        uint64_t revision,
+        bool& out_recompiled,
+        std::string& out_error);
+    // channel_id -> index 映射的摘要，通道增删/改号后预编译帧失效
+    size_t ChannelLayoutHash_() const;
+    bool IsValueDifferent_(const PreparedParam& p) const;
+
+    // --- coalescing ---
+    struct CoalescePending
+    {
+        SS_LightParamSetRequest req;
+        std::vector<std::string> superseded;
+    };
+
+    bool ShouldFlushCoalesced_(std::chrono::steady_clock::time_point now) const;
+    void FlushCoalesced_(std::chrono::steady_clock::time_point now, std::vector<SS_LightCoalescedResult>& out_sent);
+
     void BindTransportCallbacksIfNeeded_();
+    // 丢弃 transport 前先摘掉统计里的链路来源
+    void ResetTransport_();
+    bool SendAndCount_(const std::vector<uint8_t>& bytes, std::string& out_error);
     void PublishConnectEvent_(SS_LightEventType type, const std::string& msg);
     void PublishErrorEvent_(int code, const std::string& msg);
     void PublishFrameEvent_(SS_LightEventType type, const std::string& printable);
 
+    // 快照：PublishSnapshot_ 由最外层 WriteScope 调用；PatchSnapshotConnectState_ 供 transport 回调线程
+    void PublishSnapshot_();
+    void PatchSnapshotConnectState_(bool connected);
+
 private:
-    SS_LightControllerTemplate tpl_;
+    mutable std::recursive_mutex write_mtx_;
+    int write_depth_ = 0;               // 以下两项只在 write_mtx_ 内读写
+    bool publish_pending_ = false;
+    std::vector<SS_LightEvent> model_events_;   // 待发布的模型变更事件
+
+    std::mutex publish_mtx_;            // 串行化快照发布（写者 / 断线回调）
+    std::shared_ptr<const SS_LightControllerInstance> snapshot_;   // 只经 atomic_load / atomic_store 访问
+    std::atomic_bool connect_state_{ false };                     // inst_.connection.connect_state 的权威值
+
+    std::shared_ptr<const SS_LightControllerTemplate> tpl_;   // 始终非空
     SS_LightControllerInstance inst_;
 
+    // 通道句柄索引；只是缓存，查找时发现过期会自行重建
+    mutable std::unordered_map<std::string, int> channel_handles_;   // channel_id -> 下标
+    mutable std::unordered_map<int, int> channel_index_handles_;     // 通道号 -> 下标
+    mutable size_t indexed_channel_count_ = 0;
+    void RebuildChannelIndex_() const;
+
     SS_LightProtocolFactory protocol_factory_;
     SS_LightTransmissionWrapper transmission_wrapper_;
 
     std::unique_ptr<SS_LightTransport> transport_;
+    SS_LIGHT_CONNECT_TYPE transport_connect_type_ = SS_LIGHT_CONNECT_TYPE::UNKNOWN;
+
+    std::shared_ptr<SS_LightTrafficRecorder> recorder_;
+    std::string replay_path_;
+    double replay_speed_ = 1.0;
 
     SS_LightEventBus* event_bus_ = nullptr;
+    SS_LightChangeJournal* journal_ = nullptr;
     bool transport_cb_bound_ = false;
+
+    // 与 transport 生命周期无关，统计跨重连累计
+    std::shared_ptr<SS_LightConnectionStatsCollector> stats_;
+
+    // BindTemplate 时递增，用于判断预编译配方是否过期
+    uint64_t template_revision_ = 0;
+    std::unordered_map<std::string, CompiledRecipe> recipe_cache_;
+
+    // 合并发送：挂起值按首次到达排序（条目数 = 同时在变的参数数，线性查找即可）
+    SS_LightCoalesceOptions coalesce_opts_;
+    std::vector<CoalescePending> coalesce_pending_;
+    std::chrono::steady_clock::time_point last_flush_at_{};
 };
\ No newline at end of file
@@ -0,0 +1,531 @@
+// ss_light_resource_discovery.cpp
+#include "ss_light_resource_discovery.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <sstream>
+#include <thread>
+#include <cctype>
+
+#include "ss_light_resource_transmission_wrapper.h"
+
+#include "../../include/Communication_Library/ss_communicate_interface.h"
+#include "../../include/Communication_Library/ss_communicate_library.h"
+
+namespace fs = std::filesystem;
+
+static bool HasConnectType_(const SS_LightControllerTemplate& tpl, SS_LIGHT_CONNECT_TYPE t)
+{
+    return std::find(tpl.info.connect_types.begin(), tpl.info.connect_types.end(), t) != tpl.info.connect_types.end();
+}
+
+static bool ParseIpv4_(const std::string& s, uint32_t& out)
+{
+    uint32_t parts[4] = { 0, 0, 0, 0 };
+    int idx = 0;
+    int digits = 0;
+    for (char c : s)
+    {
+        if (c == '.')
+        {
+            if (digits == 0 || ++idx > 3) return false;
+            digits = 0;
+            continue;
+        }
+        if (!std::isdigit((unsigned char)c)) return false;
+        parts[idx] = parts[idx] * 10 + static_cast<uint32_t>(c - '0');
+        if (parts[idx] > 255 || ++digits > 3) return false;
+    }
+    if (idx != 3 || digits == 0) return false;
+
+    out = (parts[0] << 24) | (parts[1] << 16) | (parts[2] << 8) | parts[3];
+    return true;
+}
+
+static std::string Ipv4ToString_(uint32_t v)
+{
+    std::ostringstream oss;
+    oss << ((v >> 24) & 0xFF) << '.' << ((v >> 16) & 0xFF) << '.' << ((v >> 8) & 0xFF) << '.' << (v & 0xFF);
+    return oss.str();
+}
+
+static std::string BytesToHex_(const std::vector<uint8_t>& bytes)
+{
+    static const char* kHex = "0123456789ABCDEF";
+    std::string s;
+    s.reserve(bytes.size() * 3);
+    for (size_t i = 0; i < bytes.size(); ++i)
+    {
+        if (i) s.push_back(' ');
+        s.push_back(kHex[(bytes[i] >> 4) & 0x0F]);
+        s.push_back(kHex[bytes[i] & 0x0F]);
+    }
+    return s;
+}
+
+bool SS_LightDiscovery::Run(
+    const std::vector<std::shared_ptr<const SS_LightControllerTemplate>>& templates,
+    const SS_LightDiscoveryOptions& opts,
+    std::vector<SS_LightDiscoveryCandidate>& out_candidates,
+    std::string& out_error)
+{
+    out_error.clear();
+    out_candidates.clear();
+    {
+        std::lock_guard<std::mutex> lk(result_mtx_);
+        results_.clear();
+    }
+
+    // 参与探测的模板
+    std::vector<const SS_LightControllerTemplate*> serial_tpls;
+    std::vector<const SS_LightControllerTemplate*> socket_tpls;
+    for (const auto& handle : templates)
+    {
+        if (!handle) continue;
+        const SS_LightControllerTemplate& tpl = *handle;
+        if (tpl.info.identify.request.empty()) continue;
+        if (!opts.template_ids.empty() &&
+            std::find(opts.template_ids.begin(), opts.template_ids.end(), tpl.info.template_id) == opts.template_ids.end())
+            continue;
+
+        if (HasConnectType_(tpl, SS_LIGHT_CONNECT_TYPE::SERIAL)) serial_tpls.push_back(&tpl);
+        if (HasConnectType_(tpl, SS_LIGHT_CONNECT_TYPE::SOCKET)) socket_tpls.push_back(&tpl);
+    }
+
+    if (serial_tpls.empty() && socket_tpls.empty())
+    {
+        out_error = "Discovery: no template defines template_info.identify.";
+        return false;
+    }
+
+    std::vector<Job> jobs;
+
+    // 串口：一个端口一个 job
+    if (opts.scan_serial && !serial_tpls.empty())
+    {
+        const std::vector<std::string> ports = opts.serial_ports.empty() ? EnumerateSerialPorts() : opts.serial_ports;
+        const std::vector<int>& bauds = opts.baud_rates.empty() ? SS_LightCommonBaudRates() : opts.baud_rates;
+
+        for (const auto& port : ports)
+        {
+            Job job;
+            job.type = SS_LIGHT_CONNECT_TYPE::SERIAL;
+            job.com_port = port;
+            job.baud_rates = bauds;
+            job.templates = serial_tpls;
+            jobs.push_back(std::move(job));
+        }
+    }
+
+    // 网口：一个 主机 x 端口 一个 job
+    for (const auto& subnet : opts.subnets)
+    {
+        if (socket_tpls.empty()) break;
+
+        const std::string& ip = subnet.ip_address.empty() ? subnet.destination_ip_address : subnet.ip_address;
+
+        std::vector<std::string> hosts;
+        std::string err;
+        if (!ExpandSubnet(ip, subnet.subnet_mask, opts.max_hosts_per_subnet, hosts, err))
+        {
+            out_error = "Discovery: " + err;
+            return false;
+        }
+
+        // 按端口分组：同一端口上的模板共用一条连接
+        std::vector<std::pair<int, std::vector<const SS_LightControllerTemplate*>>> by_port;
+        for (const auto* tpl : socket_tpls)
+        {
+            const int port = subnet.destination_port > 0 ? subnet.destination_port : tpl->info.identify.tcp_port;
+            if (port <= 0 || port > 65535) continue;
+
+            auto it = std::find_if(by_port.begin(), by_port.end(), [port](const auto& p) { return p.first == port; });
+            if (it == by_port.end())
+                by_port.push_back({ port, { tpl } });
+            else
+                it->second.push_back(tpl);
+        }
+
+        for (const auto& host : hosts)
+        {
+            for (const auto& pt : by_port)
+            {
+                Job job;
+                job.type = SS_LIGHT_CONNECT_TYPE::SOCKET;
+                job.ip = host;
+                job.port = pt.first;
+                job.templates = pt.second;
+                jobs.push_back(std::move(job));
+            }
+        }
+    }
+
+    if (jobs.empty())
+        return true;
+
+    // 有界并发：工作线程从共享游标取 job
+    const int workers = std::max(1, std::min(opts.max_concurrency, static_cast<int>(jobs.size())));
+    std::atomic<size_t> next{ 0 };
+
+    std::vector<std::thread> threads;
+    threads.reserve(static_cast<size_t>(workers));
+    for (int i = 0; i < workers; ++i)
+    {
+        threads.emplace_back([this, &jobs, &next, &opts]() {
+            for (;;)
+            {
+                const size_t idx = next.fetch_add(1);
+                if (idx >= jobs.size()) break;
+                RunJob_(jobs[idx], opts.serial_format);
+            }
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+
+    {
+        std::lock_guard<std::mutex> lk(result_mtx_);
+        out_candidates.swap(results_);
+    }
+
+    // 结果顺序与线程调度无关
+    std::sort(out_candidates.begin(), out_candidates.end(), [](const SS_LightDiscoveryCandidate& a, const SS_LightDiscoveryCandidate& b) {
+        const auto& ca = a.connection;
+        const auto& cb = b.connection;
+        if (ca.connect_type != cb.connect_type) return ca.connect_type < cb.connect_type;
+        if (ca.serial_parameter.com_port_num != cb.serial_parameter.com_port_num)
+            return ca.serial_parameter.com_port_num < cb.serial_parameter.com_port_num;
+        if (ca.socket_parameter.destination_ip_address != cb.socket_parameter.destination_ip_address)
+            return ca.socket_parameter.destination_ip_address < cb.socket_parameter.destination_ip_address;
+        if (ca.socket_parameter.destination_port != cb.socket_parameter.destination_port)
+            return ca.socket_parameter.destination_port < cb.socket_parameter.destination_port;
+        return a.template_id < b.template_id;
+    });
+    return true;
+}
+
+void SS_LightDiscovery::RunJob_(const Job& job, const SS_LightSerialConfig& serial_format)
+{
+    std::vector<std::pair<const SS_LightControllerTemplate*, std::string>> matched;
+
+    if (job.type == SS_LIGHT_CONNECT_TYPE::SERIAL)
+    {
+        for (int baud : job.baud_rates)
+        {
+            auto comm = CommunicateLibrary::Instance().CreateCommunicateFactory(CommunicateType::SERIAL);
+            if (!comm) return;
+            comm->Init();
+            comm->SetErrorCallback([](int, const std::string&) {});
+
+            ConnectionInfo ci;
+            ci.com_port_ = job.com_port;
+            ci.baud_rate_ = baud;
+            ci.character_size_ = serial_format.character_size > 0 ? serial_format.character_size : 8;
+            ci.stop_bits_ = serial_format.stop_bits > 0 ? serial_format.stop_bits : 1;
+            ci.parity_ = serial_format.parity;
+
+            // 端口不存在 / 被占用：后面的波特率也不用试了
+            if (!comm->Connect(ci))
+                return;
+
+            Exchange_(*comm, job.templates, matched);
+            comm->Disconnect();
+
+            if (matched.empty()) continue;
+
+            SS_LightConnectionConfig conn;
+            conn.connect_type = SS_LIGHT_CONNECT_TYPE::SERIAL;
+            conn.serial_parameter.com_port_num = job.com_port;
+            conn.serial_parameter.baud_rate = baud;
+            conn.serial_parameter.character_size = ci.character_size_;
+            conn.serial_parameter.stop_bits = ci.stop_bits_;
+            conn.serial_parameter.parity = ci.parity_;
+
+            for (const auto& m : matched)
+                AddCandidate_(*m.first, conn, m.second);
+            return;
+        }
+        return;
+    }
+
+    if (job.type == SS_LIGHT_CONNECT_TYPE::SOCKET)
+    {
+        auto comm = CommunicateLibrary::Instance().CreateCommunicateFactory(CommunicateType::TCP_CLIENT);
+        if (!comm) return;
+        comm->Init();
+        comm->SetErrorCallback([](int, const std::string&) {});
+
+        // 连接超时与识别超时同量级：离线主机很快放弃
+        int timeout_ms = 0;
+        for (const auto* tpl : job.templates)
+            timeout_ms = std::max(timeout_ms, tpl->info.identify.timeout_ms);
+
+        ConnectionInfo ci;
+        ci.ip_ = job.ip;
+        ci.port_ = job.port;
+        ci.connect_timeout_ms_ = std::max(timeout_ms, 200);
+        ci.tcp_no_delay_ = true;
+
+        if (!comm->Connect(ci))
+            return;
+
+        Exchange_(*comm, job.templates, matched);
+        comm->Disconnect();
+
+        SS_LightConnectionConfig conn;
+        conn.connect_type = SS_LIGHT_CONNECT_TYPE::SOCKET;
+        conn.socket_parameter.destination_ip_address = job.ip;
+        conn.socket_parameter.destination_port = job.port;
+
+        for (const auto& m : matched)
+            AddCandidate_(*m.first, conn, m.second);
+    }
+}
+
+void SS_LightDiscovery::Exchange_(
+    CommunicateInterface& comm,
+    const std::vector<const SS_LightControllerTemplate*>& templates,
+    std::vector<std::pair<const SS_LightControllerTemplate*, std::string>>& out_matched) const
+{
+    out_matched.clear();
+
+    struct RxState
+    {
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::vector<uint8_t> bytes;
+    };
+    auto st = std::make_shared<RxState>();
+
+    comm.SetRxBufferCallback([st](const std::string& /*peer*/, const CommunicateRxBufferPtr& buffer) {
+        if (!buffer || buffer->empty()) return;
+        {
+            std::lock_guard<std::mutex> lk(st->mtx);
+            const uint8_t* p = reinterpret_cast<const uint8_t*>(buffer->data());
+            st->bytes.insert(st->bytes.end(), p, p + buffer->size());
+        }
+        st->cv.notify_all();
+    });
+
+    // 所有请求背靠背发出，再统一等待：每个候选连接只花一个超时
+    int wait_ms = 0;
+    std::vector<const SS_LightControllerTemplate*> sent;
+    for (const auto* tpl : templates)
+    {
+        std::vector<uint8_t> req;
+        std::string err;
+        if (!BuildIdentifyRequest_(*tpl, req, err)) continue;
+
+        if (comm.WriteData(reinterpret_cast<const char*>(req.data()), static_cast<int64_t>(req.size())) < 0)
+            break;
+
+        sent.push_back(tpl);
+        wait_ms = std::max(wait_ms, tpl->info.identify.timeout_ms);
+
+        if (tpl->info.inter_command_gap_ms > 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(tpl->info.inter_command_gap_ms));
+    }
+
+    std::vector<bool> hit(sent.size(), false);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(wait_ms);
+
+    std::unique_lock<std::mutex> lk(st->mtx);
+    for (;;)
+    {
+        size_t remaining = 0;
+        for (size_t i = 0; i < sent.size(); ++i)
+        {
+            if (hit[i]) continue;
+
+            std::string printable;
+            if (MatchResponse_(*sent[i], st->bytes, printable))
+            {
+                hit[i] = true;
+                out_matched.push_back({ sent[i], printable });
+            }
+            else
+            {
+                ++remaining;
+            }
+        }
+
+        if (remaining == 0) break;
+        if (st->cv.wait_until(lk, deadline) == std::cv_status::timeout)
+        {
+            // 超时前最后一包可能刚到：再匹配一轮
+            for (size_t i = 0; i < sent.size(); ++i)
+            {
+                std::string printable;
+                if (!hit[i] && MatchResponse_(*sent[i], st->bytes, printable))
+                    out_matched.push_back({ sent[i], printable });
+            }
+            break;
+        }
+    }
+
+    // 不在这里清空接收回调：读线程仍在运行，std::function 不能并发改写。
+    // 回调只持有 st，调用方 Disconnect 停掉读线程后随 comm 一起释放
+}
+
+void SS_LightDiscovery::AddCandidate_(const SS_LightControllerTemplate& tpl, const SS_LightConnectionConfig& conn, const std::string& printable)
+{
+    SS_LightDiscoveryCandidate c;
+    c.template_id = tpl.info.template_id;
+    c.connection = conn;
+    c.response_printable = printable;
+
+    std::lock_guard<std::mutex> lk(result_mtx_);
+    results_.push_back(std::move(c));
+}
+
+bool SS_LightDiscovery::BuildIdentifyRequest_(const SS_LightControllerTemplate& tpl, std::vector<uint8_t>& out_bytes, std::string& out_error)
+{
+    out_bytes.clear();
+    out_error.clear();
+
+    const std::string& req = tpl.info.identify.request;
+
+    if (tpl.info.protocol_type == SS_LIGHT_PROTOCOL_TYPE::BYTE)
+    {
+        std::vector<uint8_t> pdu;
+        if (!ParseHex_(req, pdu))
+        {
+            out_error = "identify.request is not valid hex: " + req;
+            return false;
+        }
+
+        SS_LightTransmissionWrapper wrapper;
+        return wrapper.WrapPdu(pdu, tpl.info.byte_transmission_params, out_bytes, out_error);
+    }
+
+    out_bytes.assign(req.begin(), req.end());
+    return true;
+}
+
+bool SS_LightDiscovery::MatchResponse_(const SS_LightControllerTemplate& tpl, const std::vector<uint8_t>& rx, std::string& out_printable)
+{
+    if (rx.empty()) return false;
+
+    const std::string& expect = tpl.info.identify.response;
+
+    std::vector<uint8_t> needle;
+    if (tpl.info.protocol_type == SS_LIGHT_PROTOCOL_TYPE::BYTE)
+    {
+        if (!expect.empty() && !ParseHex_(expect, needle)) return false;
+    }
+    else
+    {
+        needle.assign(expect.begin(), expect.end());
+    }
+
+    // response 为空：有任何应答即算命中
+    if (!needle.empty() && std::search(rx.begin(), rx.end(), needle.begin(), needle.end()) == rx.end())
+        return false;
+
+    out_printable = (tpl.info.protocol_type == SS_LIGHT_PROTOCOL_TYPE::BYTE)
+        ? BytesToHex_(rx)
+        : std::string(rx.begin(), rx.end());
+    return true;
+}
+
+bool SS_LightDiscovery::ParseHex_(const std::string& text, std::vector<uint8_t>& out_bytes)
+{
+    out_bytes.clear();
+
+    std::string hex;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        const char c = text[i];
+        // 跳过 0x 前缀
+        if (c == '0' && i + 1 < text.size() && (text[i + 1] == 'x' || text[i + 1] == 'X'))
+        {
+            ++i;
+            continue;
+        }
+        if (std::isxdigit((unsigned char)c)) hex.push_back(c);
+        else if (!std::isspace((unsigned char)c) && c != ',') return false;
+    }
+    if (hex.empty() || (hex.size() % 2) != 0) return false;
+
+    for (size_t i = 0; i < hex.size(); i += 2)
+        out_bytes.push_back(static_cast<uint8_t>(std::stoul(hex.substr(i, 2), nullptr, 16)));
+    return true;
+}
+
+std::vector<std::string> SS_LightDiscovery::EnumerateSerialPorts()
+{
+    std::vector<std::string> ports;
+
+#ifdef _WIN32
+    // 不存在的端口 Connect 立即失败，探测阶段自然跳过
+    for (int i = 1; i <= 64; ++i)
+        ports.push_back("COM" + std::to_string(i));
+#else
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator("/dev", ec))
+    {
+        const std::string name = entry.path().filename().string();
+        if (name.rfind("ttyS", 0) == 0 || name.rfind("ttyUSB", 0) == 0 || name.rfind("ttyACM", 0) == 0)
+            ports.push_back(entry.path().string());
+    }
+    std::sort(ports.begin(), ports.end());
+#endif
+
+    return ports;
+}
+
+bool SS_LightDiscovery::ExpandSubnet(
+    const std::string& ip,
+    const std::string& mask,
+    int max_hosts,
+    std::vector<std::string>& out_hosts,
+    std::string& out_error)
+{
+    out_hosts.clear();
+    out_error.clear();
+
+    uint32_t addr = 0;
+    if (!ParseIpv4_(ip, addr))
+    {
+        out_error = "invalid ip address: " + ip;
+        return false;
+    }
+
+    uint32_t m = 0xFFFFFFFFu;
+    if (!mask.empty() && !ParseIpv4_(mask, m))
+    {
+        out_error = "invalid subnet mask: " + mask;
+        return false;
+    }
+
+    // 掩码必须是连续的 1
+    const uint32_t inv = ~m;
+    if ((inv & (inv + 1)) != 0)
+    {
+        out_error = "subnet mask is not contiguous: " + mask;
+        return false;
+    }
+
+    // /31 /32：只探测 ip 本身
+    if (inv <= 1)
+    {
+        out_hosts.push_back(ip);
+        return true;
+    }
+
+    const uint32_t network = addr & m;
+    const uint32_t host_count = inv - 1;   // 去掉网络地址和广播地址
+    if (max_hosts > 0 && host_count > static_cast<uint32_t>(max_hosts))
+    {
+        out_error = "subnet " + ip + "/" + mask + " has " + std::to_string(host_count) +
+            " hosts, exceeds max_hosts_per_subnet " + std::to_string(max_hosts);
+        return false;
+    }
+
+    out_hosts.reserve(host_count);
+    for (uint32_t h = 1; h <= host_count; ++h)
+        out_hosts.push_back(Ipv4ToString_(network + h));
+    return true;
+}
@@ -0,0 +1,75 @@
+// ss_light_resource_discovery.h
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <atomic>
+
+#include "ss_light_resource_models.h"
+
+class CommunicateInterface;
+
+// 设备自动发现：并发探测串口（端口 x 波特率）和网段（主机 x 端口）
+// - 每个候选连接上依次发出各模板的 identify.request，在 identify.timeout_ms 内应答包含 identify.response 即命中
+// - 同一串口同一时刻只能有一个句柄：端口之间并发，同一端口内按波特率依次探测，命中后不再试其它波特率
+// - 已被共享总线占用的串口打不开，直接跳过
+// - 连接走 CommunicateLibrary（TCP 连接带 connect_timeout_ms，离线主机不会拖住工作线程）
+class SS_LightDiscovery
+{
+public:
+    SS_LightDiscovery() = default;
+
+    // 阻塞直到所有候选探测结束；templates 为共享只读句柄，运行期间不依赖 manager
+    bool Run(
+        const std::vector<std::shared_ptr<const SS_LightControllerTemplate>>& templates,
+        const SS_LightDiscoveryOptions& opts,
+        std::vector<SS_LightDiscoveryCandidate>& out_candidates,
+        std::string& out_error);
+
+    // 本机串口列表（Windows: COM1~COM64 中能打开的由探测阶段筛选；Linux: /dev/ttyS* /dev/ttyUSB* /dev/ttyACM*）
+    static std::vector<std::string> EnumerateSerialPorts();
+
+    // ip/mask 展开为主机地址（去掉网络地址和广播地址）；mask 为空或 /32 时只返回 ip 本身
+    static bool ExpandSubnet(
+        const std::string& ip,
+        const std::string& mask,
+        int max_hosts,
+        std::vector<std::string>& out_hosts,
+        std::string& out_error);
+
+private:
+    struct Job
+    {
+        SS_LIGHT_CONNECT_TYPE type = SS_LIGHT_CONNECT_TYPE::UNKNOWN;
+
+        // SERIAL：com 口 + 依次尝试的波特率
+        std::string com_port;
+        std::vector<int> baud_rates;
+
+        // SOCKET：目标主机 + 端口
+        std::string ip;
+        int port = 0;
+
+        std::vector<const SS_LightControllerTemplate*> templates;
+    };
+
+    void RunJob_(const Job& job, const SS_LightSerialConfig& serial_format);
+
+    // 在已连接的 comm 上发出所有模板的识别请求，返回命中的模板（及应答）
+    void Exchange_(
+        CommunicateInterface& comm,
+        const std::vector<const SS_LightControllerTemplate*>& templates,
+        std::vector<std::pair<const SS_LightControllerTemplate*, std::string>>& out_matched) const;
+
+    void AddCandidate_(const SS_LightControllerTemplate& tpl, const SS_LightConnectionConfig& conn, const std::string& printable);
+
+    static bool BuildIdentifyRequest_(const SS_LightControllerTemplate& tpl, std::vector<uint8_t>& out_bytes, std::string& out_error);
+    static bool MatchResponse_(const SS_LightControllerTemplate& tpl, const std::vector<uint8_t>& rx, std::string& out_printable);
+    static bool ParseHex_(const std::string& text, std::vector<uint8_t>& out_bytes);
+
+private:
+    std::mutex result_mtx_;
+    std::vector<SS_LightDiscoveryCandidate> results_;
+};
@@ -3,6 +3,8 @@
 #include <variant>
 #include <cstdint>
 
+#include "ss_light_resource_models.h"
+
 enum class SS_LightEventType
 {
     INSTANCE_CONNECTING,
@@ -10,8 +12,20 @@ enum class SS_LightEventType
     INSTANCE_DISCONNECTED,
     INSTANCE_CONNECT_FAILED,
     INSTANCE_ERROR,
+    CONNECT_BATCH_PROGRESS,   // 批量连接：完成一个实例
+    CONNECT_BATCH_FINISHED,   // 批量连接：全部结束（或被取消）
+    CONNECTION_STATS,         // 定时连接统计（SetStatsEventInterval）
     TX_FRAME,     // 可选：发送了什么
-    RX_FRAME      // 可选：收到了什么
+    RX_FRAME,     // 可选：收到了什么
+
+    // 模型变更：manager 修改接口发出，新快照发布之后才发布，同一实例按修改顺序到达
+    PARAM_CHANGED,
+    CHANNEL_ADDED,
+    CHANNEL_REMOVED,
+    CHANNEL_RENAMED,
+    CHANNEL_REINDEXED,
+    INSTANCE_RENAMED,
+    CONNECTION_CONFIG_CHANGED
 };
 
 struct SS_LightEventBase
@@ -28,6 +42,36 @@ struct SS_LightEventConnect
     std::string message; // error 或提示
 };
 
+// 批量连接进度事件
+struct SS_LightEventConnectBatch
+{
+    SS_LightEventType type{ SS_LightEventType::CONNECT_BATCH_PROGRESS };
+    std::string instance_id; // PROGRESS：刚完成的实例；FINISHED：空
+    uint64_t batch_id = 0;
+    int total = 0;
+    int done = 0;
+    int succeeded = 0;
+    int failed = 0;
+    bool ok = false;         // PROGRESS：该实例是否连上
+    bool cancelled = false;  // FINISHED：是否被取消
+    std::string message;     // PROGRESS：失败原因
+};
+
+// 连接统计事件（每个实例一条）
+struct SS_LightEventStats
+{
+    SS_LightEventType type{ SS_LightEventType::CONNECTION_STATS };
+    std::string instance_id;
+    SS_LightConnectionStats stats;
+};
+
+// SS_LightEventError::code：持久化相关
+enum SS_LightPersistErrorCode : int
+{
+    SS_LIGHT_PERSIST_SAVE_FAILED = 3001,     // 延迟保存 / 折叠写 YAML 失败（稍后重试）
+    SS_LIGHT_PERSIST_JOURNAL_FAILED = 3002   // 修改日志写出/fsync 失败（记录保留并重试；UI 应退回同步保存）
+};
+
 // 错误事件
 struct SS_LightEventError
 {
@@ -45,9 +89,54 @@ struct SS_LightEventFrame
     std::string printable; // hex/string
 };
 
+// 参数值变更：值真正写入实例后发出（校验失败不发；已写入但发送失败仍发）
+// 单条、批量、配方、合并发送补发都走这里，视图按 (param_key, channel_id) 直接改对应控件
+struct SS_LightEventParamChanged
+{
+    SS_LightEventType type{ SS_LightEventType::PARAM_CHANGED };
+    std::string instance_id;
+    std::string param_key;
+    SS_LIGHT_PARAM_LOCATION location = SS_LIGHT_PARAM_LOCATION::UNKNOWN; // GLOBAL / CHANNEL
+    std::string channel_id; // CHANNEL 时有效
+    std::string value;      // 写入后的文本（同 SS_LightParamSetResult::applied_value）
+};
+
+// 通道变更：CHANNEL_ADDED / REMOVED / RENAMED / REINDEXED
+struct SS_LightEventChannel
+{
+    SS_LightEventType type{};
+    std::string instance_id;
+    std::string channel_id;
+    std::string display_name; // ADDED / RENAMED
+    int index = -1;           // ADDED / REINDEXED：当前通道号
+    int old_index = -1;       // REINDEXED：原通道号
+};
+
+// 控制器改名
+struct SS_LightEventInstanceRenamed
+{
+    SS_LightEventType type{ SS_LightEventType::INSTANCE_RENAMED };
+    std::string instance_id;
+    std::string display_name;
+};
+
+// 连接配置变更（UpdateConnectionConfig 会先断开，connection.connect_state 恒为 false）
+struct SS_LightEventConnectionConfig
+{
+    SS_LightEventType type{ SS_LightEventType::CONNECTION_CONFIG_CHANGED };
+    std::string instance_id;
+    SS_LightConnectionConfig connection;
+};
+
 using SS_LightEvent = std::variant<
     SS_LightEventBase,
     SS_LightEventConnect,
+    SS_LightEventConnectBatch,
+    SS_LightEventStats,
     SS_LightEventError,
-    SS_LightEventFrame
+    SS_LightEventFrame,
+    SS_LightEventParamChanged,
+    SS_LightEventChannel,
+    SS_LightEventInstanceRenamed,
+    SS_LightEventConnectionConfig
 >;
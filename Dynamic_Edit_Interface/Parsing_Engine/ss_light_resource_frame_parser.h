@@ -14,6 +14,9 @@ public:
 
     void Reset();
 
+    // 尚未切出完整帧的缓存字节数
+    size_t BufferedSize() const { return rx_buffer_.size(); }
+
     // 输入：新收到的一段 bytes（来自串口/TCP）
     // 输出：解析出的完整 frame 列表
     //
@@ -0,0 +1,646 @@
+// ss_light_resource_journal.cpp
+#include "ss_light_resource_journal.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace fs = std::filesystem;
+
+static const char kJournalMagic[8] = { 'S', 'S', 'L', 'J', 'N', 'L', '0', '1' };
+static const char kSegmentPrefix[] = "changes.";
+static const char kSegmentSuffix[] = ".wal";
+// 写失败后多久重试（磁盘满/拔盘时不空转）
+static constexpr int kRetryMs = 1000;
+
+static void PutLe_(std::string& out, uint64_t v, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+        out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+}
+
+static uint64_t GetLe_(const uint8_t* p, int bytes)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; ++i)
+        v |= static_cast<uint64_t>(p[i]) << (8 * i);
+    return v;
+}
+
+// CRC-32（IEEE 802.3，反射多项式 0xEDB88320）
+static uint32_t Crc32_(const uint8_t* data, size_t len)
+{
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; ++i)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// changes.<gen>.wal -> gen
+static bool ParseSegmentGen_(const std::string& fname, uint64_t& out_gen)
+{
+    const size_t pre = sizeof(kSegmentPrefix) - 1;
+    const size_t suf = sizeof(kSegmentSuffix) - 1;
+    if (fname.size() <= pre + suf) return false;
+    if (fname.compare(0, pre, kSegmentPrefix) != 0) return false;
+    if (fname.compare(fname.size() - suf, suf, kSegmentSuffix) != 0) return false;
+
+    const std::string digits = fname.substr(pre, fname.size() - pre - suf);
+    if (digits.empty() || digits.size() > 18) return false;
+    uint64_t g = 0;
+    for (char c : digits)
+    {
+        if (c < '0' || c > '9') return false;
+        g = g * 10 + static_cast<uint64_t>(c - '0');
+    }
+    out_gen = g;
+    return true;
+}
+
+// ============================
+// 段文件：只追加写 + fsync（ofstream 做不到落盘）
+// ============================
+
+struct SS_LightChangeJournal::File_
+{
+    std::string path;
+#ifdef _WIN32
+    HANDLE h = INVALID_HANDLE_VALUE;
+#else
+    int fd = -1;
+#endif
+
+    ~File_() { Close(); }
+
+    bool Create(const std::string& p)
+    {
+        path = p;
+#ifdef _WIN32
+        const std::wstring wpath = fs::path(p).wstring();
+        // 允许其它进程/ReloadInstances 同时读
+        h = CreateFileW(wpath.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        return h != INVALID_HANDLE_VALUE;
+#else
+        fd = ::open(p.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+        if (fd < 0) return false;
+
+        // 新建文件的目录项也要落盘
+        const std::string dir = fs::path(p).parent_path().string();
+        const int dfd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY);
+        if (dfd >= 0)
+        {
+            (void)::fsync(dfd);
+            ::close(dfd);
+        }
+        return true;
+#endif
+    }
+
+    bool Write(const char* data, size_t len)
+    {
+#ifdef _WIN32
+        while (len > 0)
+        {
+            const DWORD chunk = static_cast<DWORD>(std::min<size_t>(len, 1u << 30));
+            DWORD written = 0;
+            if (!WriteFile(h, data, chunk, &written, nullptr) || written == 0)
+                return false;
+            data += written;
+            len -= written;
+        }
+        return true;
+#else
+        while (len > 0)
+        {
+            const ssize_t n = ::write(fd, data, len);
+            if (n < 0)
+            {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += n;
+            len -= static_cast<size_t>(n);
+        }
+        return true;
+#endif
+    }
+
+    bool Sync()
+    {
+#ifdef _WIN32
+        return FlushFileBuffers(h) != 0;
+#else
+        return ::fsync(fd) == 0;
+#endif
+    }
+
+    void Close()
+    {
+#ifdef _WIN32
+        if (h != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(h);
+            h = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (fd >= 0)
+        {
+            ::close(fd);
+            fd = -1;
+        }
+#endif
+    }
+};
+
+// ============================
+// SS_LightChangeJournal
+// ============================
+
+SS_LightChangeJournal::SS_LightChangeJournal() = default;
+
+SS_LightChangeJournal::~SS_LightChangeJournal()
+{
+    Close();
+}
+
+bool SS_LightChangeJournal::Open(const std::string& dir, int group_commit_ms, std::string& out_error)
+{
+    out_error.clear();
+
+    if (dir.empty())
+    {
+        out_error = "ChangeJournal: dir is empty.";
+        return false;
+    }
+
+    Close();
+
+    try
+    {
+        if (!fs::exists(dir))
+            fs::create_directories(dir);
+    }
+    catch (const std::exception& e)
+    {
+        out_error = std::string("ChangeJournal: create dir failed: ") + e.what();
+        return false;
+    }
+
+    std::lock_guard<std::mutex> io(io_mtx_);
+    dir_ = dir;
+    sealed_ = ListSegments(dir);
+
+    uint64_t last_gen = 0;
+    if (!sealed_.empty())
+        (void)ParseSegmentGen_(fs::path(sealed_.back()).filename().string(), last_gen);
+
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        gen_ = last_gen + 1;
+        pending_.clear();
+        appended_seq_ = durable_seq_ = 0;
+        write_failed_ = false;
+        error_unreported_.clear();
+        stop_ = false;
+        group_commit_ms_ = std::max(0, group_commit_ms);
+        touched_.clear();
+        bytes_since_rotate_ = 0;
+    }
+
+    open_.store(true, std::memory_order_release);
+    writer_ = std::thread(&SS_LightChangeJournal::WriterLoop_, this);
+    return true;
+}
+
+void SS_LightChangeJournal::Close()
+{
+    open_.store(false, std::memory_order_release);
+
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (writer_.joinable())
+        writer_.join();
+
+    {
+        std::lock_guard<std::mutex> io(io_mtx_);
+        (void)WritePending_();
+        if (file_)
+        {
+            sealed_.push_back(file_->path);
+            file_.reset();
+        }
+    }
+    durable_cv_.notify_all();
+    ReportError_();
+}
+
+void SS_LightChangeJournal::SetGroupCommitMs(int group_commit_ms)
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    group_commit_ms_ = std::max(0, group_commit_ms);
+}
+
+void SS_LightChangeJournal::SetErrorHandler(ErrorHandler handler)
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    error_handler_ = std::move(handler);
+}
+
+void SS_LightChangeJournal::Append(const std::vector<SS_LightEvent>& events)
+{
+    if (!IsOpen() || events.empty()) return;
+
+    std::lock_guard<std::mutex> lk(mtx_);
+    const bool was_empty = pending_.empty();
+    const size_t before = pending_.size();
+
+    for (const auto& ev : events)
+    {
+        if (const auto* p = std::get_if<SS_LightEventParamChanged>(&ev))
+        {
+            const bool is_channel = p->location == SS_LIGHT_PARAM_LOCATION::CHANNEL ||
+                (p->location == SS_LIGHT_PARAM_LOCATION::UNKNOWN && !p->channel_id.empty());
+            EncodeRecord_(is_channel ? SS_LightJournalOp::PARAM_CHANNEL : SS_LightJournalOp::PARAM_GLOBAL,
+                -1, p->instance_id, p->param_key, is_channel ? p->channel_id : std::string{}, p->value);
+        }
+        else if (const auto* c = std::get_if<SS_LightEventChannel>(&ev))
+        {
+            switch (c->type)
+            {
+            case SS_LightEventType::CHANNEL_ADDED:
+                EncodeRecord_(SS_LightJournalOp::CHANNEL_ADD, c->index, c->instance_id, {}, c->channel_id, c->display_name);
+                break;
+            case SS_LightEventType::CHANNEL_REMOVED:
+                EncodeRecord_(SS_LightJournalOp::CHANNEL_REMOVE, -1, c->instance_id, {}, c->channel_id, {});
+                break;
+            case SS_LightEventType::CHANNEL_RENAMED:
+                EncodeRecord_(SS_LightJournalOp::CHANNEL_RENAME, -1, c->instance_id, {}, c->channel_id, c->display_name);
+                break;
+            case SS_LightEventType::CHANNEL_REINDEXED:
+                EncodeRecord_(SS_LightJournalOp::CHANNEL_REINDEX, c->index, c->instance_id, {}, c->channel_id, {});
+                break;
+            default:
+                break;
+            }
+        }
+        else if (const auto* r = std::get_if<SS_LightEventInstanceRenamed>(&ev))
+        {
+            EncodeRecord_(SS_LightJournalOp::INSTANCE_RENAME, -1, r->instance_id, {}, {}, r->display_name);
+        }
+        // 连接配置等：改动少、调用方随后同步保存，不进日志
+    }
+
+    if (pending_.size() == before)
+        return;
+
+    ++appended_seq_;
+    if (was_empty)
+        cv_.notify_one();
+}
+
+void SS_LightChangeJournal::AppendInstanceDeleted(const std::string& instance_id)
+{
+    if (!IsOpen()) return;
+
+    std::lock_guard<std::mutex> lk(mtx_);
+    const bool was_empty = pending_.empty();
+    EncodeRecord_(SS_LightJournalOp::INSTANCE_DELETE, -1, instance_id, {}, {}, {});
+    ++appended_seq_;
+    if (was_empty)
+        cv_.notify_one();
+}
+
+void SS_LightChangeJournal::EncodeRecord_(SS_LightJournalOp op, int32_t index,
+    const std::string& instance_id, const std::string& key, const std::string& channel_id, const std::string& value)
+{
+    auto put_str16 = [&](const std::string& s) {
+        const size_t n = std::min<size_t>(s.size(), 0xFFFF);
+        PutLe_(pending_, n, 2);
+        pending_.append(s, 0, n);
+    };
+
+    // 先占位 len / crc，body 直接编码进缓冲，再回填
+    const size_t head = pending_.size();
+    pending_.append(8, '\0');
+
+    pending_.push_back(static_cast<char>(op));
+    PutLe_(pending_, static_cast<uint32_t>(index), 4);
+    put_str16(instance_id);
+    put_str16(key);
+    put_str16(channel_id);
+    PutLe_(pending_, static_cast<uint32_t>(value.size()), 4);
+    pending_.append(value);
+
+    const size_t body_len = pending_.size() - head - 8;
+    const uint32_t crc = Crc32_(reinterpret_cast<const uint8_t*>(pending_.data() + head + 8), body_len);
+    for (int i = 0; i < 4; ++i)
+    {
+        pending_[head + i] = static_cast<char>((body_len >> (8 * i)) & 0xFF);
+        pending_[head + 4 + i] = static_cast<char>((crc >> (8 * i)) & 0xFF);
+    }
+
+    ++records_;
+    bytes_since_rotate_ += body_len + 8;
+    touched_.insert(instance_id);
+}
+
+void SS_LightChangeJournal::WriterLoop_()
+{
+    std::unique_lock<std::mutex> lk(mtx_);
+    while (true)
+    {
+        cv_.wait(lk, [&] { return stop_ || !pending_.empty(); });
+        if (stop_)
+            break; // 剩下的缓冲由 Close 写出
+
+        // group commit：再等一个窗口，把紧接着的修改收进同一次 fsync
+        if (group_commit_ms_ > 0)
+            cv_.wait_for(lk, std::chrono::milliseconds(group_commit_ms_), [&] { return stop_; });
+
+        lk.unlock();
+        bool ok = true;
+        {
+            std::lock_guard<std::mutex> io(io_mtx_);
+            ok = WritePending_();
+        }
+        ReportError_();
+        lk.lock();
+
+        // 失败的缓冲已放回队首：隔一段时间再试
+        if (!ok)
+            cv_.wait_for(lk, std::chrono::milliseconds(kRetryMs), [&] { return stop_; });
+    }
+}
+
+void SS_LightChangeJournal::ReportError_()
+{
+    std::string msg;
+    ErrorHandler handler;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (error_unreported_.empty())
+            return;
+        msg.swap(error_unreported_);
+        handler = error_handler_;
+    }
+    if (handler)
+        handler(msg);
+}
+
+bool SS_LightChangeJournal::WritePending_()
+{
+    std::string buf;
+    uint64_t seq = 0;
+    uint64_t gen = 0;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (pending_.empty())
+            return true;
+        buf.swap(pending_);
+        seq = appended_seq_;
+        gen = gen_;
+    }
+
+    const std::string path = SegmentPath_(gen);
+    bool ok = true;
+    if (!file_)
+    {
+        file_.reset(new File_());
+        if (file_->Create(path))
+        {
+            ok = file_->Write(kJournalMagic, sizeof(kJournalMagic));
+        }
+        else
+        {
+            ok = false;
+            file_.reset();
+        }
+    }
+    ok = ok && file_->Write(buf.data(), buf.size()) && file_->Sync();
+
+    // 段里可能已有写了一半的记录，不能再往后追加（重放会停在断口）：封存，之后写进新段
+    if (!ok && file_)
+    {
+        sealed_.push_back(file_->path);
+        file_.reset();
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (ok)
+        {
+            durable_seq_ = seq;
+            ++commits_;
+            bytes_ += buf.size();
+            write_failed_ = false;
+        }
+        else
+        {
+            // 放回队首，保持记录顺序；重试时可能与已写进封存段的前半部分重复，重放结果不变（都是绝对操作）
+            buf.append(pending_);
+            pending_.swap(buf);
+            ++gen_;
+            if (!write_failed_)
+                error_unreported_ = "ChangeJournal: write/fsync failed: " + path;
+            write_failed_ = true;
+        }
+    }
+    durable_cv_.notify_all();
+    return ok;
+}
+
+bool SS_LightChangeJournal::Sync(int timeout_ms)
+{
+    std::unique_lock<std::mutex> lk(mtx_);
+    const uint64_t target = appended_seq_;
+    durable_cv_.wait_for(lk, std::chrono::milliseconds(std::max(0, timeout_ms)), [&] {
+        return durable_seq_ >= target || write_failed_ || stop_;
+    });
+    return durable_seq_ >= target && !write_failed_;
+}
+
+void SS_LightChangeJournal::Rotate(std::unordered_set<std::string>& out_touched)
+{
+    out_touched.clear();
+
+    std::lock_guard<std::mutex> io(io_mtx_);
+    (void)WritePending_();
+    if (file_)
+    {
+        sealed_.push_back(file_->path);
+        file_.reset();
+    }
+
+    std::lock_guard<std::mutex> lk(mtx_);
+    ++gen_;
+    out_touched.swap(touched_);
+    bytes_since_rotate_ = 0;
+}
+
+void SS_LightChangeJournal::DropSealed()
+{
+    std::lock_guard<std::mutex> io(io_mtx_);
+    for (const auto& p : sealed_)
+    {
+        std::error_code ec;
+        fs::remove(p, ec);
+    }
+    sealed_.clear();
+}
+
+std::vector<std::string> SS_LightChangeJournal::SealedSegments() const
+{
+    std::lock_guard<std::mutex> io(io_mtx_);
+    return sealed_;
+}
+
+uint64_t SS_LightChangeJournal::BytesSinceRotate() const
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    return bytes_since_rotate_;
+}
+
+void SS_LightChangeJournal::GetStats(uint64_t& out_records, uint64_t& out_commits, uint64_t& out_bytes) const
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    out_records = records_;
+    out_commits = commits_;
+    out_bytes = bytes_;
+}
+
+std::string SS_LightChangeJournal::SegmentPath_(uint64_t gen) const
+{
+    std::string digits = std::to_string(gen);
+    if (digits.size() < 8)
+        digits.insert(0, 8 - digits.size(), '0');
+    return (fs::path(dir_) / (kSegmentPrefix + digits + kSegmentSuffix)).string();
+}
+
+std::vector<std::string> SS_LightChangeJournal::ListSegments(const std::string& dir)
+{
+    std::vector<std::pair<uint64_t, std::string>> found;
+
+    std::error_code ec;
+    if (dir.empty() || !fs::is_directory(dir, ec))
+        return {};
+
+    for (const auto& entry : fs::directory_iterator(dir, ec))
+    {
+        if (!entry.is_regular_file(ec)) continue;
+        uint64_t gen = 0;
+        if (ParseSegmentGen_(entry.path().filename().string(), gen))
+            found.emplace_back(gen, entry.path().string());
+    }
+    std::sort(found.begin(), found.end());
+
+    std::vector<std::string> out;
+    out.reserve(found.size());
+    for (auto& f : found)
+        out.push_back(std::move(f.second));
+    return out;
+}
+
+bool SS_LightChangeJournal::ReadSegments(
+    const std::vector<std::string>& segments,
+    std::vector<SS_LightJournalRecord>& out_records,
+    std::string& out_error)
+{
+    out_error.clear();
+    out_records.clear();
+
+    std::vector<uint8_t> body;
+    for (const auto& path : segments)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open())
+        {
+            if (out_error.empty()) out_error = "ChangeJournal: open failed: " + path;
+            continue;
+        }
+
+        char magic[sizeof(kJournalMagic)] = {};
+        in.read(magic, sizeof(magic));
+        if (in.gcount() == 0)
+            continue; // 创建后还没写出就退出了
+        if (!in || std::char_traits<char>::compare(magic, kJournalMagic, sizeof(kJournalMagic)) != 0)
+        {
+            if (out_error.empty()) out_error = "ChangeJournal: bad magic: " + path;
+            continue;
+        }
+
+        while (true)
+        {
+            uint8_t head[8];
+            in.read(reinterpret_cast<char*>(head), sizeof(head));
+            if (in.gcount() != sizeof(head)) break;   // 正常结束或尾部截断
+
+            const uint32_t len = static_cast<uint32_t>(GetLe_(head, 4));
+            const uint32_t crc = static_cast<uint32_t>(GetLe_(head + 4, 4));
+            if (len < 1 + 4 + 2 + 2 + 2 + 4 || len > (64u << 20)) break;
+
+            body.resize(len);
+            in.read(reinterpret_cast<char*>(body.data()), len);
+            if (static_cast<uint32_t>(in.gcount()) != len) break;
+            if (Crc32_(body.data(), len) != crc) break;   // 写了一半的记录：之后的内容不可信
+
+            const uint8_t* p = body.data();
+            const uint8_t* end = p + len;
+
+            SS_LightJournalRecord rec;
+            const uint8_t op = *p++;
+            if (op < static_cast<uint8_t>(SS_LightJournalOp::PARAM_GLOBAL) ||
+                op > static_cast<uint8_t>(SS_LightJournalOp::INSTANCE_DELETE))
+                break;
+            rec.op = static_cast<SS_LightJournalOp>(op);
+            rec.index = static_cast<int32_t>(static_cast<uint32_t>(GetLe_(p, 4)));
+            p += 4;
+
+            bool ok = true;
+            auto get_str = [&](std::string& out, int len_bytes) {
+                if (!ok || end - p < len_bytes) { ok = false; return; }
+                const size_t n = static_cast<size_t>(GetLe_(p, len_bytes));
+                p += len_bytes;
+                if (static_cast<size_t>(end - p) < n) { ok = false; return; }
+                out.assign(reinterpret_cast<const char*>(p), n);
+                p += n;
+            };
+            get_str(rec.instance_id, 2);
+            get_str(rec.key, 2);
+            get_str(rec.channel_id, 2);
+            get_str(rec.value, 4);
+            if (!ok) break;
+
+            out_records.push_back(std::move(rec));
+        }
+    }
+
+    return out_error.empty();
+}
@@ -0,0 +1,128 @@
+// ss_light_resource_journal.h
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <unordered_set>
+
+#include "ss_light_resource_events.h"
+
+// 修改日志记录类型（值写死在文件里，只能追加）
+enum class SS_LightJournalOp : uint8_t
+{
+    PARAM_GLOBAL = 1,
+    PARAM_CHANNEL = 2,
+    CHANNEL_ADD = 3,
+    CHANNEL_REMOVE = 4,
+    CHANNEL_RENAME = 5,
+    CHANNEL_REINDEX = 6,
+    INSTANCE_RENAME = 7,
+    INSTANCE_DELETE = 8     // 之前该实例的记录全部作废
+};
+
+// 一条修改记录；全部是“设为某值”的绝对操作，重放到已包含其中一部分的 YAML 上结果不变
+struct SS_LightJournalRecord
+{
+    SS_LightJournalOp op = SS_LightJournalOp::PARAM_GLOBAL;
+    int32_t index = -1;        // CHANNEL_ADD / CHANNEL_REINDEX：通道号
+    std::string instance_id;
+    std::string key;           // PARAM_*
+    std::string channel_id;    // PARAM_CHANNEL / CHANNEL_*
+    std::string value;         // PARAM_*：值文本；CHANNEL_ADD / CHANNEL_RENAME / INSTANCE_RENAME：显示名
+};
+
+// 实例修改日志（write-ahead journal），一个实例目录一份：<instance_dir>/journal/
+// 段文件 changes.<gen>.wal：magic "SSLJNL01" + N 条记录
+//   record = u32 len(body) | u32 crc32(body) | body      （小端）
+//   body   = u8 op | i32 index | u16 id_len | id | u16 key_len | key | u16 ch_len | ch | u32 value_len | value
+// - Append 只编码进内存缓冲（不碰磁盘），后台线程 group commit：等 group_commit_ms 收齐一批，一次写出 + fsync
+// - Rotate 封存当前段，之后的记录进新段（新段在第一次写出时才创建）；封存段内容折叠进 YAML 后由 DropSealed 删除
+// - 读取时长度/CRC 不符即停止该段（崩溃时写了一半的尾部）
+// - 写出/fsync 失败：缓冲放回队首稍后重试，出错的段封存（尾部可能已损坏），重试写进新段
+class SS_LightChangeJournal
+{
+public:
+    using ErrorHandler = std::function<void(const std::string& message)>;
+
+    SS_LightChangeJournal();
+    ~SS_LightChangeJournal();
+
+    // 目录里已有的段视为封存段（等待折叠），新记录写入编号更大的新段
+    bool Open(const std::string& dir, int group_commit_ms, std::string& out_error);
+    // 写出缓冲并 fsync
+    void Close();
+    bool IsOpen() const { return open_.load(std::memory_order_acquire); }
+
+    void SetGroupCommitMs(int group_commit_ms);
+    // 写失败回调：在 writer 线程、不持有日志内部锁时调用；从正常转为失败时报一次，恢复后再失败再报
+    void SetErrorHandler(ErrorHandler handler);
+
+    // 模型变更事件 -> 记录（PARAM_CHANGED / CHANNEL_* / INSTANCE_RENAMED），其它事件忽略
+    // 未打开时直接返回（不加锁）
+    void Append(const std::vector<SS_LightEvent>& events);
+    void AppendInstanceDeleted(const std::string& instance_id);
+
+    // 等已追加的记录全部落盘；超时或写失败返回 false
+    bool Sync(int timeout_ms);
+
+    // 封存当前段；out_touched 为自上次 Rotate 以来有记录的实例
+    void Rotate(std::unordered_set<std::string>& out_touched);
+    // 删除全部封存段
+    void DropSealed();
+    // 封存段路径（按段号升序）
+    std::vector<std::string> SealedSegments() const;
+
+    uint64_t BytesSinceRotate() const;
+    void GetStats(uint64_t& out_records, uint64_t& out_commits, uint64_t& out_bytes) const;
+
+    // 目录下全部段（按段号升序）
+    static std::vector<std::string> ListSegments(const std::string& dir);
+    // 按给定顺序读取段；单个段尾部损坏只丢弃该段剩余部分
+    static bool ReadSegments(const std::vector<std::string>& segments, std::vector<SS_LightJournalRecord>& out_records, std::string& out_error);
+
+private:
+    struct File_;
+
+    // 需持有 mtx_
+    void EncodeRecord_(SS_LightJournalOp op, int32_t index, const std::string& instance_id,
+        const std::string& key, const std::string& channel_id, const std::string& value);
+    void WriterLoop_();
+    bool WritePending_();                                    // 需持有 io_mtx_
+    void ReportError_();                                     // 不得持有 io_mtx_ / mtx_
+    std::string SegmentPath_(uint64_t gen) const;
+
+private:
+    std::atomic_bool open_{ false };
+    std::string dir_;
+
+    // io_mtx_ 先于 mtx_：写文件/换段在 io_mtx_ 内，mtx_ 只保护内存状态，Append 从不等磁盘
+    mutable std::mutex io_mtx_;
+    std::unique_ptr<File_> file_;
+    uint64_t gen_ = 0;
+    std::vector<std::string> sealed_;
+
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    std::condition_variable durable_cv_;
+    std::string pending_;
+    uint64_t appended_seq_ = 0;
+    uint64_t durable_seq_ = 0;
+    bool write_failed_ = false;
+    std::string error_unreported_;
+    ErrorHandler error_handler_;
+    bool stop_ = false;
+    int group_commit_ms_ = 2;
+    std::unordered_set<std::string> touched_;
+    uint64_t bytes_since_rotate_ = 0;
+    uint64_t records_ = 0;
+    uint64_t commits_ = 0;
+    uint64_t bytes_ = 0;
+
+    std::thread writer_;
+};
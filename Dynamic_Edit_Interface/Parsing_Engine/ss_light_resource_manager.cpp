@@ -30,6 +30,36 @@ static bool IsDigits(const std::string& s)
     return true;
 }
 
+// 配方 id 直接作为文件名的一部分
+static bool IsSafeFileStem(const std::string& s)
+{
+    if (s.empty() || s == "." || s == "..") return false;
+    for (unsigned char c : s)
+    {
+        if (c < 0x20) return false;
+        if (std::string("\\/:*?\"<>|").find((char)c) != std::string::npos) return false;
+    }
+    return true;
+}
+
+// 实例文件内容哈希（FNV-1a 64），内容没变就不重写文件
+static uint64_t HashText(const std::string& s)
+{
+    uint64_t h = 1469598103934665603ull;
+    for (unsigned char c : s)
+    {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h ? h : 1; // 0 留给“未知”
+}
+
+// 延迟保存失败 / 修改日志写失败的 INSTANCE_ERROR 错误码
+static constexpr int kPersistErrorCode = SS_LIGHT_PERSIST_SAVE_FAILED;
+static constexpr int kJournalErrorCode = SS_LIGHT_PERSIST_JOURNAL_FAILED;
+// 修改日志大小检查间隔（compact_bytes 触发最迟多久被发现）
+static constexpr int kJournalPollMs = 1000;
+
 static std::string PickDefaultValueForParam(const SS_LightParamDef& def)
 {
     if (!def.default_value.empty()) return def.default_value;
@@ -37,12 +67,100 @@ static std::string PickDefaultValueForParam(const SS_LightParamDef& def)
     return std::string{};
 }
 
+// 修改日志重放：把 YAML 载入的实例推进到日志末尾的状态
+// 记录都是绝对操作，YAML 已包含其中一部分（折叠/保存后日志还没删）时重放结果不变
+static void ApplyJournalRecord(SS_LightControllerInstance& inst, const SS_LightControllerTemplate& tpl, const SS_LightJournalRecord& r)
+{
+    auto find_channel = [&](const std::string& channel_id) {
+        return std::find_if(inst.channels.begin(), inst.channels.end(),
+            [&](const SS_LightChannelItem& c) { return c.channel_id == channel_id; });
+    };
+
+    switch (r.op)
+    {
+    case SS_LightJournalOp::PARAM_GLOBAL:
+        inst.param_values.SetGlobal(r.key, r.value);
+        break;
+    case SS_LightJournalOp::PARAM_CHANNEL:
+        inst.param_values.SetChannel(r.key, r.channel_id, r.value);
+        break;
+    case SS_LightJournalOp::CHANNEL_ADD:
+    {
+        auto it = find_channel(r.channel_id);
+        if (it != inst.channels.end())
+        {
+            it->index = r.index;
+            it->order = r.index;
+            it->display_name = r.value;
+            break;
+        }
+
+        // 与 AddChannel 一致：追加到末尾，补齐通道参数默认值
+        SS_LightChannelItem item;
+        item.channel_id = r.channel_id;
+        item.index = r.index;
+        item.display_name = r.value;
+        item.order = r.index;
+        inst.channels.push_back(item);
+
+        for (const auto& kv : tpl.params)
+        {
+            const SS_LightParamDef& def = kv.second;
+            if (def.location != SS_LIGHT_PARAM_LOCATION::CHANNEL) continue;
+
+            const std::string key = def.key.empty() ? kv.first : def.key;
+            if (!inst.param_values.FindChannel(key, r.channel_id))
+                inst.param_values.SetChannel(key, r.channel_id, PickDefaultValueForParam(def));
+        }
+        break;
+    }
+    case SS_LightJournalOp::CHANNEL_REMOVE:
+    {
+        auto it = find_channel(r.channel_id);
+        if (it != inst.channels.end())
+            inst.channels.erase(it);
+        inst.param_values.EraseChannel(r.channel_id);
+        break;
+    }
+    case SS_LightJournalOp::CHANNEL_RENAME:
+    {
+        auto it = find_channel(r.channel_id);
+        if (it != inst.channels.end())
+            it->display_name = r.value;
+        break;
+    }
+    case SS_LightJournalOp::CHANNEL_REINDEX:
+    {
+        auto it = find_channel(r.channel_id);
+        if (it != inst.channels.end())
+        {
+            it->index = r.index;
+            it->order = r.index;
+        }
+        break;
+    }
+    case SS_LightJournalOp::INSTANCE_RENAME:
+        inst.info.display_name = r.value;
+        break;
+    default:
+        break;
+    }
+}
+
 SS_LightResourceManager::SS_LightResourceManager(std::string template_dir, std::string instance_dir)
     : template_dir_(std::move(template_dir))
     , instance_dir_(std::move(instance_dir))
 {
 }
 
+SS_LightResourceManager::~SS_LightResourceManager()
+{
+    StopStatsTimer_();
+    CancelConnectBatch();
+    StopPersistThread_();
+    journal_.Close();
+}
+
 bool SS_LightResourceManager::Init(std::string& out_error)
 {
     out_error.clear();
@@ -91,15 +209,74 @@ bool SS_LightResourceManager::Init(std::string& out_error)
         return false;
     if (!ReloadInstances(out_error))
         return false;
+    if (!ReloadRecipes(out_error))
+        return false;
+
+    bool want_journal = false;
+    {
+        std::lock_guard<std::mutex> lk(persist_mtx_);
+        want_journal = persist_opts_.journal;
+    }
+    if (want_journal)
+    {
+        std::string jerr;
+        if (!OpenJournal_(jerr))
+        {
+            /*out_error = "Init: open change journal failed: " + jerr;*/
+            out_error = "初始化：打开修改日志失败：" + jerr;
+            return false;
+        }
+    }
 
+    inited_.store(true);
     return true;
 }
 
 void SS_LightResourceManager::Shutdown()
 {
-    runtimes_.clear();
-    templates_.clear();
-    instance_paths_.clear();
+    StopStatsTimer_();
+    CancelConnectBatch();
+
+    // 关闭前最后一次拖动不丢
+    FlushCoalesced_();
+
+    // 延迟保存：停掉后台线程，剩下的脏实例在这里写完
+    StopPersistThread_();
+    {
+        std::string err;
+        (void)FlushPendingSaves(err);
+    }
+    {
+        std::lock_guard<std::mutex> lk(persist_mtx_);
+        persist_.clear();
+    }
+
+    // 修改日志折叠进 YAML 后关闭；折叠失败的段留在磁盘上，下次启动重放
+    inited_.store(false);
+    {
+        std::string err;
+        (void)CompactJournal(err);
+    }
+    journal_.Close();
+    {
+        std::lock_guard<std::mutex> lk(compact_mtx_);
+        compact_pending_.clear();
+    }
+
+    std::unordered_map<std::string, RuntimePtr> runtimes;
+    {
+        std::lock_guard<std::mutex> lk(registry_mtx_);
+        runtimes.swap(runtimes_);
+        templates_.clear();
+        instance_paths_.clear();
+        recipes_.clear();
+    }
+    runtimes.clear(); // 锁外析构：断开 transport 会回调
+    {
+        std::lock_guard<std::mutex> lk(stats_mtx_);
+        stats_collectors_.clear();
+    }
+    recorder_->Close();
 }
 
 bool SS_LightResourceManager::LoadTemplateFile(const std::string& template_yaml_path, std::string& out_error)
@@ -136,13 +313,14 @@ bool SS_LightResourceManager::LoadTemplateFile(const std::string& template_yaml_
         return false;
     }
 
+    SS_LightYamlCodec codec;
     SS_LightControllerTemplate tpl;
-    if (!codec_.LoadTemplate(template_yaml_path, tpl))
+    if (!codec.LoadTemplate(template_yaml_path, tpl))
     {
         //out_error = "LoadTemplateFile: LoadTemplate failed: " + template_yaml_path +
-        " | codec error: " + codec_.GetLastError();
+        " | codec error: " + codec.GetLastError();
         out_error = "加载模板文件：加载模板失败：" + template_yaml_path +
-            " | 编码器错误：" + codec_.GetLastError();
+            " | 编码器错误：" + codec.GetLastError();
         return false;
     }
 
@@ -153,7 +331,11 @@ bool SS_LightResourceManager::LoadTemplateFile(const std::string& template_yaml_
         return false;
     }
 
-    templates_[tpl.info.template_id] = std::move(tpl);
+    const std::string template_id = tpl.info.template_id;
+    auto shared = std::make_shared<const SS_LightControllerTemplate>(std::move(tpl));
+
+    std::lock_guard<std::mutex> lk(registry_mtx_);
+    templates_[template_id] = std::move(shared);
     return true;
 }
 
@@ -192,19 +374,20 @@ bool SS_LightResourceManager::ReloadTemplates(std::string& out_error)
 
     std::sort(files.begin(), files.end());
 
-    std::unordered_map<std::string, SS_LightControllerTemplate> new_templates;
+    std::unordered_map<std::string, std::shared_ptr<const SS_LightControllerTemplate>> new_templates;
 
+    SS_LightYamlCodec codec;
     for (const auto& p : files)
     {
         SS_LightControllerTemplate tpl;
         const std::string path_str = p.string();
 
-        if (!codec_.LoadTemplate(path_str, tpl))
+        if (!codec.LoadTemplate(path_str, tpl))
         {
             //out_error = "ReloadTemplates: LoadTemplate failed: " + path_str +
-            //    " | codec error: " + codec_.GetLastError();
+            //    " | codec error: " + codec.GetLastError();
             out_error = "重新加载模板：加载模板失败：" + path_str +
-                " | 编码器错误：" + codec_.GetLastError();
+                " | 编码器错误：" + codec.GetLastError();
             return false;
         }
 
@@ -215,9 +398,11 @@ bool SS_LightResourceManager::ReloadTemplates(std::string& out_error)
             return false;
         }
 
-        new_templates[tpl.info.template_id] = std::move(tpl);
+        const std::string template_id = tpl.info.template_id;
+        new_templates[template_id] = std::make_shared<const SS_LightControllerTemplate>(std::move(tpl));
     }
 
+    std::lock_guard<std::mutex> lk(registry_mtx_);
     templates_ = std::move(new_templates);
     return true;
 }
@@ -225,9 +410,12 @@ bool SS_LightResourceManager::ReloadTemplates(std::string& out_error)
 std::vector<std::string> SS_LightResourceManager::ListTemplateIds() const
 {
     std::vector<std::string> ids;
-    ids.reserve(templates_.size());
-    for (const auto& kv : templates_)
-        ids.push_back(kv.first);
+    {
+        std::lock_guard<std::mutex> lk(registry_mtx_);
+        ids.reserve(templates_.size());
+        for (const auto& kv : templates_)
+            ids.push_back(kv.first);
+    }
 
     std::sort(ids.begin(), ids.end());
     return ids;
@@ -235,13 +423,18 @@ std::vector<std::string> SS_LightResourceManager::ListTemplateIds() const
 
 bool SS_LightResourceManager::GetTemplate(const std::string& template_id, SS_LightControllerTemplate& out_tpl) const
 {
-    auto it = templates_.find(template_id);
-    if (it == templates_.end())
+    std::shared_ptr<const SS_LightControllerTemplate> tpl = FindTemplate(template_id);
+    if (!tpl)
         return false;
-    out_tpl = it->second;
+    out_tpl = *tpl;
     return true;
 }
 
+std::shared_ptr<const SS_LightControllerTemplate> SS_LightResourceManager::GetTemplateShared(const std::string& template_id) const
+{
+    return FindTemplate(template_id);
+}
+
 bool SS_LightResourceManager::LoadInstanceFile(const std::string& instance_yaml_path, std::string& out_error)
 {
     out_error.clear();
@@ -269,13 +462,14 @@ bool SS_LightResourceManager::LoadInstanceFile(const std::string& instance_yaml_
     }
 
     // 兼容：这里不再强行限制文件名必须 controller_*
+    SS_LightYamlCodec codec;
     SS_LightControllerInstance inst;
-    if (!codec_.LoadInstance(instance_yaml_path, inst))
+    if (!codec.LoadInstance(instance_yaml_path, inst))
     {
         //out_error = "LoadInstanceFile: LoadInstance failed: " + instance_yaml_path +
-        //    " | codec error: " + codec_.GetLastError();
+        //    " | codec error: " + codec.GetLastError();
         out_error = "加载实例文件：加载实例失败：" + instance_yaml_path +
-            " | 编码器错误：" + codec_.GetLastError();
+            " | 编码器错误：" + codec.GetLastError();
         return false;
     }
 
@@ -283,14 +477,48 @@ bool SS_LightResourceManager::LoadInstanceFile(const std::string& instance_yaml_
         return false;
 
     // 记录路径：instance_id -> yaml
+    std::lock_guard<std::mutex> lk(registry_mtx_);
     instance_paths_[inst.info.instance_id] = fs::absolute(p).string();
     return true;
 }
 
+void SS_LightResourceManager::FlushCoalesced_()
+{
+    for (const auto& kv : ListRuntimes_())
+    {
+        SS_LightControllerRuntime::WriteScope ws(*kv.second, false);
+        if (!kv.second->HasPendingCoalesced()) continue;
+
+        ws.MarkChanged();
+        std::vector<SS_LightCoalescedResult> sent;
+        kv.second->PollCoalesced(true, sent);
+
+        std::string err;
+        (void)SaveInstanceById(kv.first, err);
+    }
+}
+
 bool SS_LightResourceManager::ReloadInstances(std::string& out_error)
 {
     out_error.clear();
 
+    // 后台批量连接的线程持有旧 runtime 并回写 batch 状态：换表前停掉并等它们退出
+    CancelConnectBatch();
+
+    // 旧 runtime 上挂起的合并值换表后就没人发了：先发出并落盘
+    FlushCoalesced_();
+
+    // 先把还没写出的修改落盘，否则重新加载会读到旧文件
+    {
+        std::string flush_err;
+        (void)FlushPendingSaves(flush_err);
+    }
+    if (journal_.IsOpen())
+    {
+        std::string compact_err;
+        (void)CompactJournal(compact_err);
+    }
+
     fs::path dir(instance_dir_);
     if (instance_dir_.empty())
     {
@@ -323,20 +551,42 @@ bool SS_LightResourceManager::ReloadInstances(std::string& out_error)
     }
     std::sort(files.begin(), files.end());
 
-    std::unordered_map<std::string, std::unique_ptr<SS_LightControllerRuntime>> new_runtimes;
+    // 修改日志：日志已打开时只剩折叠失败的封存段；否则是上次退出/崩溃遗留的全部段
+    const std::vector<std::string> segments = journal_.IsOpen()
+        ? journal_.SealedSegments()
+        : SS_LightChangeJournal::ListSegments(JournalDir_());
+    std::unordered_map<std::string, std::vector<SS_LightJournalRecord>> replay;
+    if (!segments.empty())
+    {
+        std::vector<SS_LightJournalRecord> records;
+        std::string journal_err;
+        (void)SS_LightChangeJournal::ReadSegments(segments, records, journal_err); // 损坏的段/尾部跳过
+        for (auto& r : records)
+        {
+            auto& list = replay[r.instance_id];
+            if (r.op == SS_LightJournalOp::INSTANCE_DELETE)
+                list.clear();
+            else
+                list.push_back(std::move(r));
+        }
+    }
+    std::vector<std::string> replayed_ids;
+
+    std::unordered_map<std::string, RuntimePtr> new_runtimes;
     std::unordered_map<std::string, std::string> new_paths;
 
+    SS_LightYamlCodec codec;
     for (const auto& p : files)
     {
         const std::string path_str = p.string();
 
         SS_LightControllerInstance inst;
-        if (!codec_.LoadInstance(path_str, inst))
+        if (!codec.LoadInstance(path_str, inst))
         {
             /*out_error = "ReloadInstances: LoadInstance failed: " + path_str +
-                " | codec error: " + codec_.GetLastError();*/
+                " | codec error: " + codec.GetLastError();*/
             out_error = "重新加载实例：加载实例失败：" + path_str +
-                " | 编码器错误：" + codec_.GetLastError();
+                " | 编码器错误：" + codec.GetLastError();
             return false;
         }
 
@@ -353,7 +603,7 @@ bool SS_LightResourceManager::ReloadInstances(std::string& out_error)
             return false;
         }
 
-        const SS_LightControllerTemplate* tpl = FindTemplate(inst.info.template_id);
+        std::shared_ptr<const SS_LightControllerTemplate> tpl = FindTemplate(inst.info.template_id);
         if (!tpl)
         {
             /*out_error = "ReloadInstances: template not found for instance_id=" + inst.info.instance_id +
@@ -363,10 +613,20 @@ bool SS_LightResourceManager::ReloadInstances(std::string& out_error)
             return false;
         }
 
-        auto rt = std::make_unique<SS_LightControllerRuntime>();
-        rt->BindTemplate(*tpl);
+        auto jit = replay.find(inst.info.instance_id);
+        if (jit != replay.end() && !jit->second.empty())
+        {
+            for (const auto& r : jit->second)
+                ApplyJournalRecord(inst, *tpl, r);
+            replayed_ids.push_back(inst.info.instance_id);
+        }
+
+        auto rt = std::make_shared<SS_LightControllerRuntime>();
+        rt->BindTemplate(tpl);
         rt->BindInstance(inst);
         rt->SetEventBus(event_bus_);
+        rt->SetJournal(&journal_);
+        rt->SetTrafficRecorder(recorder_);
 
         if (new_runtimes.find(inst.info.instance_id) != new_runtimes.end())
         {
@@ -381,8 +641,60 @@ bool SS_LightResourceManager::ReloadInstances(std::string& out_error)
         new_paths[inst.info.instance_id] = fs::absolute(p).string();
     }
 
-    runtimes_ = std::move(new_runtimes);
-    instance_paths_ = std::move(new_paths);
+    // 统计采集器随 runtime 整表替换：旧 runtime 的采集器不再上报
+    std::unordered_map<std::string, std::shared_ptr<SS_LightConnectionStatsCollector>> new_collectors;
+    for (const auto& kv : new_runtimes)
+    {
+        if (kv.second->GetStatsCollector())
+            new_collectors[kv.first] = kv.second->GetStatsCollector();
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(registry_mtx_);
+        // 新 runtime 尚未发布，coalesce_opts_ 在同一把锁内读取，不会与 SetCoalesceOptions 交错
+        for (const auto& kv : new_runtimes)
+            kv.second->SetCoalesceOptions(coalesce_opts_);
+        runtimes_.swap(new_runtimes);
+        instance_paths_ = std::move(new_paths);
+    }
+    {
+        std::lock_guard<std::mutex> lk(stats_mtx_);
+        stats_collectors_.swap(new_collectors);
+    }
+    // new_runtimes / new_collectors 此时是旧表，在锁外析构
+
+    // 重放过的实例立即写回 YAML；全部写成功才删除这些段，否则留给下次折叠/启动
+    if (!segments.empty())
+    {
+        bool all_ok = true;
+        for (const auto& id : replayed_ids)
+        {
+            std::string err;
+            if (WriteInstanceFile_(id, err))
+                continue;
+            all_ok = false;
+            std::lock_guard<std::mutex> lk(compact_mtx_);
+            compact_pending_.insert(id);
+        }
+
+        if (all_ok)
+        {
+            if (journal_.IsOpen())
+            {
+                std::lock_guard<std::mutex> lk(compact_mtx_);
+                compact_pending_.clear();
+                journal_.DropSealed();
+            }
+            else
+            {
+                for (const auto& seg : segments)
+                {
+                    std::error_code ec;
+                    fs::remove(seg, ec);
+                }
+            }
+        }
+    }
     return true;
 }
 
@@ -403,7 +715,7 @@ bool SS_LightResourceManager::AddOrReplaceInstance(const SS_LightControllerInsta
         return false;
     }
 
-    const SS_LightControllerTemplate* tpl = FindTemplate(inst.info.template_id);
+    std::shared_ptr<const SS_LightControllerTemplate> tpl = FindTemplate(inst.info.template_id);
     if (!tpl)
     {
         /*out_error = "Template not found: " + inst.info.template_id;*/
@@ -411,27 +723,72 @@ bool SS_LightResourceManager::AddOrReplaceInstance(const SS_LightControllerInsta
         return false;
     }
 
-    auto rt = std::make_unique<SS_LightControllerRuntime>();
-    rt->BindTemplate(*tpl);
+    auto rt = std::make_shared<SS_LightControllerRuntime>();
+    rt->BindTemplate(tpl);
     rt->BindInstance(inst);
     rt->SetEventBus(event_bus_);
+    rt->SetJournal(&journal_);
+    rt->SetTrafficRecorder(recorder_);
 
-    runtimes_[inst.info.instance_id] = std::move(rt);
+    StopConnectBatchIfBusy_(inst.info.instance_id);
+    SetStatsCollector_(inst.info.instance_id, rt->GetStatsCollector());
+
+    RuntimePtr old;
+    {
+        std::lock_guard<std::mutex> lk(registry_mtx_);
+        rt->SetCoalesceOptions(coalesce_opts_);
+        RuntimePtr& slot = runtimes_[inst.info.instance_id];
+        old.swap(slot);
+        slot = std::move(rt);
+    }
+    // old（若有）在锁外析构；正在其上执行的写操作持有自己的引用，完成后随之释放
     return true;
 }
 
 bool SS_LightResourceManager::RemoveInstance(const std::string& instance_id)
 {
-    instance_paths_.erase(instance_id);
-    return runtimes_.erase(instance_id) > 0;
+    StopConnectBatchIfBusy_(instance_id);
+    SetStatsCollector_(instance_id, nullptr);
+
+    // 只从内存移除、文件保留：挂起的延迟保存先写完
+    bool dirty = false;
+    {
+        std::lock_guard<std::mutex> lk(persist_mtx_);
+        auto it = persist_.find(instance_id);
+        dirty = it != persist_.end() && it->second.dirty;
+    }
+    if (dirty)
+    {
+        std::string err;
+        (void)WriteInstanceFile_(instance_id, err);
+    }
+    {
+        std::lock_guard<std::mutex> lk(persist_mtx_);
+        persist_.erase(instance_id);
+    }
+
+    RuntimePtr removed;
+    {
+        std::lock_guard<std::mutex> lk(registry_mtx_);
+        instance_paths_.erase(instance_id);
+        auto it = runtimes_.find(instance_id);
+        if (it == runtimes_.end())
+            return false;
+        removed = std::move(it->second);
+        runtimes_.erase(it);
+    }
+    return true;
 }
 
 std::vector<std::string> SS_LightResourceManager::ListInstanceIds() const
 {
     std::vector<std::string> ids;
-    ids.reserve(runtimes_.size());
-    for (const auto& kv : runtimes_)
-        ids.push_back(kv.first);
+    {
+        std::lock_guard<std::mutex> lk(registry_mtx_);
+        ids.reserve(runtimes_.size());
+        for (const auto& kv : runtimes_)
+            ids.push_back(kv.first);
+    }
 
     std::sort(ids.begin(), ids.end());
     return ids;
@@ -439,32 +796,51 @@ std::vector<std::string> SS_LightResourceManager::ListInstanceIds() const
 
 bool SS_LightResourceManager::GetInstance(const std::string& instance_id, SS_LightControllerInstance& out_inst) const
 {
-    const SS_LightControllerRuntime* rt = FindRuntime(instance_id);
+    RuntimePtr rt = FindRuntime(instance_id);
     if (!rt) return false;
-    out_inst = rt->GetInstance();
+    out_inst = *rt->LoadSnapshot(); // 不可变快照，不等待该实例的写者
     return true;
 }
 
+std::shared_ptr<const SS_LightControllerInstance> SS_LightResourceManager::GetInstanceShared(const std::string& instance_id) const
+{
+    RuntimePtr rt = FindRuntime(instance_id);
+    if (!rt) return nullptr;
+    return rt->LoadSnapshot();
+}
+
 bool SS_LightResourceManager::RenameController(const std::string& instance_id, const std::string& new_display_name)
 {
-    SS_LightControllerRuntime* rt = FindRuntime(instance_id);
+    RuntimePtr rt = FindRuntime(instance_id);
     if (!rt) return false;
-    rt->GetInstanceMutable().info.display_name = new_display_name;
+    SS_LightControllerRuntime::WriteScope ws(*rt);
+    auto& info = rt->GetInstanceMutable().info;
+    if (info.display_name == new_display_name)
+        return true;
+
+    info.display_name = new_display_name;
+
+    SS_LightEventInstanceRenamed ev;
+    ev.instance_id = instance_id;
+    ev.display_name = new_display_name;
+    rt->QueueModelEvent(std::move(ev));
     return true;
 }
 
 bool SS_LightResourceManager::SetControllerEnabled(const std::string& instance_id, bool enabled)
 {
-    SS_LightControllerRuntime* rt = FindRuntime(instance_id);
+    RuntimePtr rt = FindRuntime(instance_id);
     if (!rt) return false;
+    SS_LightControllerRuntime::WriteScope ws(*rt);
     rt->GetInstanceMutable().info.enabled = enabled;
     return true;
 }
 
 bool SS_LightResourceManager::SetControllerOrder(const std::string& instance_id, int order)
 {
-    SS_LightControllerRuntime* rt = FindRuntime(instance_id);
+    RuntimePtr rt = FindRuntime(instance_id);
     if (!rt) return false;
+    SS_LightControllerRuntime::WriteScope ws(*rt);
     rt->GetInstanceMutable().info.order = order;
     return true;
 }
@@ -477,12 +853,13 @@ bool SS_LightResourceManager::AddChannel(
 {
     out_channel_id.clear();
 
-    SS_LightControllerRuntime* rt = FindRuntime(instance_id);
+    RuntimePtr rt = FindRuntime(instance_id);
     if (!rt) return false;
+    SS_LightControllerRuntime::WriteScope ws(*rt);
 
     auto& inst = rt->GetInstanceMutable();
 
-    const SS_LightControllerTemplate* tpl = FindTemplate(inst.info.template_id);
+    std::shared_ptr<const SS_LightControllerTemplate> tpl = FindTemplate(inst.info.template_id);
     if (!tpl) return false;
 
     const int channel_max = tpl->info.channel_max;
@@ -494,19 +871,14 @@ bool SS_LightResourceManager::AddChannel(
     if (static_cast<int>(inst.channels.size()) >= channel_max)
         return false;
 
-    for (const auto& ch : inst.channels)
-    {
-        if (ch.index == channel_index)
-            return false;
-    }
+    if (rt->FindChannelHandleByIndex(channel_index) >= 0)
+        return false;
 
     std::string base = "ch_" + std::to_string(channel_index);
     std::string cid = base;
 
     auto exists_id = [&](const std::string& id) {
-        for (const auto& ch : inst.channels)
-            if (ch.channel_id == id) return true;
-        return false;
+        return rt->FindChannelHandle(id) >= 0;
     };
 
     if (exists_id(cid))
@@ -531,6 +903,7 @@ bool SS_LightResourceManager::AddChannel(
     item.order = channel_index;
 
     inst.channels.push_back(item);
+    rt->ReindexChannels();
 
     for (const auto& kv : tpl->params)
     {
@@ -538,11 +911,19 @@ bool SS_LightResourceManager::AddChannel(
         if (def.location != SS_LIGHT_PARAM_LOCATION::CHANNEL) continue;
 
         const std::string key = def.key.empty() ? kv.first : def.key;
-        auto& per_channel = inst.channel_param_values[key];
-        if (per_channel.find(cid) == per_channel.end())
-            per_channel[cid] = PickDefaultValueForParam(def);
+        if (!inst.param_values.FindChannel(key, cid))
+            inst.param_values.SetChannel(key, cid, PickDefaultValueForParam(def));
     }
 
+    // 新通道的默认参数值随快照一起可见，不逐条发 PARAM_CHANGED
+    SS_LightEventChannel ev;
+    ev.type = SS_LightEventType::CHANNEL_ADDED;
+    ev.instance_id = instance_id;
+    ev.channel_id = cid;
+    ev.display_name = item.display_name;
+    ev.index = channel_index;
+    rt->QueueModelEvent(std::move(ev));
+
     out_channel_id = cid;
     return true;
 }
@@ -552,38 +933,48 @@ bool SS_LightResourceManager::RenameChannel(
     const std::string& channel_id,
     const std::string& new_display_name)
 {
-    SS_LightControllerRuntime* rt = FindRuntime(instance_id);
+    RuntimePtr rt = FindRuntime(instance_id);
     if (!rt) return false;
+    SS_LightControllerRuntime::WriteScope ws(*rt);
 
-    auto& inst = rt->GetInstanceMutable();
-    for (auto& ch : inst.channels)
-    {
-        if (ch.channel_id == channel_id)
-        {
-            ch.display_name = new_display_name;
-            return true;
-        }
-    }
-    return false;
+    const int h = rt->FindChannelHandle(channel_id);
+    if (h < 0) return false;
+
+    std::string& name = rt->GetInstanceMutable().channels[h].display_name;
+    if (name == new_display_name)
+        return true;
+
+    name = new_display_name;
+
+    SS_LightEventChannel ev;
+    ev.type = SS_LightEventType::CHANNEL_RENAMED;
+    ev.instance_id = instance_id;
+    ev.channel_id = channel_id;
+    ev.display_name = new_display_name;
+    rt->QueueModelEvent(std::move(ev));
+    return true;
 }
 
 bool SS_LightResourceManager::RemoveChannel(const std::string& instance_id, const std::string& channel_id)
 {
-    SS_LightControllerRuntime* rt = FindRuntime(instance_id);
+    RuntimePtr rt = FindRuntime(instance_id);
     if (!rt) return false;
+    SS_LightControllerRuntime::WriteScope ws(*rt);
 
-    auto& inst = rt->GetInstanceMutable();
-
-    auto old_size = inst.channels.size();
-    inst.channels.erase(
-        std::remove_if(inst.channels.begin(), inst.channels.end(),
-            [&](const SS_LightChannelItem& c) { return c.channel_id == channel_id; }),
-        inst.channels.end());
+    const int h = rt->FindChannelHandle(channel_id);
+    if (h < 0) return false;
 
-    if (inst.channels.size() == old_size)
-        return false;
+    auto& inst = rt->GetInstanceMutable();
+    inst.channels.erase(inst.channels.begin() + h);
+    rt->ReindexChannels();
 
     CleanupChannelParamValues(inst, channel_id);
+
+    SS_LightEventChannel ev;
+    ev.type = SS_LightEventType::CHANNEL_REMOVED;
+    ev.instance_id = instance_id;
+    ev.channel_id = channel_id;
+    rt->QueueModelEvent(std::move(ev));
     return true;
 }
 
@@ -594,17 +985,18 @@ bool SS_LightResourceManager::SetChannelIndex(const std::string& instance_id,
 {
     out_error.clear();
 
-    SS_LightControllerRuntime* rt = FindRuntime(instance_id);
+    RuntimePtr rt = FindRuntime(instance_id);
     if (!rt)
     {
         /*out_error = "SetChannelIndex: instance not found: " + instance_id;*/
         out_error = "设置通道索引：实例未找到：" + instance_id;
         return false;
     }
+    SS_LightControllerRuntime::WriteScope ws(*rt);
 
     auto& inst = rt->GetInstanceMutable();
 
-    const SS_LightControllerTemplate* tpl = FindTemplate(inst.info.template_id);
+    std::shared_ptr<const SS_LightControllerTemplate> tpl = FindTemplate(inst.info.template_id);
     if (!tpl)
     {
         /*out_error = "SetChannelIndex: template not found: " + inst.info.template_id;*/
@@ -628,41 +1020,70 @@ bool SS_LightResourceManager::SetChannelIndex(const std::string& instance_id,
     }
 
     // 找到要改的通道
-    SS_LightChannelItem* target = nullptr;
-    for (auto& ch : inst.channels)
-    {
-        if (ch.channel_id == channel_id)
-        {
-            target = &ch;
-            break;
-        }
-    }
-    if (!target)
+    const int h = rt->FindChannelHandle(channel_id);
+    if (h < 0)
     {
         /*out_error = "SetChannelIndex: channel_id not found: " + channel_id;*/
         out_error = "设置通道索引：未找到通道 ID：" + channel_id;
         return false;
     }
 
+    SS_LightChannelItem& target = inst.channels[h];
+
     // 若没变，直接成功
-    if (target->index == new_channel_index)
+    if (target.index == new_channel_index)
         return true;
 
     // 冲突检查：是否被其它通道占用
-    for (const auto& ch : inst.channels)
+    const int other = rt->FindChannelHandleByIndex(new_channel_index);
+    if (other >= 0 && other != h)
     {
-        if (ch.channel_id != channel_id && ch.index == new_channel_index)
-        {
-            /*out_error = "SetChannelIndex: new index already used by channel_id=" + ch.channel_id;*/
-            out_error = "设置通道索引：新索引已被通道 ID=" + ch.channel_id + " 占用";
-            return false;
-        }
+        /*out_error = "SetChannelIndex: new index already used by channel_id=" + inst.channels[other].channel_id;*/
+        out_error = "设置通道索引：新索引已被通道 ID=" + inst.channels[other].channel_id + " 占用";
+        return false;
     }
 
     // 更新 index
-    target->index = new_channel_index;
-    target->order = new_channel_index; // 可选：保持排序一致
+    SS_LightEventChannel ev;
+    ev.type = SS_LightEventType::CHANNEL_REINDEXED;
+    ev.instance_id = instance_id;
+    ev.channel_id = channel_id;
+    ev.display_name = target.display_name;
+    ev.old_index = target.index;
+    ev.index = new_channel_index;
+
+    target.index = new_channel_index;
+    target.order = new_channel_index; // 可选：保持排序一致
+    rt->ReindexChannels();
+
+    rt->QueueModelEvent(std::move(ev));
+    return true;
+}
+
+bool SS_LightResourceManager::ResolveChannelHandle(const std::string& instance_id,
+    const std::string& channel_id,
+    int& out_handle,
+    std::string& out_error) const
+{
+    out_handle = -1;
+    out_error.clear();
+
+    RuntimePtr rt = FindRuntime(instance_id);
+    if (!rt)
+    {
+        /*out_error = "ResolveChannelHandle: instance not found: " + instance_id;*/
+        out_error = "解析通道句柄：实例未找到：" + instance_id;
+        return false;
+    }
+    SS_LightControllerRuntime::WriteScope ws(*rt, false); // 通道索引缓存是写者状态
 
+    out_handle = rt->FindChannelHandle(channel_id);
+    if (out_handle < 0)
+    {
+        /*out_error = "ResolveChannelHandle: channel_id not found: " + channel_id;*/
+        out_error = "解析通道句柄：未找到通道 ID：" + channel_id;
+        return false;
+    }
     return true;
 }
 
@@ -674,17 +1095,18 @@ bool SS_LightResourceManager::AddDefaultChannel(
     out_channel_id.clear();
     out_error.clear();
 
-    SS_LightControllerRuntime* rt = FindRuntime(instance_id);
+    RuntimePtr rt = FindRuntime(instance_id);
     if (!rt)
     {
         /*out_error = "AddDefaultChannel: instance not found: " + instance_id;*/
         out_error = "添加默认通道：未找到实例：" + instance_id;
         return false;
     }
+    SS_LightControllerRuntime::WriteScope ws(*rt);
 
     auto& inst = rt->GetInstanceMutable();
 
-    const SS_LightControllerTemplate* tpl = FindTemplate(inst.info.template_id);
+    std::shared_ptr<const SS_LightControllerTemplate> tpl = FindTemplate(inst.info.template_id);
     if (!tpl)
     {
         /*out_error = "AddDefaultChannel: template not found: " + inst.info.template_id;*/
@@ -749,10 +1171,8 @@ bool SS_LightResourceManager::AddDefaultChannel(
             continue;
 
         const std::string key = def.key.empty() ? kv.first : def.key;
-        auto& per_channel = inst.channel_param_values[key];
-
-        if (per_channel.find(new_channel_id) == per_channel.end())
-            per_channel[new_channel_id] = PickDefaultValueForParam(def);
+        if (!inst.param_values.FindChannel(key, new_channel_id))
+            inst.param_values.SetChannel(key, new_channel_id, PickDefaultValueForParam(def));
     }
 
     out_channel_id = new_channel_id;
@@ -785,11 +1205,14 @@ bool SS_LightResourceManager::ResolveInstancePath(
     }
 
     // 1) 优先查映射表（支持 UUID / 任意 id）
-    auto it = instance_paths_.find(instance_id);
-    if (it != instance_paths_.end() && !it->second.empty())
     {
-        out_path = it->second;
-        return true;
+        std::lock_guard<std::mutex> lk(registry_mtx_);
+        auto it = instance_paths_.find(instance_id);
+        if (it != instance_paths_.end() && !it->second.empty())
+        {
+            out_path = it->second;
+            return true;
+        }
     }
 
     // 2) fallback：兼容旧规则 controller_<digits> -> instance_dir_/controller_<digits>_instance.yaml
@@ -818,7 +1241,21 @@ bool SS_LightResourceManager::SaveInstanceById(const std::string& instance_id, s
 {
     out_error.clear();
 
-    SS_LightControllerRuntime* rt = FindRuntime(instance_id);
+    if (!FindRuntime(instance_id))
+    {
+        /*out_error = "SaveInstanceById: instance not found: " + instance_id;*/
+        out_error = "保存实例（按 ID 查找）：未找到实例：" + instance_id;
+        return false;
+    }
+
+    return WriteInstanceFile_(instance_id, out_error);
+}
+
+bool SS_LightResourceManager::WriteInstanceFile_(const std::string& instance_id, std::string& out_error)
+{
+    out_error.clear();
+
+    RuntimePtr rt = FindRuntime(instance_id);
     if (!rt)
     {
         /*out_error = "SaveInstanceById: instance not found: " + instance_id;*/
@@ -842,88 +1279,927 @@ bool SS_LightResourceManager::SaveInstanceById(const std::string& instance_id, s
         return false;
     }
 
-    const SS_LightControllerInstance& inst = rt->GetInstance();
-    if (!codec_.SaveInstance(path, inst))
+    // 1) 写锁内序列化：拿到的是调用时刻（含外层作用域尚未发布的修改）的完整内容
+    SS_LightYamlCodec codec;
+    std::string text;
+    uint64_t seq = 0;
+    {
+        SS_LightControllerRuntime::WriteScope ws(*rt, false);
+        if (!codec.EncodeInstance(rt->GetInstance(), text))
+        {
+            /*out_error = "SaveInstanceById: SaveInstance failed: " + path +
+                " | codec error: " + codec.GetLastError();*/
+            out_error = "保存实例（按实例 ID 保存）：保存实例操作失败：" + path +
+                " | 编码器错误：" + codec.GetLastError();
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lk(persist_mtx_);
+        PersistEntry& e = persist_[instance_id];
+        seq = ++e.encoded_seq;
+        e.dirty = false; // 此前的修改都已包含在 text 里
+    }
+    const uint64_t hash = HashText(text);
+
+    // 2) 锁外写文件；save_mtx_ 保证同一文件不会被较旧的内容覆盖，也不会与删除交错
+    std::lock_guard<std::mutex> save_lk(save_mtx_);
+    if (!FindRuntime(instance_id))
+        return true; // 期间被删除/移除，不再写回
+
+    {
+        std::lock_guard<std::mutex> lk(persist_mtx_);
+        PersistEntry& e = persist_[instance_id];
+        if (e.written_seq >= seq)
+            return true; // 更新的内容已经写过
+        if (e.written_hash == hash)
+        {
+            e.written_seq = seq;
+            ++persist_stats_.skipped_unchanged;
+            return true;
+        }
+    }
+
+    if (!codec.WriteFileAtomic(path, text))
     {
         /*out_error = "SaveInstanceById: SaveInstance failed: " + path +
-            " | codec error: " + codec_.GetLastError();*/
+            " | codec error: " + codec.GetLastError();*/
         out_error = "保存实例（按实例 ID 保存）：保存实例操作失败：" + path +
-            " | 编码器错误：" + codec_.GetLastError();
+            " | 编码器错误：" + codec.GetLastError();
         return false;
     }
 
+    {
+        std::lock_guard<std::mutex> lk(persist_mtx_);
+        PersistEntry& e = persist_[instance_id];
+        e.written_seq = seq;
+        e.written_hash = hash;
+        ++persist_stats_.files_written;
+    }
+
     // 保存成功后确保映射存在（防止外部手动 Remove 了 map）
+    std::lock_guard<std::mutex> lk(registry_mtx_);
     instance_paths_[instance_id] = fs::absolute(fs::path(path)).string();
     return true;
 }
 
-bool SS_LightResourceManager::DeleteInstanceById(const std::string& instance_id, std::string& out_error)
+bool SS_LightResourceManager::SaveInstanceDeferred(const std::string& instance_id, std::string& out_error)
 {
     out_error.clear();
 
-    SS_LightControllerRuntime* rt = FindRuntime(instance_id);
-    if (!rt)
+    if (!FindRuntime(instance_id))
     {
-        /*out_error = "DeleteInstanceById: instance not found: " + instance_id;*/
-        out_error = "删除实例操作：未找到该实例：" + instance_id;
+        /*out_error = "SaveInstanceDeferred: instance not found: " + instance_id;*/
+        out_error = "延迟保存实例：未找到实例：" + instance_id;
         return false;
     }
 
-    std::string path;
-    if (!ResolveInstancePath(instance_id, path, out_error))
-        return false;
-
-    try
+    bool sync = false;
+    bool wake = false;
     {
-        fs::path p(path);
-        if (fs::exists(p))
+        std::lock_guard<std::mutex> lk(persist_mtx_);
+        ++persist_stats_.save_requests;
+
+        sync = !persist_opts_.write_behind;
+        if (!sync)
         {
-            if (!fs::is_regular_file(p))
+            const auto now = std::chrono::steady_clock::now();
+            PersistEntry& e = persist_[instance_id];
+            if (!e.dirty)
             {
-                /*out_error = "DeleteInstanceById: not a regular file: " + path;*/
-                out_error = "删除实例（按 ID 删除）：并非常规文件：" + path;
-                return false;
+                e.dirty = true;
+                e.first_dirty = now;
+                wake = true; // 只有新变脏才可能提前截止时间；之后的修改只会把截止时间往后推
             }
-            fs::remove(p);
+            e.last_dirty = now;
+
+            EnsurePersistThread_();
         }
     }
-    catch (const std::exception& e)
-    {
-        out_error = std::string("删除实例（按 ID 删除）：文件系统错误：") + e.what();
-        return false;
-    }
 
-    runtimes_.erase(instance_id);
-    instance_paths_.erase(instance_id);
+    // 未开启 write-behind：退化为同步保存
+    if (sync)
+        return SaveInstanceById(instance_id, out_error);
+
+    if (wake)
+        persist_cv_.notify_one();
     return true;
 }
 
-bool SS_LightResourceManager::SetParameterValue(const SS_LightParamSetRequest& req, SS_LightParamSetResult& out_result)
+bool SS_LightResourceManager::FlushPendingSaves(std::string& out_error)
 {
-    SS_LightControllerRuntime* rt = FindRuntime(req.instance_id);
-    if (!rt)
+    out_error.clear();
+
+    std::vector<std::string> ids;
     {
-        out_result = SS_LightParamSetResult{};
-        out_result.ok = false;
-        out_result.message = "未找到实例：" + req.instance_id;
+        std::lock_guard<std::mutex> lk(persist_mtx_);
+        for (const auto& kv : persist_)
+        {
+            if (kv.second.dirty)
+                ids.push_back(kv.first);
+        }
+    }
+
+    bool ok = true;
+    for (const auto& id : ids)
+    {
+        std::string err;
+        if (!WriteInstanceFile_(id, err) && FindRuntime(id))
+        {
+            if (ok) out_error = err;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void SS_LightResourceManager::SetPersistOptions(const SS_LightPersistOptions& opts)
+{
+    {
+        std::lock_guard<std::mutex> lk(persist_mtx_);
+        persist_opts_ = opts;
+        if (persist_opts_.debounce_ms < 0) persist_opts_.debounce_ms = 0;
+        if (persist_opts_.max_delay_ms < persist_opts_.debounce_ms) persist_opts_.max_delay_ms = persist_opts_.debounce_ms;
+        if (persist_opts_.group_commit_ms < 0) persist_opts_.group_commit_ms = 0;
+        if (persist_opts_.compact_interval_ms < 0) persist_opts_.compact_interval_ms = 0;
+    }
+    persist_cv_.notify_all();
+    journal_.SetGroupCommitMs(opts.group_commit_ms);
+
+    // 关闭 write-behind 时把已挂起的写完
+    if (!opts.write_behind)
+    {
+        std::string err;
+        (void)FlushPendingSaves(err);
+    }
+
+    // 修改日志开关：关闭前先折叠；打开只在 Init 之后生效（Init 时按当前选项打开）
+    if (!opts.journal && journal_.IsOpen())
+    {
+        std::string err;
+        (void)CompactJournal(err);
+        journal_.Close();
+    }
+    else if (opts.journal && !journal_.IsOpen() && inited_.load())
+    {
+        std::string err;
+        (void)OpenJournal_(err);
+    }
+}
+
+void SS_LightResourceManager::GetPersistOptions(SS_LightPersistOptions& out_opts) const
+{
+    std::lock_guard<std::mutex> lk(persist_mtx_);
+    out_opts = persist_opts_;
+}
+
+void SS_LightResourceManager::GetPersistStats(SS_LightPersistStats& out_stats)
+{
+    {
+        std::lock_guard<std::mutex> lk(persist_mtx_);
+        out_stats = persist_stats_;
+        out_stats.pending = 0;
+        for (const auto& kv : persist_)
+        {
+            if (kv.second.dirty)
+                ++out_stats.pending;
+        }
+    }
+    journal_.GetStats(out_stats.journal_records, out_stats.journal_commits, out_stats.journal_bytes);
+}
+
+std::string SS_LightResourceManager::JournalDir_() const
+{
+    return (fs::path(instance_dir_) / "journal").string();
+}
+
+bool SS_LightResourceManager::OpenJournal_(std::string& out_error)
+{
+    int group_commit_ms = 0;
+    {
+        std::lock_guard<std::mutex> lk(persist_mtx_);
+        group_commit_ms = persist_opts_.group_commit_ms;
+    }
+    // 写失败由 writer 线程报告；记录留在内存里重试，UI 收到后应改为同步保存
+    journal_.SetErrorHandler([this](const std::string& msg) {
+        if (!event_bus_)
+            return;
+        SS_LightEventError ev;
+        ev.code = kJournalErrorCode;
+        ev.message = msg;
+        event_bus_->Publish(ev);
+    });
+    if (!journal_.Open(JournalDir_(), group_commit_ms, out_error))
+        return false;
+
+    // 折叠由 persist 线程定时执行
+    {
+        std::lock_guard<std::mutex> lk(persist_mtx_);
+        last_compact_ = std::chrono::steady_clock::now();
+        EnsurePersistThread_();
+    }
+    persist_cv_.notify_one();
+    return true;
+}
+
+bool SS_LightResourceManager::CompactJournal(std::string& out_error)
+{
+    out_error.clear();
+
+    std::lock_guard<std::mutex> clk(compact_mtx_);
+    if (!journal_.IsOpen())
+        return true;
+
+    // 1) 封存当前段：之后的修改进新段；封存段里的修改都已在内存实例里（追加发生在实例写锁内）
+    std::unordered_set<std::string> touched;
+    journal_.Rotate(touched);
+    compact_pending_.insert(touched.begin(), touched.end());
+
+    // 2) 写回 YAML；已删除/移除的实例、还没保存过文件的新实例不折叠
+    bool ok = true;
+    for (auto it = compact_pending_.begin(); it != compact_pending_.end();)
+    {
+        const std::string id = *it;
+        std::string path;
+        std::string err;
+        std::error_code ec;
+        if (!FindRuntime(id) || !ResolveInstancePath(id, path, err) || !fs::exists(path, ec))
+        {
+            it = compact_pending_.erase(it);
+            continue;
+        }
+
+        if (WriteInstanceFile_(id, err))
+        {
+            it = compact_pending_.erase(it);
+            continue;
+        }
+
+        if (ok)
+        {
+            /*out_error = "CompactJournal: " + err;*/
+            out_error = "折叠修改日志：" + err;
+        }
+        ok = false;
+        ++it;
+    }
+
+    // 3) 全部写回后删除封存段；有失败的留着，下次折叠重试（启动时也会重放）
+    if (compact_pending_.empty())
+        journal_.DropSealed();
+
+    std::lock_guard<std::mutex> lk(persist_mtx_);
+    ++persist_stats_.compactions;
+    last_compact_ = std::chrono::steady_clock::now();
+    return ok;
+}
+
+void SS_LightResourceManager::PersistLoop_()
+{
+    using clock = std::chrono::steady_clock;
+
+    std::vector<std::string> due;
+
+    std::unique_lock<std::mutex> lk(persist_mtx_);
+    while (!persist_stop_)
+    {
+        const auto now = clock::now();
+        const auto debounce = std::chrono::milliseconds(persist_opts_.debounce_ms);
+        const auto max_delay = std::chrono::milliseconds(persist_opts_.max_delay_ms);
+
+        // 到期：静默满 debounce，或第一次变脏起已满 max_delay
+        clock::time_point next = clock::time_point::max();
+        for (const auto& kv : persist_)
+        {
+            const PersistEntry& e = kv.second;
+            if (!e.dirty) continue;
+
+            const auto deadline = std::min(e.last_dirty + debounce, e.first_dirty + max_delay);
+            if (deadline <= now)
+                due.push_back(kv.first);
+            else if (deadline < next)
+                next = deadline;
+        }
+
+        // 日志折叠：有新记录后满 compact_interval_ms，或新记录超过 compact_bytes
+        bool compact = false;
+        if (journal_.IsOpen())
+        {
+            const uint64_t bytes = journal_.BytesSinceRotate();
+            if (bytes == 0)
+                last_compact_ = now; // 没有新记录：间隔从下一条记录开始算
+
+            const auto compact_at = last_compact_ + std::chrono::milliseconds(persist_opts_.compact_interval_ms);
+            if (bytes > 0 && (compact_at <= now || bytes >= persist_opts_.compact_bytes))
+            {
+                compact = true;
+            }
+            else
+            {
+                auto at = now + std::chrono::milliseconds(kJournalPollMs);
+                if (bytes > 0 && compact_at < at) at = compact_at;
+                if (at < next) next = at;
+            }
+        }
+
+        if (due.empty() && !compact)
+        {
+            if (next == clock::time_point::max())
+                persist_cv_.wait(lk);
+            else
+                persist_cv_.wait_until(lk, next);
+            continue;
+        }
+
+        lk.unlock();
+        for (const auto& id : due)
+        {
+            std::string err;
+            if (WriteInstanceFile_(id, err) || !FindRuntime(id))
+                continue;
+
+            // 写失败：重新标脏，过一个 debounce 再试，并通知 UI
+            {
+                std::lock_guard<std::mutex> relk(persist_mtx_);
+                auto it = persist_.find(id);
+                if (it != persist_.end())
+                {
+                    const auto t = clock::now();
+                    it->second.dirty = true;
+                    it->second.first_dirty = t;
+                    it->second.last_dirty = t;
+                }
+            }
+            if (event_bus_)
+            {
+                SS_LightEventError ev;
+                ev.instance_id = id;
+                ev.code = kPersistErrorCode;
+                ev.message = err;
+                event_bus_->Publish(ev);
+            }
+        }
+        due.clear();
+
+        if (compact)
+        {
+            std::string err;
+            if (!CompactJournal(err) && event_bus_)
+            {
+                SS_LightEventError ev;
+                ev.code = kPersistErrorCode;
+                ev.message = err;
+                event_bus_->Publish(ev);
+            }
+        }
+        lk.lock();
+    }
+}
+
+void SS_LightResourceManager::EnsurePersistThread_()
+{
+    if (persist_thread_.joinable())
+        return;
+    persist_stop_ = false;
+    persist_thread_ = std::thread(&SS_LightResourceManager::PersistLoop_, this);
+}
+
+void SS_LightResourceManager::StopPersistThread_()
+{
+    std::thread t;
+    {
+        std::lock_guard<std::mutex> lk(persist_mtx_);
+        persist_stop_ = true;
+        t.swap(persist_thread_);
+    }
+    persist_cv_.notify_all();
+
+    if (t.joinable())
+        t.join();
+}
+
+bool SS_LightResourceManager::DeleteInstanceById(const std::string& instance_id, std::string& out_error)
+{
+    out_error.clear();
+
+    RuntimePtr rt = FindRuntime(instance_id);
+    if (!rt)
+    {
+        /*out_error = "DeleteInstanceById: instance not found: " + instance_id;*/
+        out_error = "删除实例操作：未找到该实例：" + instance_id;
+        return false;
+    }
+
+    std::string path;
+    if (!ResolveInstancePath(instance_id, path, out_error))
+        return false;
+
+    // 批量连接线程会拿实例 WriteScope（其中可能同步保存 -> save_mtx_），必须在拿 save_mtx_ 之前停掉
+    StopConnectBatchIfBusy_(instance_id);
+    SetStatsCollector_(instance_id, nullptr);
+
+    // 删文件到移除 runtime 之间不允许延迟保存把文件写回来；持锁期间不得 join 任何线程
+    std::lock_guard<std::mutex> save_lk(save_mtx_);
+
+    try
+    {
+        fs::path p(path);
+        if (fs::exists(p))
+        {
+            if (!fs::is_regular_file(p))
+            {
+                /*out_error = "DeleteInstanceById: not a regular file: " + path;*/
+                out_error = "删除实例（按 ID 删除）：并非常规文件：" + path;
+                return false;
+            }
+            fs::remove(p);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        out_error = std::string("删除实例（按 ID 删除）：文件系统错误：") + e.what();
+        return false;
+    }
+
+    // 配方随实例一起删除
+    try
+    {
+        fs::path rdir(RecipeDir_(instance_id));
+        if (fs::exists(rdir))
+            fs::remove_all(rdir);
+    }
+    catch (const std::exception& e)
+    {
+        out_error = std::string("删除实例（按 ID 删除）：删除配方目录失败：") + e.what();
+        return false;
+    }
+    rt.reset();
+
+    RuntimePtr removed;
+    {
+        std::lock_guard<std::mutex> lk(registry_mtx_);
+        recipes_.erase(instance_id);
+        auto it = runtimes_.find(instance_id);
+        if (it != runtimes_.end())
+        {
+            removed = std::move(it->second);
+            runtimes_.erase(it);
+        }
+        instance_paths_.erase(instance_id);
+    }
+    {
+        std::lock_guard<std::mutex> lk(persist_mtx_);
+        persist_.erase(instance_id);
+    }
+    // 重放时丢弃该实例此前的记录（之后若有同 id 的新实例，只重放标记之后的）
+    journal_.AppendInstanceDeleted(instance_id);
+    return true;
+}
+
+bool SS_LightResourceManager::SetParameterValue(const SS_LightParamSetRequest& req, SS_LightParamSetResult& out_result)
+{
+    RuntimePtr rt = FindRuntime(req.instance_id);
+    if (!rt)
+    {
+        out_result = SS_LightParamSetResult{};
+        out_result.ok = false;
+        out_result.message = "未找到实例：" + req.instance_id;
+        return false;
+    }
+
+    SS_LightControllerRuntime::WriteScope ws(*rt);
+    return rt->SetParamAndBuildCommand(req, out_result);
+}
+
+bool SS_LightResourceManager::SetParameterAndSend(const SS_LightParamSetRequest& req, SS_LightParamSetResult& out_result)
+{
+    RuntimePtr rt = FindRuntime(req.instance_id);
+    if (!rt)
+    {
+        out_result = SS_LightParamSetResult{};
+        out_result.ok = false;
+        out_result.message = "实例未找到： " + req.instance_id;
+        return false;
+    }
+
+    SS_LightControllerRuntime::WriteScope ws(*rt);
+    return rt->SetParamAndSend(req, out_result);
+}
+
+bool SS_LightResourceManager::ApplyBatch(
+    const std::string& instance_id,
+    const std::vector<SS_LightParamSetRequest>& reqs,
+    SS_LightBatchResult& out_result,
+    std::string& out_error)
+{
+    out_error.clear();
+    out_result = SS_LightBatchResult{};
+
+    RuntimePtr rt = FindRuntime(instance_id);
+    if (!rt)
+    {
+        /*out_error = "ApplyBatch: instance not found: " + instance_id;*/
+        out_error = "批量写入参数：实例未找到：" + instance_id;
+        return false;
+    }
+
+    for (size_t i = 0; i < reqs.size(); ++i)
+    {
+        if (!reqs[i].instance_id.empty() && reqs[i].instance_id != instance_id)
+        {
+            /*out_error = "ApplyBatch: request belongs to another instance: " + reqs[i].instance_id;*/
+            out_error = "批量写入参数：第 " + std::to_string(i + 1) + " 项属于其它实例：" + reqs[i].instance_id;
+            out_result.failed_index = static_cast<int>(i);
+            out_result.message = out_error;
+            return false;
+        }
+    }
+
+    if (reqs.empty())
+    {
+        out_result.ok = true;
+        return true;
+    }
+
+    // 写入与落盘在同一作用域：其它线程看不到“已写入未保存”之外的中间状态
+    SS_LightControllerRuntime::WriteScope ws(*rt);
+    rt->ApplyParamBatch(reqs, out_result);
+
+    // 值一旦写入就整批落盘一次（发送失败也要保存，与单条 SetParameterAndSend 后 UI 保存一致）
+    if (out_result.applied)
+    {
+        std::string save_err;
+        if (!SaveInstanceById(instance_id, save_err))
+        {
+            /*out_error = "ApplyBatch: save failed: " + save_err;*/
+            out_error = "批量写入参数：保存失败：" + save_err;
+            return false;
+        }
+    }
+
+    if (!out_result.ok)
+    {
+        out_error = out_result.message;
+        return false;
+    }
+    return true;
+}
+
+// ============================
+// recipes
+// ============================
+
+std::string SS_LightResourceManager::RecipeDir_(const std::string& instance_id) const
+{
+    return (fs::path(instance_dir_) / "recipes" / instance_id).string();
+}
+
+std::string SS_LightResourceManager::RecipePath_(const std::string& instance_id, const std::string& recipe_id) const
+{
+    return (fs::path(RecipeDir_(instance_id)) / (recipe_id + "_recipe.yaml")).string();
+}
+
+bool SS_LightResourceManager::ReloadRecipes(std::string& out_error)
+{
+    out_error.clear();
+
+    std::unordered_map<std::string, std::map<std::string, StoredRecipe>> new_recipes;
+
+    try
+    {
+        fs::path root = fs::path(instance_dir_) / "recipes";
+        if (!fs::exists(root))
+        {
+            std::lock_guard<std::mutex> lk(registry_mtx_);
+            recipes_.clear();
+            return true;
+        }
+
+        SS_LightYamlCodec codec;
+        for (const auto& dir : fs::directory_iterator(root))
+        {
+            if (!dir.is_directory()) continue;
+
+            for (const auto& entry : fs::directory_iterator(dir.path()))
+            {
+                if (!entry.is_regular_file()) continue;
+                if (!EndsWith(entry.path().filename().string(), "_recipe.yaml")) continue;
+
+                const std::string path_str = entry.path().string();
+                SS_LightRecipe recipe;
+                if (!codec.LoadRecipe(path_str, recipe))
+                {
+                    /*out_error = "ReloadRecipes: LoadRecipe failed: " + path_str +
+                        " | codec error: " + codec.GetLastError();*/
+                    out_error = "重新加载配方：加载配方失败：" + path_str +
+                        " | 编码器错误：" + codec.GetLastError();
+                    return false;
+                }
+
+                StoredRecipe& slot = new_recipes[recipe.instance_id][recipe.recipe_id];
+                slot.recipe = std::move(recipe);
+                slot.revision = ++next_recipe_revision_;
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        out_error = std::string("重新加载配方：文件系统错误：") + e.what();
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lk(registry_mtx_);
+    recipes_ = std::move(new_recipes);
+    return true;
+}
+
+bool SS_LightResourceManager::SaveRecipe(const SS_LightRecipe& recipe, std::string& out_error)
+{
+    out_error.clear();
+
+    if (!IsSafeFileStem(recipe.recipe_id))
+    {
+        /*out_error = "SaveRecipe: invalid recipe_id: " + recipe.recipe_id;*/
+        out_error = "保存配方：配方 ID 无效（为空或含有文件名非法字符）：" + recipe.recipe_id;
+        return false;
+    }
+
+    RuntimePtr rt = FindRuntime(recipe.instance_id);
+    if (!rt)
+    {
+        /*out_error = "SaveRecipe: instance not found: " + recipe.instance_id;*/
+        out_error = "保存配方：未找到实例：" + recipe.instance_id;
+        return false;
+    }
+    SS_LightControllerRuntime::WriteScope ws(*rt, false); // 预编译缓存是写者状态，实例值不变
+
+    // 先校验并预编译，失败不落盘
+    const uint64_t revision = ++next_recipe_revision_;
+    if (!rt->CompileRecipe(recipe, revision, out_error))
+        return false;
+
+    try
+    {
+        fs::path dir(RecipeDir_(recipe.instance_id));
+        if (!fs::exists(dir))
+            fs::create_directories(dir);
+    }
+    catch (const std::exception& e)
+    {
+        out_error = std::string("保存配方：文件系统错误：") + e.what();
+        return false;
+    }
+
+    const std::string path = RecipePath_(recipe.instance_id, recipe.recipe_id);
+    SS_LightYamlCodec codec;
+    if (!codec.SaveRecipe(path, recipe))
+    {
+        /*out_error = "SaveRecipe: SaveRecipe failed: " + path + " | codec error: " + codec.GetLastError();*/
+        out_error = "保存配方：写入失败：" + path + " | 编码器错误：" + codec.GetLastError();
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lk(registry_mtx_);
+    StoredRecipe& slot = recipes_[recipe.instance_id][recipe.recipe_id];
+    slot.recipe = recipe;
+    slot.revision = revision;
+    return true;
+}
+
+bool SS_LightResourceManager::CaptureRecipe(
+    const std::string& instance_id,
+    const std::string& recipe_id,
+    const std::string& display_name,
+    std::string& out_error)
+{
+    out_error.clear();
+
+    RuntimePtr rt = FindRuntime(instance_id);
+    if (!rt)
+    {
+        /*out_error = "CaptureRecipe: instance not found: " + instance_id;*/
+        out_error = "生成配方：未找到实例：" + instance_id;
+        return false;
+    }
+    SS_LightControllerRuntime::WriteScope ws(*rt, false);
+
+    const SS_LightControllerInstance& inst = rt->GetInstance();
+
+    SS_LightRecipe recipe;
+    recipe.recipe_id = recipe_id;
+    recipe.instance_id = instance_id;
+    recipe.display_name = display_name.empty() ? recipe_id : display_name;
+    inst.param_values.ForEachGlobal([&](const std::string& key, const std::string& value) {
+        recipe.global_param_values[key] = value;
+    });
+
+    // 只收录实例里仍存在的通道，已删除通道的残留值不进配方
+    inst.param_values.ForEachChannel([&](const std::string& key, const std::string& channel_id, const std::string& value) {
+        const int h = rt->FindChannelHandle(channel_id);
+        if (h >= 0 && !inst.channels[h].deleted)
+            recipe.channel_param_values[key][channel_id] = value;
+    });
+
+    return SaveRecipe(recipe, out_error);
+}
+
+bool SS_LightResourceManager::DeleteRecipe(const std::string& instance_id, const std::string& recipe_id, std::string& out_error)
+{
+    out_error.clear();
+
+    {
+        std::lock_guard<std::mutex> lk(registry_mtx_);
+        auto it = recipes_.find(instance_id);
+        if (it == recipes_.end() || it->second.find(recipe_id) == it->second.end())
+        {
+            /*out_error = "DeleteRecipe: recipe not found: " + instance_id + "/" + recipe_id;*/
+            out_error = "删除配方：未找到配方：" + instance_id + "/" + recipe_id;
+            return false;
+        }
+    }
+
+    try
+    {
+        fs::path p(RecipePath_(instance_id, recipe_id));
+        if (fs::exists(p))
+            fs::remove(p);
+    }
+    catch (const std::exception& e)
+    {
+        out_error = std::string("删除配方：文件系统错误：") + e.what();
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(registry_mtx_);
+        auto it = recipes_.find(instance_id);
+        if (it != recipes_.end())
+        {
+            it->second.erase(recipe_id);
+            if (it->second.empty())
+                recipes_.erase(it);
+        }
+    }
+
+    if (RuntimePtr rt = FindRuntime(instance_id))
+    {
+        SS_LightControllerRuntime::WriteScope ws(*rt, false);
+        rt->DropRecipe(recipe_id);
+    }
+    return true;
+}
+
+std::vector<std::string> SS_LightResourceManager::ListRecipeIds(const std::string& instance_id) const
+{
+    std::vector<std::string> ids;
+    std::lock_guard<std::mutex> lk(registry_mtx_);
+    auto it = recipes_.find(instance_id);
+    if (it == recipes_.end())
+        return ids;
+
+    ids.reserve(it->second.size());
+    for (const auto& kv : it->second)
+        ids.push_back(kv.first);
+    return ids;
+}
+
+bool SS_LightResourceManager::GetRecipe(const std::string& instance_id, const std::string& recipe_id, SS_LightRecipe& out_recipe) const
+{
+    std::lock_guard<std::mutex> lk(registry_mtx_);
+    auto it = recipes_.find(instance_id);
+    if (it == recipes_.end()) return false;
+    auto rit = it->second.find(recipe_id);
+    if (rit == it->second.end()) return false;
+
+    out_recipe = rit->second.recipe;
+    return true;
+}
+
+bool SS_LightResourceManager::ApplyRecipe(
+    const std::string& instance_id,
+    const std::string& recipe_id,
+    bool full,
+    SS_LightRecipeApplyResult& out_result,
+    std::string& out_error)
+{
+    out_error.clear();
+    out_result = SS_LightRecipeApplyResult{};
+
+    RuntimePtr rt = FindRuntime(instance_id);
+    if (!rt)
+    {
+        /*out_error = "ApplyRecipe: instance not found: " + instance_id;*/
+        out_error = "应用配方：未找到实例：" + instance_id;
         return false;
     }
 
-    return rt->SetParamAndBuildCommand(req, out_result);
+    // 拷一份出来，应用期间不占着 registry_mtx_
+    StoredRecipe stored;
+    {
+        std::lock_guard<std::mutex> lk(registry_mtx_);
+        auto it = recipes_.find(instance_id);
+        if (it == recipes_.end() || it->second.find(recipe_id) == it->second.end())
+        {
+            /*out_error = "ApplyRecipe: recipe not found: " + instance_id + "/" + recipe_id;*/
+            out_error = "应用配方：未找到配方：" + instance_id + "/" + recipe_id;
+            return false;
+        }
+        stored = it->second.at(recipe_id);
+    }
+
+    SS_LightControllerRuntime::WriteScope ws(*rt);
+    rt->ApplyRecipe(stored.recipe, stored.revision, full, out_result);
+
+    if (out_result.batch.applied)
+    {
+        std::string save_err;
+        if (!SaveInstanceById(instance_id, save_err))
+        {
+            /*out_error = "ApplyRecipe: save failed: " + save_err;*/
+            out_error = "应用配方：保存实例失败：" + save_err;
+            return false;
+        }
+    }
+
+    if (!out_result.batch.ok)
+    {
+        out_error = out_result.batch.message;
+        return false;
+    }
+    return true;
 }
 
-bool SS_LightResourceManager::SetParameterAndSend(const SS_LightParamSetRequest& req, SS_LightParamSetResult& out_result)
+bool SS_LightResourceManager::SubmitParameterCoalesced(
+    const SS_LightParamSetRequest& req,
+    std::vector<SS_LightCoalescedResult>& out_sent,
+    std::string& out_error)
 {
-    SS_LightControllerRuntime* rt = FindRuntime(req.instance_id);
+    out_error.clear();
+    out_sent.clear();
+
+    RuntimePtr rt = FindRuntime(req.instance_id);
     if (!rt)
     {
-        out_result = SS_LightParamSetResult{};
-        out_result.ok = false;
-        out_result.message = "实例未找到： " + req.instance_id;
+        /*out_error = "SubmitParameterCoalesced: instance not found: " + req.instance_id;*/
+        out_error = "合并发送参数：实例未找到：" + req.instance_id;
         return false;
     }
 
-    return rt->SetParamAndSend(req, out_result);
+    SS_LightControllerRuntime::WriteScope ws(*rt);
+    rt->SubmitParamCoalesced(req, out_sent);
+    return true;
+}
+
+void SS_LightResourceManager::FlushParameterUpdates(
+    const std::string& instance_id,
+    bool force,
+    std::vector<SS_LightCoalescedResult>& out_sent)
+{
+    out_sent.clear();
+
+    std::vector<SS_LightCoalescedResult> sent;
+    for (const auto& kv : ListRuntimes_())
+    {
+        if (!instance_id.empty() && kv.first != instance_id) continue;
+
+        SS_LightControllerRuntime::WriteScope ws(*kv.second, false);
+        if (!kv.second->HasPendingCoalesced()) continue;
+
+        ws.MarkChanged();
+        kv.second->PollCoalesced(force, sent);
+        for (auto& r : sent)
+            out_sent.push_back(std::move(r));
+    }
+}
+
+bool SS_LightResourceManager::HasPendingParameterUpdates(const std::string& instance_id) const
+{
+    if (!instance_id.empty())
+    {
+        RuntimePtr rt = FindRuntime(instance_id);
+        if (!rt) return false;
+        SS_LightControllerRuntime::WriteScope ws(*rt, false);
+        return rt->HasPendingCoalesced();
+    }
+
+    for (const auto& kv : ListRuntimes_())
+    {
+        SS_LightControllerRuntime::WriteScope ws(*kv.second, false);
+        if (kv.second->HasPendingCoalesced()) return true;
+    }
+    return false;
+}
+
+void SS_LightResourceManager::SetCoalesceOptions(const SS_LightCoalesceOptions& opts)
+{
+    {
+        std::lock_guard<std::mutex> lk(registry_mtx_);
+        coalesce_opts_ = opts;
+    }
+    for (const auto& kv : ListRuntimes_())
+    {
+        SS_LightControllerRuntime::WriteScope ws(*kv.second, false);
+        kv.second->SetCoalesceOptions(opts);
+    }
 }
 
 bool SS_LightResourceManager::CreateInstanceFromTemplate(
@@ -935,6 +2211,9 @@ bool SS_LightResourceManager::CreateInstanceFromTemplate(
     out_error.clear();
     out_instance_id.clear();
 
+    // 两个线程同时创建时不能挑到同一个 controller_<n>
+    std::lock_guard<std::mutex> create_lk(create_mtx_);
+
     if (template_id.empty())
     {
         /*out_error = "CreateInstanceFromTemplate: template_id is empty.";*/
@@ -942,7 +2221,7 @@ bool SS_LightResourceManager::CreateInstanceFromTemplate(
         return false;
     }
 
-    const SS_LightControllerTemplate* tpl = FindTemplate(template_id);
+    std::shared_ptr<const SS_LightControllerTemplate> tpl = FindTemplate(template_id);
     if (!tpl)
     {
         /*out_error = "CreateInstanceFromTemplate: template not found: " + template_id;*/
@@ -1035,8 +2314,8 @@ bool SS_LightResourceManager::CreateInstanceFromTemplate(
         inst.channels.clear(); // keep empty
     }
 
-    inst.global_param_values.clear();
-    inst.channel_param_values.clear();
+    inst.param_values.Clear();
+    inst.param_values.BindIndex(tpl->param_index);
 
     for (const auto& kv : tpl->params)
     {
@@ -1046,22 +2325,22 @@ bool SS_LightResourceManager::CreateInstanceFromTemplate(
 
         if (def.location == SS_LIGHT_PARAM_LOCATION::GLOBAL)
         {
-            inst.global_param_values[key] = dv;
+            inst.param_values.SetGlobal(key, dv);
         }
         else if (def.location == SS_LIGHT_PARAM_LOCATION::CHANNEL)
         {
-            auto& per_channel = inst.channel_param_values[key];
             for (const auto& ch : inst.channels)
-                per_channel[ch.channel_id] = dv;
+                inst.param_values.SetChannel(key, ch.channel_id, dv);
         }
     }
 
-    if (!codec_.SaveInstance(yaml_path.string(), inst))
+    SS_LightYamlCodec codec;
+    if (!codec.SaveInstance(yaml_path.string(), inst))
     {
         /*out_error = "CreateInstanceFromTemplate: SaveInstance failed: " + yaml_path.string() +
-            " | codec error: " + codec_.GetLastError();*/
+            " | codec error: " + codec.GetLastError();*/
         out_error = "从模板创建实例：保存实例操作失败：" + yaml_path.string() +
-            " | 编码器错误：" + codec_.GetLastError();
+            " | 编码器错误：" + codec.GetLastError();
         return false;
     }
 
@@ -1075,7 +2354,10 @@ bool SS_LightResourceManager::CreateInstanceFromTemplate(
     }
 
     // 关键：记录路径映射（这样 SaveInstanceById 就不再依赖 instance_id 的格式）
-    instance_paths_[inst.info.instance_id] = fs::absolute(yaml_path).string();
+    {
+        std::lock_guard<std::mutex> lk(registry_mtx_);
+        instance_paths_[inst.info.instance_id] = fs::absolute(yaml_path).string();
+    }
 
     out_instance_id = instance_id;
     return true;
@@ -1085,14 +2367,21 @@ bool SS_LightResourceManager::ConnectInstance(const std::string& instance_id, st
 {
     out_error.clear();
 
-    SS_LightControllerRuntime* rt = FindRuntime(instance_id);
+    RuntimePtr rt = FindRuntime(instance_id);
     if (!rt)
     {
         /*out_error = "ConnectInstance: instance not found: " + instance_id;*/
         out_error = "连接实例：实例未找到：" + instance_id;
         return false;
     }
+    if (IsInConnectBatch_(instance_id))
+    {
+        /*out_error = "ConnectInstance: instance is in a running connect batch: " + instance_id;*/
+        out_error = "连接实例：该实例正在批量连接中：" + instance_id;
+        return false;
+    }
 
+    SS_LightControllerRuntime::WriteScope ws(*rt);
     return rt->Connect(out_error);
 }
 
@@ -1100,23 +2389,277 @@ bool SS_LightResourceManager::DisconnectInstance(const std::string& instance_id,
 {
     out_error.clear();
 
-    SS_LightControllerRuntime* rt = FindRuntime(instance_id);
+    RuntimePtr rt = FindRuntime(instance_id);
     if (!rt)
     {
         /*out_error = "DisconnectInstance: instance not found: " + instance_id;*/
         out_error = "断开实例连接：未找到该实例：" + instance_id;
         return false;
     }
+    if (IsInConnectBatch_(instance_id))
+    {
+        /*out_error = "DisconnectInstance: instance is in a running connect batch: " + instance_id;*/
+        out_error = "断开实例连接：该实例正在批量连接中：" + instance_id;
+        return false;
+    }
 
+    SS_LightControllerRuntime::WriteScope ws(*rt);
     rt->Disconnect();
     return true;
 }
 
 bool SS_LightResourceManager::IsInstanceConnected(const std::string& instance_id) const
 {
-    const SS_LightControllerRuntime* rt = FindRuntime(instance_id);
+    RuntimePtr rt = FindRuntime(instance_id);
     if (!rt) return false;
-    return rt->IsConnected();
+    return rt->PeekConnected();
+}
+
+bool SS_LightResourceManager::ConnectAll(const SS_LightConnectBatchOptions& opts, uint64_t& out_batch_id, std::string& out_error)
+{
+    std::vector<std::pair<int, std::string>> ordered;
+    for (const auto& kv : ListRuntimes_())
+    {
+        std::shared_ptr<const SS_LightControllerInstance> inst = kv.second->LoadSnapshot();
+        if (inst->info.deleted) continue;
+        if (opts.skip_disabled && !inst->info.enabled) continue;
+        if (kv.second->PeekConnected()) continue;
+        ordered.emplace_back(inst->info.order, kv.first);
+    }
+
+    // 按 order 发起，和列表显示顺序一致
+    std::sort(ordered.begin(), ordered.end());
+
+    std::vector<std::string> ids;
+    ids.reserve(ordered.size());
+    for (auto& o : ordered)
+        ids.push_back(std::move(o.second));
+
+    return ConnectInstances(ids, opts, out_batch_id, out_error);
+}
+
+bool SS_LightResourceManager::ConnectInstances(
+    const std::vector<std::string>& instance_ids,
+    const SS_LightConnectBatchOptions& opts,
+    uint64_t& out_batch_id,
+    std::string& out_error)
+{
+    out_error.clear();
+    out_batch_id = 0;
+
+    auto batch = std::make_shared<ConnectBatch>();
+    batch->opts = opts;
+
+    std::unordered_set<std::string> seen;
+    for (const auto& id : instance_ids)
+    {
+        if (!seen.insert(id).second) continue;
+
+        RuntimePtr rt = FindRuntime(id);
+        if (!rt)
+        {
+            /*out_error = "ConnectInstances: instance not found: " + id;*/
+            out_error = "批量连接：实例未找到：" + id;
+            return false;
+        }
+        batch->jobs.emplace_back(id, rt);
+    }
+
+    // 上一批已经跑完的话先回收线程；join 期间放锁，重新拿锁后必须再检查一次
+    // （并发的 ConnectInstances 可能已经装上了新批次）
+    std::unique_lock<std::mutex> lk(batch_mtx_);
+    for (;;)
+    {
+        if (batch_ && batch_->workers_left.load() > 0)
+        {
+            /*out_error = "ConnectInstances: another connect batch is running.";*/
+            out_error = "批量连接：已有批量连接正在进行。";
+            return false;
+        }
+        if (batch_workers_.empty())
+            break;
+
+        std::vector<std::thread> finished_workers;
+        finished_workers.swap(batch_workers_);
+        lk.unlock();
+        for (auto& t : finished_workers)
+            if (t.joinable()) t.join();
+        lk.lock();
+    }
+
+    batch->id = ++next_batch_id_;
+    out_batch_id = batch->id;
+
+    const int total = static_cast<int>(batch->jobs.size());
+    if (total == 0)
+    {
+        batch_.reset();
+        lk.unlock();
+
+        // 没有需要连接的实例：直接结束
+        if (event_bus_)
+        {
+            SS_LightEventConnectBatch ev;
+            ev.type = SS_LightEventType::CONNECT_BATCH_FINISHED;
+            ev.batch_id = out_batch_id;
+            event_bus_->Publish(ev);
+        }
+        return true;
+    }
+
+    const int workers = std::max(1, std::min(opts.max_concurrency, total));
+    batch->workers_left.store(workers);
+
+    batch_pending_.clear();
+    for (const auto& job : batch->jobs)
+        batch_pending_.insert(job.first);
+
+    batch_ = std::move(batch);
+    for (int i = 0; i < workers; ++i)
+        batch_workers_.emplace_back(&SS_LightResourceManager::ConnectBatchWorker_, this, batch_);
+
+    return true;
+}
+
+void SS_LightResourceManager::CancelConnectBatch()
+{
+    std::vector<std::thread> workers;
+    std::shared_ptr<ConnectBatch> cancelled;
+    {
+        std::lock_guard<std::mutex> lk(batch_mtx_);
+        cancelled = batch_;
+        if (cancelled) cancelled->cancel.store(true);
+        workers.swap(batch_workers_);
+    }
+
+    // 进行中的尝试最多再等一个 attempt_timeout_ms
+    for (auto& t : workers)
+        if (t.joinable()) t.join();
+
+    // join 期间可能已有新批次装上：只清理自己取消的那一批
+    std::lock_guard<std::mutex> lk(batch_mtx_);
+    if (batch_ == cancelled)
+    {
+        batch_.reset();
+        batch_pending_.clear();
+    }
+}
+
+bool SS_LightResourceManager::IsConnectBatchRunning() const
+{
+    std::lock_guard<std::mutex> lk(batch_mtx_);
+    return batch_ && batch_->workers_left.load() > 0;
+}
+
+void SS_LightResourceManager::ConnectBatchWorker_(std::shared_ptr<ConnectBatch> batch)
+{
+    const int attempts = std::max(1, batch->opts.max_attempts);
+
+    for (;;)
+    {
+        if (batch->cancel.load()) break;
+
+        const size_t i = batch->next.fetch_add(1);
+        if (i >= batch->jobs.size()) break;
+
+        const auto& job = batch->jobs[i];
+
+        bool ok = false;
+        std::string err;
+        for (int a = 0; a < attempts && !batch->cancel.load(); ++a)
+        {
+            if (a > 0)
+                job.second->GetStatsCollector()->OnRetry();
+
+            // 每次尝试单独持锁，尝试间隙其它线程可操作该实例
+            SS_LightControllerRuntime::WriteScope ws(*job.second);
+            ok = job.second->Connect(err, batch->opts.attempt_timeout_ms);
+            if (ok) break;
+        }
+
+        FinishConnectJob_(batch.get(), job.first, ok, err);
+    }
+
+    // 最后一个退出的线程发结束事件
+    if (batch->workers_left.fetch_sub(1) == 1 && event_bus_)
+    {
+        SS_LightEventConnectBatch ev;
+        ev.type = SS_LightEventType::CONNECT_BATCH_FINISHED;
+        ev.batch_id = batch->id;
+        ev.total = static_cast<int>(batch->jobs.size());
+        ev.done = batch->done.load();
+        ev.succeeded = batch->succeeded.load();
+        ev.failed = batch->failed.load();
+        ev.cancelled = batch->cancel.load();
+        event_bus_->Publish(ev);
+    }
+}
+
+void SS_LightResourceManager::FinishConnectJob_(ConnectBatch* batch, const std::string& instance_id, bool ok, const std::string& msg)
+{
+    {
+        std::lock_guard<std::mutex> lk(batch_mtx_);
+        if (batch_.get() == batch)
+            batch_pending_.erase(instance_id);
+    }
+
+    const int done = batch->done.fetch_add(1) + 1;
+    const int succeeded = ok ? batch->succeeded.fetch_add(1) + 1 : batch->succeeded.load();
+    const int failed = ok ? batch->failed.load() : batch->failed.fetch_add(1) + 1;
+
+    if (!event_bus_) return;
+
+    SS_LightEventConnectBatch ev;
+    ev.type = SS_LightEventType::CONNECT_BATCH_PROGRESS;
+    ev.instance_id = instance_id;
+    ev.batch_id = batch->id;
+    ev.total = static_cast<int>(batch->jobs.size());
+    ev.done = done;
+    ev.succeeded = succeeded;
+    ev.failed = failed;
+    ev.ok = ok;
+    ev.message = msg;
+    event_bus_->Publish(ev);
+}
+
+void SS_LightResourceManager::StopConnectBatchIfBusy_(const std::string& instance_id)
+{
+    if (IsInConnectBatch_(instance_id))
+        CancelConnectBatch();
+}
+
+bool SS_LightResourceManager::IsInConnectBatch_(const std::string& instance_id) const
+{
+    std::lock_guard<std::mutex> lk(batch_mtx_);
+    return batch_pending_.count(instance_id) > 0;
+}
+
+bool SS_LightResourceManager::DiscoverDevices(
+    const SS_LightDiscoveryOptions& opts,
+    std::vector<SS_LightDiscoveryCandidate>& out_candidates,
+    std::string& out_error)
+{
+    out_error.clear();
+    out_candidates.clear();
+
+    // 持有模板句柄，探测期间不再访问 templates_（重新加载模板也不影响本次探测）
+    std::vector<std::shared_ptr<const SS_LightControllerTemplate>> tpls;
+    {
+        std::lock_guard<std::mutex> lk(registry_mtx_);
+        tpls.reserve(templates_.size());
+        for (const auto& kv : templates_)
+            tpls.push_back(kv.second);
+    }
+
+    SS_LightDiscovery discovery;
+    std::string err;
+    if (!discovery.Run(tpls, opts, out_candidates, err))
+    {
+        /*out_error = "DiscoverDevices: " + err;*/
+        out_error = "自动发现：" + err;
+        return false;
+    }
+    return true;
 }
 
 bool SS_LightResourceManager::UpdateConnectionConfig(
@@ -1126,13 +2669,21 @@ bool SS_LightResourceManager::UpdateConnectionConfig(
 {
     out_error.clear();
 
-    SS_LightControllerRuntime* rt = FindRuntime(instance_id);
+    RuntimePtr rt = FindRuntime(instance_id);
     if (!rt)
     {
         /*out_error = "UpdateConnectionConfig: instance not found: " + instance_id;*/
         out_error = "更新连接配置：实例未找到：" + instance_id;
         return false;
     }
+    if (IsInConnectBatch_(instance_id))
+    {
+        /*out_error = "UpdateConnectionConfig: instance is in a running connect batch: " + instance_id;*/
+        out_error = "更新连接配置：该实例正在批量连接中：" + instance_id;
+        return false;
+    }
+
+    SS_LightControllerRuntime::WriteScope ws(*rt);
 
     // 关键：如果已连接，先断开，让配置切换具备确定性
     if (rt->IsConnected())
@@ -1142,35 +2693,177 @@ bool SS_LightResourceManager::UpdateConnectionConfig(
 
     rt->GetInstanceMutable().connection = conn;
     rt->GetInstanceMutable().connection.connect_state = false; // 存档状态也清掉
+
+    SS_LightEventConnectionConfig ev;
+    ev.instance_id = instance_id;
+    ev.connection = rt->GetInstance().connection;
+    rt->QueueModelEvent(std::move(ev));
+    return true;
+}
+
+bool SS_LightResourceManager::StartTrafficRecording(const std::string& capture_path, std::string& out_error)
+{
+    out_error.clear();
+
+    std::string err;
+    if (!recorder_->Open(capture_path, err))
+    {
+        /*out_error = "StartTrafficRecording: " + err;*/
+        out_error = "开始抓包：" + err;
+        return false;
+    }
+    return true;
+}
+
+void SS_LightResourceManager::StopTrafficRecording()
+{
+    recorder_->Close();
+}
+
+bool SS_LightResourceManager::SetInstanceReplaySource(
+    const std::string& instance_id,
+    const std::string& capture_path,
+    double speed,
+    std::string& out_error)
+{
+    out_error.clear();
+
+    RuntimePtr rt = FindRuntime(instance_id);
+    if (!rt)
+    {
+        /*out_error = "SetInstanceReplaySource: instance not found: " + instance_id;*/
+        out_error = "设置回放源：未找到该实例：" + instance_id;
+        return false;
+    }
+    if (IsInConnectBatch_(instance_id))
+    {
+        /*out_error = "SetInstanceReplaySource: instance is in a running connect batch: " + instance_id;*/
+        out_error = "设置回放源：该实例正在批量连接中：" + instance_id;
+        return false;
+    }
+
+    SS_LightControllerRuntime::WriteScope ws(*rt, false);
+    rt->SetReplaySource(capture_path, speed);
+    return true;
+}
+
+bool SS_LightResourceManager::GetConnectionStats(
+    const std::string& instance_id,
+    SS_LightConnectionStats& out_stats,
+    std::string& out_error) const
+{
+    out_error.clear();
+
+    RuntimePtr rt = FindRuntime(instance_id);
+    if (!rt)
+    {
+        /*out_error = "GetConnectionStats: instance not found: " + instance_id;*/
+        out_error = "获取连接统计：未找到该实例：" + instance_id;
+        return false;
+    }
+
+    rt->GetConnectionStats(out_stats);
     return true;
 }
 
-const SS_LightControllerTemplate* SS_LightResourceManager::FindTemplate(const std::string& template_id) const
+void SS_LightResourceManager::SetStatsEventInterval(int interval_ms)
+{
+    if (interval_ms <= 0)
+    {
+        StopStatsTimer_();
+        return;
+    }
+
+    std::lock_guard<std::mutex> lk(stats_mtx_);
+    stats_interval_ms_ = interval_ms; // 运行中修改时从下一个周期生效
+    if (!stats_thread_.joinable())
+    {
+        stats_stop_ = false;
+        stats_thread_ = std::thread(&SS_LightResourceManager::StatsLoop_, this);
+    }
+}
+
+void SS_LightResourceManager::StopStatsTimer_()
+{
+    std::thread t;
+    {
+        std::lock_guard<std::mutex> lk(stats_mtx_);
+        stats_stop_ = true;
+        stats_interval_ms_ = 0;
+        t.swap(stats_thread_);
+    }
+    stats_cv_.notify_all();
+
+    if (t.joinable())
+        t.join();
+}
+
+void SS_LightResourceManager::SetStatsCollector_(
+    const std::string& instance_id,
+    std::shared_ptr<SS_LightConnectionStatsCollector> collector)
+{
+    std::lock_guard<std::mutex> lk(stats_mtx_);
+    if (collector)
+        stats_collectors_[instance_id] = std::move(collector);
+    else
+        stats_collectors_.erase(instance_id);
+}
+
+void SS_LightResourceManager::StatsLoop_()
+{
+    std::vector<std::pair<std::string, std::shared_ptr<SS_LightConnectionStatsCollector>>> collectors;
+
+    std::unique_lock<std::mutex> lk(stats_mtx_);
+    for (;;)
+    {
+        const auto interval = std::chrono::milliseconds(stats_interval_ms_);
+        if (stats_cv_.wait_for(lk, interval, [this] { return stats_stop_; }))
+            break;
+
+        collectors.assign(stats_collectors_.begin(), stats_collectors_.end());
+        lk.unlock();
+
+        // 快照全是原子读，发布在锁外进行（handler 可能较慢）
+        if (event_bus_)
+        {
+            for (const auto& c : collectors)
+            {
+                SS_LightEventStats ev;
+                ev.instance_id = c.first;
+                c.second->Snapshot(ev.stats);
+                ev.stats.instance_id = c.first;
+                event_bus_->Publish(ev);
+            }
+        }
+        collectors.clear();
+
+        lk.lock();
+    }
+}
+
+std::shared_ptr<const SS_LightControllerTemplate> SS_LightResourceManager::FindTemplate(const std::string& template_id) const
 {
+    std::lock_guard<std::mutex> lk(registry_mtx_);
     auto it = templates_.find(template_id);
     if (it == templates_.end()) return nullptr;
-    return &it->second;
+    return it->second;
 }
 
-SS_LightControllerRuntime* SS_LightResourceManager::FindRuntime(const std::string& instance_id)
+SS_LightResourceManager::RuntimePtr SS_LightResourceManager::FindRuntime(const std::string& instance_id) const
 {
+    std::lock_guard<std::mutex> lk(registry_mtx_);
     auto it = runtimes_.find(instance_id);
     if (it == runtimes_.end()) return nullptr;
-    return it->second.get();
+    return it->second;
 }
 
-const SS_LightControllerRuntime* SS_LightResourceManager::FindRuntime(const std::string& instance_id) const
+std::vector<std::pair<std::string, SS_LightResourceManager::RuntimePtr>> SS_LightResourceManager::ListRuntimes_() const
 {
-    auto it = runtimes_.find(instance_id);
-    if (it == runtimes_.end()) return nullptr;
-    return it->second.get();
+    std::lock_guard<std::mutex> lk(registry_mtx_);
+    return std::vector<std::pair<std::string, RuntimePtr>>(runtimes_.begin(), runtimes_.end());
 }
 
 void SS_LightResourceManager::CleanupChannelParamValues(SS_LightControllerInstance& inst, const std::string& channel_id)
 {
-    for (auto& kv : inst.channel_param_values)
-    {
-        auto& channel_map = kv.second;
-        channel_map.erase(channel_id);
-    }
+    inst.param_values.EraseChannel(channel_id);
 }
@@ -3,16 +3,35 @@
 
 #include <string>
 #include <unordered_map>
+#include <map>
 #include <memory>
 #include <vector>
+#include <unordered_set>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
 
 #include "ss_light_resource_controller_runtime.h"
 #include "ss_light_resource_yaml_codec.h"
+#include "ss_light_resource_discovery.h"
 
+// 线程模型
+// - 可在任意线程调用；Init / Shutdown / SetEventBus 除外（启动/退出时单线程调用）
+// - 同一实例的写操作按实例串行（SS_LightControllerRuntime::WriteScope），不同实例互不阻塞
+// - GetInstance / ListInstanceIds 等读操作只取不可变快照，不等待写者（连接、发送中也不阻塞）
+// - registry_mtx_ 只在查找/增删表项时短暂持有，从不跨越实例写操作
+// - 实例文件：序列化在实例写锁内完成，写文件在锁外（save_mtx_ 串行），按序列号保证旧内容不会覆盖新内容
+// - 修改日志：参数/通道修改在实例写锁内追加进日志（只进内存，后台 group commit 落盘）；
+//   ReloadInstances 把遗留日志重放到 YAML 上，后台定期把日志折叠进 *_instance.yaml
+// - 修改接口成功后发布模型变更事件（PARAM_CHANGED / CHANNEL_* / INSTANCE_RENAMED / CONNECTION_CONFIG_CHANGED）：
+//   事件在该实例新快照发布后、写锁释放前发出；回调线程即调用线程，请勿在回调里长时间阻塞
 class SS_LightResourceManager
 {
 public:
     SS_LightResourceManager(std::string template_dir, std::string instance_dir);
+    ~SS_LightResourceManager();
 
     // 载入所有模板、可选载入实例
     bool Init(std::string& out_error);
@@ -23,6 +42,8 @@ public:
     bool ReloadTemplates(std::string& out_error);
     std::vector<std::string> ListTemplateIds() const;
     bool GetTemplate(const std::string& template_id, SS_LightControllerTemplate& out_tpl) const;
+    // 共享只读句柄（不拷贝）；模板重新加载后旧句柄仍然有效，只是不再是最新
+    std::shared_ptr<const SS_LightControllerTemplate> GetTemplateShared(const std::string& template_id) const;
 
     // instances (runtime)
     bool LoadInstanceFile(const std::string& instance_yaml_path, std::string& out_error);
@@ -32,6 +53,8 @@ public:
 
     std::vector<std::string> ListInstanceIds() const;
     bool GetInstance(const std::string& instance_id, SS_LightControllerInstance& out_inst) const;
+    // 当前不可变快照（不拷贝）；之后的写操作发布新快照，已取得的句柄内容不变
+    std::shared_ptr<const SS_LightControllerInstance> GetInstanceShared(const std::string& instance_id) const;
 
     // instance metadata ops
     bool RenameController(const std::string& instance_id, const std::string& new_display_name);
@@ -46,6 +69,9 @@ public:
     // change channel index (with conflict check)
     bool SetChannelIndex(const std::string& instance_id, const std::string& channel_id, int new_channel_index, std::string& out_error);
 
+    // channel_id -> 通道句柄（SS_LightParamSetRequest::channel_handle）
+    bool ResolveChannelHandle(const std::string& instance_id, const std::string& channel_id, int& out_handle, std::string& out_error) const;
+
     // 默认加通道（UI 点 “+” 用这个）
     // - 自动选择最小可用 channel_index
     // - 自动命名
@@ -57,11 +83,49 @@ public:
     bool SaveInstanceById(const std::string& instance_id, std::string& out_error);
     bool DeleteInstanceById(const std::string& instance_id, std::string& out_error);
 
+    // 延迟保存（write-behind）：只标记脏，后台线程在 debounce 后合并写一次
+    // - 频繁修改（拖动滑块）时写文件次数随时间间隔而不是修改次数增长
+    // - 写失败时通过 INSTANCE_ERROR 事件（code = 3001）报告，并稍后重试
+    // - 修改日志写失败报 code = 3002（记录保留重试）；调用方可关闭 journal / write_behind 退回同步保存
+    bool SaveInstanceDeferred(const std::string& instance_id, std::string& out_error);
+    // 立即写出全部待写实例（Shutdown / ReloadInstances 前自动调用）
+    bool FlushPendingSaves(std::string& out_error);
+    void SetPersistOptions(const SS_LightPersistOptions& opts);
+    void GetPersistOptions(SS_LightPersistOptions& out_opts) const;
+    void GetPersistStats(SS_LightPersistStats& out_stats);
+    // 把修改日志折叠进 *_instance.yaml（只写有记录且已有文件的实例），成功后删除旧日志段
+    // 后台按 compact_interval_ms / compact_bytes 自动调用，Shutdown / ReloadInstances 前也会调用
+    bool CompactJournal(std::string& out_error);
+
     // core entry
     bool SetParameterValue(const SS_LightParamSetRequest& req, SS_LightParamSetResult& out_result);
     // build + send（对应 runtime::SetParamAndSend）
     bool SetParameterAndSend(const SS_LightParamSetRequest& req, SS_LightParamSetResult& out_result);
 
+    // 批量写入（对应 runtime::ApplyParamBatch）：全部校验通过才写入，发送后整批只保存一次
+    // reqs 中 instance_id 可留空，非空时必须等于 instance_id
+    bool ApplyBatch(const std::string& instance_id, const std::vector<SS_LightParamSetRequest>& reqs, SS_LightBatchResult& out_result, std::string& out_error);
+
+    // 配方：<instance_dir>/recipes/<instance_id>/<recipe_id>_recipe.yaml（Init 时载入）
+    // - SaveRecipe 先按模板校验并预编译帧，失败不落盘
+    // - CaptureRecipe 以实例当前参数值生成配方
+    // - ApplyRecipe 只写入/发送与实例当前值不同的项（full = true 时全部），实例整批保存一次
+    bool ReloadRecipes(std::string& out_error);
+    bool SaveRecipe(const SS_LightRecipe& recipe, std::string& out_error);
+    bool CaptureRecipe(const std::string& instance_id, const std::string& recipe_id, const std::string& display_name, std::string& out_error);
+    bool DeleteRecipe(const std::string& instance_id, const std::string& recipe_id, std::string& out_error);
+    std::vector<std::string> ListRecipeIds(const std::string& instance_id) const;
+    bool GetRecipe(const std::string& instance_id, const std::string& recipe_id, SS_LightRecipe& out_recipe) const;
+    bool ApplyRecipe(const std::string& instance_id, const std::string& recipe_id, bool full, SS_LightRecipeApplyResult& out_result, std::string& out_error);
+
+    // 合并发送（对应 runtime::SubmitParamCoalesced）：out_sent 为本次实际发出的结果，为空表示已挂起
+    bool SubmitParameterCoalesced(const SS_LightParamSetRequest& req, std::vector<SS_LightCoalescedResult>& out_sent, std::string& out_error);
+    // 补发到期的挂起值（UI 定时调用）；instance_id 为空时处理所有实例
+    void FlushParameterUpdates(const std::string& instance_id, bool force, std::vector<SS_LightCoalescedResult>& out_sent);
+    bool HasPendingParameterUpdates(const std::string& instance_id) const;
+    // 对现有及之后创建的实例生效
+    void SetCoalesceOptions(const SS_LightCoalesceOptions& opts);
+
     // instances creation
     bool CreateInstanceFromTemplate(
         const std::string& template_id,
@@ -74,32 +138,168 @@ public:
     bool DisconnectInstance(const std::string& instance_id, std::string& out_error);
     bool IsInstanceConnected(const std::string& instance_id) const;
 
+    // 批量并发连接（异步，立即返回）
+    // - 同时最多 max_concurrency 个连接尝试，每次尝试有超时，失败按 max_attempts 重试
+    // - 进度通过 CONNECT_BATCH_PROGRESS / CONNECT_BATCH_FINISHED 事件发布（工作线程回调）
+    // - 同一时刻只允许一个批次；批次内的实例在完成前拒绝单独连接/断开/改配置
+    bool ConnectAll(const SS_LightConnectBatchOptions& opts, uint64_t& out_batch_id, std::string& out_error);
+    bool ConnectInstances(const std::vector<std::string>& instance_ids, const SS_LightConnectBatchOptions& opts, uint64_t& out_batch_id, std::string& out_error);
+    // 不再发起新的尝试，并等待进行中的尝试结束
+    void CancelConnectBatch();
+    bool IsConnectBatchRunning() const;
+
+    // 自动发现：并发探测串口/网段，返回命中的 (template_id, connection)
+    // 阻塞直到探测结束（通常数秒），UI 请在工作线程调用
+    bool DiscoverDevices(const SS_LightDiscoveryOptions& opts, std::vector<SS_LightDiscoveryCandidate>& out_candidates, std::string& out_error);
+
     // 更新连接配置（UI 编辑串口/网口参数需要）
     bool UpdateConnectionConfig(const std::string& instance_id, const SS_LightConnectionConfig& conn, std::string& out_error);
 
+    // 抓包录制 / 回放（transport 层）
+    bool StartTrafficRecording(const std::string& capture_path, std::string& out_error);
+    void StopTrafficRecording();
+    bool SetInstanceReplaySource(const std::string& instance_id, const std::string& capture_path, double speed, std::string& out_error);
+
+    // 连接统计：收发帧/字节、发送耗时与 RTT 直方图、超时/校验失败/重试/重连次数及底层链路计数
+    bool GetConnectionStats(const std::string& instance_id, SS_LightConnectionStats& out_stats, std::string& out_error) const;
+    // 每 interval_ms 为每个实例发布一条 CONNECTION_STATS 事件（统计线程回调）；<= 0 关闭
+    // 不要在该事件的回调里调用本函数关闭定时器
+    void SetStatsEventInterval(int interval_ms);
+
     void SetEventBus(SS_LightEventBus* bus) { event_bus_ = bus; }
 
 private:
-    const SS_LightControllerTemplate* FindTemplate(const std::string& template_id) const;
-    SS_LightControllerRuntime* FindRuntime(const std::string& instance_id);
-    const SS_LightControllerRuntime* FindRuntime(const std::string& instance_id) const;
+    using RuntimePtr = std::shared_ptr<SS_LightControllerRuntime>;
+
+    std::shared_ptr<const SS_LightControllerTemplate> FindTemplate(const std::string& template_id) const;
+    // 返回的 runtime 在调用方持有期间有效（即使同时被移除/替换）
+    RuntimePtr FindRuntime(const std::string& instance_id) const;
+    std::vector<std::pair<std::string, RuntimePtr>> ListRuntimes_() const;
+
+    // 挂起的合并值立即发出并落盘（关闭 / 重新加载前调用）
+    void FlushCoalesced_();
 
     static void CleanupChannelParamValues(SS_LightControllerInstance& inst, const std::string& channel_id);
 
+    // 配方文件路径
+    std::string RecipeDir_(const std::string& instance_id) const;
+    std::string RecipePath_(const std::string& instance_id, const std::string& recipe_id) const;
+
+    // 批量连接
+    struct ConnectBatch
+    {
+        uint64_t id = 0;
+        SS_LightConnectBatchOptions opts;
+
+        // 启动时解析好的 runtime；批次结束前这些实例不会被移除/替换
+        std::vector<std::pair<std::string, RuntimePtr>> jobs;
+
+        std::atomic<size_t> next{ 0 };
+        std::atomic_int done{ 0 };
+        std::atomic_int succeeded{ 0 };
+        std::atomic_int failed{ 0 };
+        std::atomic_int workers_left{ 0 };
+        std::atomic_bool cancel{ false };
+    };
+
+    // 工作线程持有批次的引用：批次被替换/取消后，退出前的收尾仍可安全访问
+    void ConnectBatchWorker_(std::shared_ptr<ConnectBatch> batch);
+    void FinishConnectJob_(ConnectBatch* batch, const std::string& instance_id, bool ok, const std::string& msg);
+    // 批次包含该实例时先停掉批次（移除/替换 runtime 前调用）
+    void StopConnectBatchIfBusy_(const std::string& instance_id);
+    bool IsInConnectBatch_(const std::string& instance_id) const;
+
+    // 实例文件写出：序列化（实例写锁内）-> 哈希比对 -> 原子替换文件（save_mtx_ 内）
+    bool WriteInstanceFile_(const std::string& instance_id, std::string& out_error);
+    void PersistLoop_();
+    void StopPersistThread_();
+    void EnsurePersistThread_();   // 需持有 persist_mtx_
+    std::string JournalDir_() const;
+    bool OpenJournal_(std::string& out_error);
+
+    // 定时统计事件
+    void StatsLoop_();
+    void StopStatsTimer_();
+    // 跟随 runtimes_ 增删；collector 为空表示移除
+    void SetStatsCollector_(const std::string& instance_id, std::shared_ptr<SS_LightConnectionStatsCollector> collector);
+
 private:
     std::string template_dir_;
     std::string instance_dir_;
 
-    SS_LightYamlCodec codec_;
+    // 保护 templates_ / runtimes_ / instance_paths_ / recipes_ / coalesce_opts_ 这几张表
+    // （codec 带 last_error_ 状态，改为每次调用各用一份，不再共享成员）
+    mutable std::mutex registry_mtx_;
+    // CreateInstanceFromTemplate 挑选 controller_<n> 编号到登记完成之间互斥
+    std::mutex create_mtx_;
+
+    // template_id -> template；不可变，所有同型号 runtime 共用一份
+    std::unordered_map<std::string, std::shared_ptr<const SS_LightControllerTemplate>> templates_;
 
-    // template_id -> template
-    std::unordered_map<std::string, SS_LightControllerTemplate> templates_;
+    // 修改日志（自带锁）；runtime 持有裸指针，声明在 runtimes_ 之前，析构在其后
+    SS_LightChangeJournal journal_;
 
     // instance_id -> runtime
-    std::unordered_map<std::string, std::unique_ptr<SS_LightControllerRuntime>> runtimes_;
+    std::unordered_map<std::string, RuntimePtr> runtimes_;
 
     // instance_id -> yaml path（支持 UUID / controller_123 任意格式 id）
     std::unordered_map<std::string, std::string> instance_paths_;
 
     SS_LightEventBus* event_bus_ = nullptr;
+
+    SS_LightCoalesceOptions coalesce_opts_;
+
+    // instance_id -> recipe_id -> 配方；revision 每次保存/载入递增，runtime 据此判断预编译帧是否过期
+    struct StoredRecipe
+    {
+        SS_LightRecipe recipe;
+        uint64_t revision = 0;
+    };
+    std::unordered_map<std::string, std::map<std::string, StoredRecipe>> recipes_;
+    std::atomic<uint64_t> next_recipe_revision_{ 0 };
+
+    // 所有 runtime 共用一个录制文件
+    std::shared_ptr<SS_LightTrafficRecorder> recorder_ = std::make_shared<SS_LightTrafficRecorder>();
+
+    // 当前批量连接；batch_mtx_ 保护 batch_ / batch_workers_ / batch_pending_
+    mutable std::mutex batch_mtx_;
+    std::shared_ptr<ConnectBatch> batch_;
+    std::vector<std::thread> batch_workers_;
+    std::unordered_set<std::string> batch_pending_; // 尚未完成的实例
+    uint64_t next_batch_id_ = 0;
+
+    // 延迟落盘；persist_mtx_ 保护 persist_ / persist_opts_ / persist_stats_ / persist_stop_ / persist_thread_
+    struct PersistEntry
+    {
+        bool dirty = false;
+        std::chrono::steady_clock::time_point first_dirty;
+        std::chrono::steady_clock::time_point last_dirty;
+        uint64_t encoded_seq = 0;   // 最近一次序列化的序号（实例写锁内递增，与内容新旧一致）
+        uint64_t written_seq = 0;   // 已在磁盘上的内容对应的序号
+        uint64_t written_hash = 0;  // 已在磁盘上的内容哈希（0 = 未知）
+    };
+    mutable std::mutex persist_mtx_;
+    std::condition_variable persist_cv_;
+    std::unordered_map<std::string, PersistEntry> persist_;
+    SS_LightPersistOptions persist_opts_;
+    SS_LightPersistStats persist_stats_;
+    bool persist_stop_ = false;
+    std::thread persist_thread_;
+    // 串行化实例文件的写入与删除（不跨越实例写锁）
+    std::mutex save_mtx_;
+    // 日志折叠；compact_mtx_ 保护 compact_pending_（封存段里还没写进 YAML 的实例），last_compact_ 归 persist_mtx_
+    std::mutex compact_mtx_;
+    std::unordered_set<std::string> compact_pending_;
+    std::chrono::steady_clock::time_point last_compact_;
+    // Init 完成到 Shutdown 之间为 true（SetPersistOptions 重新打开日志用）
+    std::atomic_bool inited_{ false };
+
+    // 定时统计事件；统计线程不碰 runtimes_，只读这里登记的 collector
+    // stats_mtx_ 保护 stats_collectors_ / stats_interval_ms_ / stats_stop_ / stats_thread_
+    std::mutex stats_mtx_;
+    std::condition_variable stats_cv_;
+    std::unordered_map<std::string, std::shared_ptr<SS_LightConnectionStatsCollector>> stats_collectors_;
+    int stats_interval_ms_ = 0;
+    bool stats_stop_ = false;
+    std::thread stats_thread_;
 };
\ No newline at end of file
@@ -0,0 +1,678 @@
+// ss_light_resource_param_values.h
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+#include <cctype>
+#include <cmath>
+#include <charconv>
+#include <cstdio>
+
+#include "ss_light_resource_types.h"
+
+// 按 value_type 把字符串解析成带类型的值（去首尾空白）
+// - INT：十进制 int64（允许前导 +），text 规范化为 std::to_string
+// - DOUBLE：有限浮点数；BOOL：true/false/1/0（不区分大小写）
+// - ENUM：必须是 options 之一（options 为空时不限制，i = -1）
+// - BYTES：十六进制串，允许空白和 0x 前缀
+// - STRING / UNKNOWN：原样保存
+inline bool SS_LightParseParamValue(
+    SS_LIGHT_VALUE_TYPE type,
+    const std::vector<std::string>& options,
+    const std::string& value_str,
+    SS_LightParamValue& out_value,
+    std::string& out_error)
+{
+    out_value = SS_LightParamValue{};
+    out_value.type = type;
+
+    if (type == SS_LIGHT_VALUE_TYPE::STRING || type == SS_LIGHT_VALUE_TYPE::UNKNOWN)
+    {
+        out_value.text = value_str;
+        return true;
+    }
+
+    size_t b = 0, e = value_str.size();
+    while (b < e && std::isspace(static_cast<unsigned char>(value_str[b]))) ++b;
+    while (e > b && std::isspace(static_cast<unsigned char>(value_str[e - 1]))) --e;
+    out_value.text.assign(value_str, b, e - b);
+    const std::string& t = out_value.text;
+
+    switch (type)
+    {
+    case SS_LIGHT_VALUE_TYPE::INT:
+    {
+        const char* f = t.data();
+        const char* l = t.data() + t.size();
+        if (f != l && *f == '+') ++f;
+        auto res = std::from_chars(f, l, out_value.i, 10);
+        if (t.empty() || res.ec != std::errc{} || res.ptr != l)
+        {
+            out_error = "不是有效的整数：" + value_str;
+            return false;
+        }
+        out_value.text = std::to_string(out_value.i);
+        return true;
+    }
+    case SS_LIGHT_VALUE_TYPE::DOUBLE:
+    {
+        const char* f = t.data();
+        const char* l = t.data() + t.size();
+        if (f != l && *f == '+') ++f;
+        auto res = std::from_chars(f, l, out_value.d);
+        if (t.empty() || res.ec != std::errc{} || res.ptr != l || !std::isfinite(out_value.d))
+        {
+            out_error = "不是有效的数值：" + value_str;
+            return false;
+        }
+        return true;
+    }
+    case SS_LIGHT_VALUE_TYPE::BOOL:
+    {
+        std::string l = t;
+        for (auto& c : l) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        if (l == "true" || l == "1") out_value.i = 1;
+        else if (l == "false" || l == "0") out_value.i = 0;
+        else
+        {
+            out_error = "不是有效的布尔值（true/false/1/0）：" + value_str;
+            return false;
+        }
+        return true;
+    }
+    case SS_LIGHT_VALUE_TYPE::ENUM:
+    {
+        out_value.i = -1;
+        if (options.empty())
+            return true;
+        for (size_t k = 0; k < options.size(); ++k)
+        {
+            if (options[k] == t)
+            {
+                out_value.i = static_cast<int64_t>(k);
+                return true;
+            }
+        }
+        out_error = "不在可选项中：" + value_str;
+        return false;
+    }
+    case SS_LIGHT_VALUE_TYPE::BYTES:
+    {
+        std::string hex;
+        size_t k = 0;
+        if (t.size() >= 2 && t[0] == '0' && (t[1] == 'x' || t[1] == 'X')) k = 2;
+        for (; k < t.size(); ++k)
+        {
+            const unsigned char c = static_cast<unsigned char>(t[k]);
+            if (std::isxdigit(c)) hex.push_back(static_cast<char>(c));
+            else if (!std::isspace(c))
+            {
+                out_error = "不是有效的十六进制字节串：" + value_str;
+                return false;
+            }
+        }
+        if (hex.size() & 1) hex.insert(hex.begin(), '0');
+        auto nib = [](char c) -> uint8_t {
+            if (c >= '0' && c <= '9') return static_cast<uint8_t>(c - '0');
+            if (c >= 'a' && c <= 'f') return static_cast<uint8_t>(c - 'a' + 10);
+            return static_cast<uint8_t>(c - 'A' + 10);
+        };
+        out_value.bytes.reserve(hex.size() / 2);
+        for (size_t n = 0; n < hex.size(); n += 2)
+            out_value.bytes.push_back(static_cast<uint8_t>((nib(hex[n]) << 4) | nib(hex[n + 1])));
+        return true;
+    }
+    default:
+        break;
+    }
+    return true;
+}
+
+// 参数的值约定：模板载入时由 value_type / widget_config / range_policy 编译一次（不可变）
+// - Parse：按类型解析；Validate：范围 / 步进 / 可选项 / 长度检查
+// - Validate 通过时不分配内存；CLAMP 改写值时才重新生成 text
+struct SS_LightParamValueSpec
+{
+    SS_LIGHT_VALUE_TYPE type = SS_LIGHT_VALUE_TYPE::UNKNOWN;
+    SS_LIGHT_RANGE_POLICY policy = SS_LIGHT_RANGE_POLICY::REJECT;
+    std::vector<std::string> options;   // ENUM，或 COMBO_BOX 的 STRING；空 = 不限制
+
+    // widget range：min < max 时生效
+    bool has_range = false;
+    double min_value = 0.0;
+    double max_value = 0.0;
+    int64_t int_min = 0;                // INT 的整数边界（min 向上取整，max 向下取整）
+    int64_t int_max = 0;
+    std::string min_text;               // CLAMP 到边界时直接用
+    std::string max_text;
+
+    int64_t int_step = 0;               // INT 步进，> 1 时生效，以 int_min（无 range 时为 0）为起点
+    size_t text_max_length = 0;         // STRING 最大字符数（按 UTF-8 码点），0 = 不限
+
+    bool Parse(const std::string& value_str, SS_LightParamValue& out_value, std::string& out_error) const
+    {
+        return SS_LightParseParamValue(type, options, value_str, out_value, out_error);
+    }
+
+    // 返回 false 表示拒绝；CLAMP 时原地改写 value
+    bool Validate(SS_LightParamValue& value, std::string& out_error) const
+    {
+        const bool clamp = policy == SS_LIGHT_RANGE_POLICY::CLAMP;
+
+        if (value.type == SS_LIGHT_VALUE_TYPE::INT)
+        {
+            int64_t v = value.i;
+            if (has_range && (v < int_min || v > int_max))
+            {
+                if (!clamp)
+                {
+                    out_error = "超出范围 [" + min_text + ", " + max_text + "]：" + value.text;
+                    return false;
+                }
+                v = v < int_min ? int_min : int_max;
+            }
+
+            if (int_step > 1)
+            {
+                const int64_t base = has_range ? int_min : 0;
+                int64_t r = (v - base) % int_step;
+                if (r < 0) r += int_step;
+                if (r != 0)
+                {
+                    if (!clamp)
+                    {
+                        out_error = "不是步进 " + std::to_string(int_step) + " 的整数倍：" + value.text;
+                        return false;
+                    }
+                    v -= r;
+                    if (r * 2 >= int_step && (!has_range || v + int_step <= int_max))
+                        v += int_step;
+                }
+            }
+
+            if (v != value.i)
+            {
+                value.i = v;
+                value.text = std::to_string(v);
+            }
+            return true;
+        }
+
+        if (value.type == SS_LIGHT_VALUE_TYPE::DOUBLE)
+        {
+            if (has_range && (value.d < min_value || value.d > max_value))
+            {
+                if (!clamp)
+                {
+                    out_error = "超出范围 [" + min_text + ", " + max_text + "]：" + value.text;
+                    return false;
+                }
+                const bool low = value.d < min_value;
+                value.d = low ? min_value : max_value;
+                value.text = low ? min_text : max_text;
+            }
+            return true;
+        }
+
+        if (value.type == SS_LIGHT_VALUE_TYPE::STRING)
+        {
+            if (!options.empty() && std::find(options.begin(), options.end(), value.text) == options.end())
+            {
+                out_error = "不在可选项中：" + value.text;
+                return false;
+            }
+
+            if (text_max_length > 0)
+            {
+                // 按码点计数，截断也只在码点边界
+                size_t chars = 0, cut = value.text.size();
+                for (size_t k = 0; k < value.text.size(); ++k)
+                {
+                    if ((static_cast<unsigned char>(value.text[k]) & 0xC0) == 0x80)
+                        continue;
+                    if (chars == text_max_length)
+                    {
+                        cut = k;
+                        break;
+                    }
+                    ++chars;
+                }
+                if (cut < value.text.size())
+                {
+                    if (!clamp)
+                    {
+                        out_error = "超过最大长度 " + std::to_string(text_max_length) + "：" + value.text;
+                        return false;
+                    }
+                    value.text.resize(cut);
+                }
+            }
+        }
+        return true;
+    }
+
+    bool ParseAndValidate(const std::string& value_str, SS_LightParamValue& out_value, std::string& out_error) const
+    {
+        return Parse(value_str, out_value, out_error) && Validate(out_value, out_error);
+    }
+
+    // 载入已有值用：只按类型解析、不做范围检查；不合法时保留原文（type = UNKNOWN），不丢数据
+    SS_LightParamValue ParseLenient(const std::string& value_str) const
+    {
+        SS_LightParamValue v;
+        std::string err;
+        if (!Parse(value_str, v, err))
+        {
+            v = SS_LightParamValue{};
+            v.text = value_str;
+        }
+        return v;
+    }
+};
+
+// 由参数定义编译值约定
+inline SS_LightParamValueSpec SS_LightCompileParamValueSpec(const SS_LightParamDef& def)
+{
+    SS_LightParamValueSpec spec;
+    spec.type = def.value_type;
+    spec.policy = def.range_policy;
+
+    const SS_LightWidgetConfig& w = def.widget;
+    if (def.value_type == SS_LIGHT_VALUE_TYPE::ENUM ||
+        (def.value_type == SS_LIGHT_VALUE_TYPE::STRING && w.type == SS_LIGHT_WIDGET_TYPE::COMBO_BOX))
+        spec.options = w.options;
+
+    if ((def.value_type == SS_LIGHT_VALUE_TYPE::INT || def.value_type == SS_LIGHT_VALUE_TYPE::DOUBLE) &&
+        w.min_value < w.max_value)
+    {
+        spec.has_range = true;
+        spec.min_value = w.min_value;
+        spec.max_value = w.max_value;
+
+        auto fmt = [](double v) {
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "%.15g", v);
+            return std::string(buf);
+        };
+
+        if (def.value_type == SS_LIGHT_VALUE_TYPE::INT)
+        {
+            const double lo = std::ceil(w.min_value);
+            const double hi = std::floor(w.max_value);
+            if (lo <= hi && lo >= -9.0e18 && hi <= 9.0e18)
+            {
+                spec.int_min = static_cast<int64_t>(lo);
+                spec.int_max = static_cast<int64_t>(hi);
+                spec.min_text = std::to_string(spec.int_min);
+                spec.max_text = std::to_string(spec.int_max);
+            }
+            else
+            {
+                spec.has_range = false;
+            }
+        }
+        else
+        {
+            spec.min_text = fmt(w.min_value);
+            spec.max_text = fmt(w.max_value);
+        }
+    }
+
+    if (def.value_type == SS_LIGHT_VALUE_TYPE::INT && w.step >= 2.0 && w.step <= 9.0e18 && std::floor(w.step) == w.step)
+        spec.int_step = static_cast<int64_t>(w.step);
+
+    if (def.value_type == SS_LIGHT_VALUE_TYPE::STRING && w.text_max_length > 0)
+        spec.text_max_length = static_cast<size_t>(w.text_max_length);
+
+    return spec;
+}
+
+// 模板参数 id 表：模板载入时分配稠密 id，同一模板的所有实例共用（不可变）
+// - 全局参数、通道参数各自从 0 编号；location 为 UNKNOWN 的参数两边都有 id
+struct SS_LightParamIndex
+{
+    std::vector<std::string> global_keys;           // global id -> key
+    std::vector<std::string> channel_keys;          // channel id -> key
+    std::vector<SS_LightParamValueSpec> global_specs;   // global id -> 值约定
+    std::vector<SS_LightParamValueSpec> channel_specs;  // channel id -> 值约定
+    std::unordered_map<std::string, int> global_ids;
+    std::unordered_map<std::string, int> channel_ids;
+
+    int FindGlobal(const std::string& key) const
+    {
+        auto it = global_ids.find(key);
+        return it == global_ids.end() ? -1 : it->second;
+    }
+    int FindChannel(const std::string& key) const
+    {
+        auto it = channel_ids.find(key);
+        return it == channel_ids.end() ? -1 : it->second;
+    }
+
+    const SS_LightParamValueSpec* FindSpec(const std::string& key, SS_LIGHT_PARAM_LOCATION loc) const
+    {
+        const int id = loc == SS_LIGHT_PARAM_LOCATION::GLOBAL ? FindGlobal(key) : FindChannel(key);
+        if (id < 0) return nullptr;
+        return loc == SS_LIGHT_PARAM_LOCATION::GLOBAL ? &global_specs[id] : &channel_specs[id];
+    }
+};
+
+// 实例参数值（稠密存储，带类型）
+// - 全局值：global_[global_id]
+// - 通道值：channel_[channel_param_id * slot_capacity_ + slot]，slot 为实例内通道槽位（首次写入时分配，删除通道后复用）
+// - 按字符串写入时用 id 表里的值类型宽松解析（不合法的旧值保留原文）；已解析的值用 SS_LightParamValue 重载直接写入
+// - 未绑定 id 表、或模板里没有的 key 放在 extra_*，原样保存，保证 YAML 往返不丢值
+// - 字符串 key 接口是兼容层；热路径先 FindGlobalId / FindChannelId / FindChannelSlot，再按 id 读写
+class SS_LightParamValues
+{
+public:
+    // 换 id 表时按 key 迁移已有值
+    void BindIndex(std::shared_ptr<const SS_LightParamIndex> index)
+    {
+        if (index == index_)
+            return;
+
+        // 按原文迁移，由新 id 表重新解析（类型可能随模板变化）
+        std::vector<std::pair<std::string, std::string>> globals;
+        std::vector<std::pair<std::pair<std::string, std::string>, std::string>> channels;
+        ForEachGlobal([&](const std::string& k, const std::string& v) { globals.emplace_back(k, v); });
+        ForEachChannel([&](const std::string& k, const std::string& c, const std::string& v) {
+            channels.emplace_back(std::make_pair(k, c), v);
+        });
+
+        Clear();
+        index_ = std::move(index);
+        for (auto& g : globals)
+            SetGlobal(g.first, g.second);
+        for (auto& c : channels)
+            SetChannel(c.first.first, c.first.second, c.second);
+    }
+
+    const std::shared_ptr<const SS_LightParamIndex>& GetIndex() const { return index_; }
+
+    void Clear()
+    {
+        global_.clear();
+        global_set_.clear();
+        channel_slots_.clear();
+        slot_ids_.clear();
+        slot_capacity_ = 0;
+        channel_.clear();
+        channel_set_.clear();
+        extra_global_.clear();
+        extra_channel_.clear();
+    }
+
+    // ---- id 访问 ----
+    int FindGlobalId(const std::string& key) const { return index_ ? index_->FindGlobal(key) : -1; }
+    int FindChannelId(const std::string& key) const { return index_ ? index_->FindChannel(key) : -1; }
+
+    // O(1)：大通道数控制器（几十上百路）线性查找不可忽略
+    int FindChannelSlot(const std::string& channel_id) const
+    {
+        if (channel_id.empty()) return -1;
+        auto it = slot_ids_.find(channel_id);
+        return it == slot_ids_.end() ? -1 : it->second;
+    }
+
+    const SS_LightParamValue* GetGlobal(int global_id) const
+    {
+        if (global_id < 0 || static_cast<size_t>(global_id) >= global_set_.size() || !global_set_[global_id])
+            return nullptr;
+        return &global_[global_id];
+    }
+
+    const SS_LightParamValue* GetChannel(int channel_param_id, int slot) const
+    {
+        if (channel_param_id < 0 || slot < 0 || static_cast<size_t>(slot) >= slot_capacity_) return nullptr;
+        const size_t pos = static_cast<size_t>(channel_param_id) * slot_capacity_ + static_cast<size_t>(slot);
+        if (pos >= channel_set_.size() || !channel_set_[pos])
+            return nullptr;
+        return &channel_[pos];
+    }
+
+    void SetGlobal(int global_id, SS_LightParamValue value)
+    {
+        if (global_id < 0) return;
+        if (static_cast<size_t>(global_id) >= global_.size())
+        {
+            const size_t n = index_ ? index_->global_keys.size() : static_cast<size_t>(global_id) + 1;
+            global_.resize(n > static_cast<size_t>(global_id) ? n : static_cast<size_t>(global_id) + 1);
+            global_set_.resize(global_.size(), 0);
+        }
+        global_[global_id] = std::move(value);
+        global_set_[global_id] = 1;
+    }
+
+    void SetChannel(int channel_param_id, int slot, SS_LightParamValue value)
+    {
+        if (channel_param_id < 0 || slot < 0 || static_cast<size_t>(slot) >= slot_capacity_) return;
+        EnsureChannelRows_(static_cast<size_t>(channel_param_id) + 1);
+        const size_t pos = static_cast<size_t>(channel_param_id) * slot_capacity_ + static_cast<size_t>(slot);
+        channel_[pos] = std::move(value);
+        channel_set_[pos] = 1;
+    }
+
+    // 没有则分配槽位（优先复用已删除通道的槽位）
+    int EnsureChannelSlot(const std::string& channel_id)
+    {
+        if (channel_id.empty()) return -1;
+        int slot = FindChannelSlot(channel_id);
+        if (slot >= 0) return slot;
+
+        for (size_t i = 0; i < channel_slots_.size(); ++i)
+        {
+            if (channel_slots_[i].empty())
+            {
+                channel_slots_[i] = channel_id;
+                slot_ids_[channel_id] = static_cast<int>(i);
+                return static_cast<int>(i);
+            }
+        }
+
+        channel_slots_.push_back(channel_id);
+        slot_ids_[channel_id] = static_cast<int>(channel_slots_.size() - 1);
+        if (channel_slots_.size() > slot_capacity_)
+            Relayout_(slot_capacity_ < 4 ? 4 : slot_capacity_ * 2);
+        return static_cast<int>(channel_slots_.size() - 1);
+    }
+
+    // ---- 字符串 key 兼容层 ----
+    const std::string* FindGlobal(const std::string& key) const
+    {
+        const int id = FindGlobalId(key);
+        if (id >= 0)
+        {
+            const SS_LightParamValue* v = GetGlobal(id);
+            return v ? &v->text : nullptr;
+        }
+
+        auto it = extra_global_.find(key);
+        return it == extra_global_.end() ? nullptr : &it->second;
+    }
+
+    const std::string* FindChannel(const std::string& key, const std::string& channel_id) const
+    {
+        const int id = FindChannelId(key);
+        if (id >= 0)
+        {
+            const SS_LightParamValue* v = GetChannel(id, FindChannelSlot(channel_id));
+            return v ? &v->text : nullptr;
+        }
+
+        auto it = extra_channel_.find(key);
+        if (it == extra_channel_.end()) return nullptr;
+        auto cit = it->second.find(channel_id);
+        return cit == it->second.end() ? nullptr : &cit->second;
+    }
+
+    void SetGlobal(const std::string& key, const std::string& value)
+    {
+        const int id = FindGlobalId(key);
+        if (id >= 0) SetGlobal(id, index_->global_specs[id].ParseLenient(value));
+        else extra_global_[key] = value;
+    }
+
+    void SetChannel(const std::string& key, const std::string& channel_id, const std::string& value)
+    {
+        const int id = FindChannelId(key);
+        if (id >= 0 && !channel_id.empty()) SetChannel(id, EnsureChannelSlot(channel_id), index_->channel_specs[id].ParseLenient(value));
+        else extra_channel_[key][channel_id] = value;
+    }
+
+    // 已按类型解析好的值（runtime 写入路径）
+    void SetGlobal(const std::string& key, SS_LightParamValue value)
+    {
+        const int id = FindGlobalId(key);
+        if (id >= 0) SetGlobal(id, std::move(value));
+        else extra_global_[key] = std::move(value.text);
+    }
+
+    void SetChannel(const std::string& key, const std::string& channel_id, SS_LightParamValue value)
+    {
+        const int id = FindChannelId(key);
+        if (id >= 0 && !channel_id.empty()) SetChannel(id, EnsureChannelSlot(channel_id), std::move(value));
+        else extra_channel_[key][channel_id] = std::move(value.text);
+    }
+
+    // 删除通道的所有参数值并释放槽位
+    void EraseChannel(const std::string& channel_id)
+    {
+        const int slot = FindChannelSlot(channel_id);
+        if (slot >= 0)
+        {
+            for (size_t p = 0; p * slot_capacity_ < channel_.size(); ++p)
+            {
+                const size_t pos = p * slot_capacity_ + static_cast<size_t>(slot);
+                channel_[pos] = SS_LightParamValue{};
+                channel_set_[pos] = 0;
+            }
+            channel_slots_[slot].clear();
+            slot_ids_.erase(channel_id);
+        }
+
+        for (auto& kv : extra_channel_)
+            kv.second.erase(channel_id);
+    }
+
+    // ---- 遍历：先稠密部分（按 id），再 extra ----
+    template <class F>
+    void ForEachGlobal(F&& f) const   // f(key, value)
+    {
+        for (size_t i = 0; i < global_.size(); ++i)
+        {
+            if (global_set_[i] && index_ && i < index_->global_keys.size())
+                f(index_->global_keys[i], global_[i].text);
+        }
+        for (const auto& kv : extra_global_)
+            f(kv.first, kv.second);
+    }
+
+    template <class F>
+    void ForEachChannel(F&& f) const  // f(key, channel_id, value)
+    {
+        if (index_ && slot_capacity_ > 0)
+        {
+            const size_t rows = channel_.size() / slot_capacity_;
+            for (size_t p = 0; p < rows && p < index_->channel_keys.size(); ++p)
+            {
+                for (size_t s = 0; s < channel_slots_.size(); ++s)
+                {
+                    const size_t pos = p * slot_capacity_ + s;
+                    if (channel_set_[pos])
+                        f(index_->channel_keys[p], channel_slots_[s], channel_[pos].text);
+                }
+            }
+        }
+        for (const auto& kv : extra_channel_)
+            for (const auto& ck : kv.second)
+                f(kv.first, ck.first, ck.second);
+    }
+
+private:
+    void EnsureChannelRows_(size_t rows)
+    {
+        if (index_ && index_->channel_keys.size() > rows)
+            rows = index_->channel_keys.size();
+        const size_t need = rows * slot_capacity_;
+        if (channel_.size() < need)
+        {
+            channel_.resize(need);
+            channel_set_.resize(need, 0);
+        }
+    }
+
+    // 槽位容量变化：按 [param][slot] 重新排布
+    void Relayout_(size_t new_capacity)
+    {
+        const size_t rows = slot_capacity_ ? channel_.size() / slot_capacity_ : 0;
+        std::vector<SS_LightParamValue> values(rows * new_capacity);
+        std::vector<uint8_t> set(rows * new_capacity, 0);
+        for (size_t p = 0; p < rows; ++p)
+        {
+            for (size_t s = 0; s < slot_capacity_; ++s)
+            {
+                const size_t from = p * slot_capacity_ + s;
+                const size_t to = p * new_capacity + s;
+                values[to] = std::move(channel_[from]);
+                set[to] = channel_set_[from];
+            }
+        }
+        channel_.swap(values);
+        channel_set_.swap(set);
+        slot_capacity_ = new_capacity;
+    }
+
+private:
+    std::shared_ptr<const SS_LightParamIndex> index_;
+
+    std::vector<SS_LightParamValue> global_;
+    std::vector<uint8_t> global_set_;
+
+    std::vector<std::string> channel_slots_;   // slot -> channel_id，空串 = 空闲
+    std::unordered_map<std::string, int> slot_ids_;   // channel_id -> slot
+    size_t slot_capacity_ = 0;
+    std::vector<SS_LightParamValue> channel_;  // [channel_param_id][slot]
+    std::vector<uint8_t> channel_set_;
+
+    std::unordered_map<std::string, std::string> extra_global_;
+    std::unordered_map<std::string, std::unordered_map<std::string, std::string>> extra_channel_;
+};
+
+// 按模板参数表建 id 表（按 key 排序，保证同一模板每次载入 id 相同）
+inline std::shared_ptr<const SS_LightParamIndex> SS_LightBuildParamIndex(
+    const std::unordered_map<std::string, SS_LightParamDef>& params)
+{
+    auto index = std::make_shared<SS_LightParamIndex>();
+
+    std::vector<const std::pair<const std::string, SS_LightParamDef>*> sorted;
+    sorted.reserve(params.size());
+    for (const auto& kv : params)
+        sorted.push_back(&kv);
+    std::sort(sorted.begin(), sorted.end(),
+        [](const auto* a, const auto* b) { return a->first < b->first; });
+
+    for (const auto* kv : sorted)
+    {
+        const SS_LightParamValueSpec spec = SS_LightCompileParamValueSpec(kv->second);
+
+        const SS_LIGHT_PARAM_LOCATION loc = kv->second.location;
+        if (loc != SS_LIGHT_PARAM_LOCATION::CHANNEL)
+        {
+            index->global_ids[kv->first] = static_cast<int>(index->global_keys.size());
+            index->global_keys.push_back(kv->first);
+            index->global_specs.push_back(spec);
+        }
+        if (loc != SS_LIGHT_PARAM_LOCATION::GLOBAL)
+        {
+            index->channel_ids[kv->first] = static_cast<int>(index->channel_keys.size());
+            index->channel_keys.push_back(kv->first);
+            index->channel_specs.push_back(spec);
+        }
+    }
+    return index;
+}
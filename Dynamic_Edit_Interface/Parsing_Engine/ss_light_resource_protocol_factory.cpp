@@ -32,6 +32,30 @@ bool SS_LightProtocolFactory::BuildCommand(
     int channel_index,
     std::string& out_cmd,
     std::string& out_error) const
+{
+    SS_LightParamValue v;
+    v.text = param_value_str;
+    return BuildCommand(rule, v, channel_index, out_cmd, out_error);
+}
+
+bool SS_LightProtocolFactory::BuildBytesCommand(
+    const SS_LightCommandRule& rule,
+    const std::string& param_value_str,
+    int channel_index,
+    std::vector<uint8_t>& out_bytes,
+    std::string& out_error) const
+{
+    SS_LightParamValue v;
+    v.text = param_value_str;
+    return BuildBytesCommand(rule, v, channel_index, out_bytes, out_error);
+}
+
+bool SS_LightProtocolFactory::BuildCommand(
+    const SS_LightCommandRule& rule,
+    const SS_LightParamValue& param_value,
+    int channel_index,
+    std::string& out_cmd,
+    std::string& out_error) const
 {
     out_error.clear();
     out_cmd = rule.cmd_template;
@@ -55,16 +79,17 @@ bool SS_LightProtocolFactory::BuildCommand(
 
         const SS_LightPlaceholderRule& ph_rule = it->second;
 
-        std::string raw_value;
+        SS_LightParamValue scratch;
+        const SS_LightParamValue* raw_value = nullptr;
         std::string err;
-        if (!ResolveSourceValue(ph_rule.source, param_value_str, channel_index, raw_value, err))
+        if (!ResolveSourceValue(ph_rule.source, param_value, channel_index, scratch, raw_value, err))
         {
             out_error = "ResolveSourceValue failed for <" + ph_key + ">: " + err;
             return false;
         }
 
         std::string final_value;
-        if (!ApplyPlaceholderRuleString(ph_rule, raw_value, final_value, err))
+        if (!ApplyPlaceholderRuleString(ph_rule, *raw_value, final_value, err))
         {
             out_error = "ApplyPlaceholderRuleString failed for <" + ph_key + ">: " + err;
             return false;
@@ -84,7 +109,7 @@ bool SS_LightProtocolFactory::BuildCommand(
 
 bool SS_LightProtocolFactory::BuildBytesCommand(
     const SS_LightCommandRule& rule,
-    const std::string& param_value_str,
+    const SS_LightParamValue& param_value,
     int channel_index,
     std::vector<uint8_t>& out_bytes,
     std::string& out_error) const
@@ -159,15 +184,16 @@ bool SS_LightProtocolFactory::BuildBytesCommand(
 
         const SS_LightPlaceholderRule& ph_rule = it->second;
 
-        std::string raw_value;
+        SS_LightParamValue scratch;
+        const SS_LightParamValue* raw_value = nullptr;
         std::string err;
-        if (!ResolveSourceValue(ph_rule.source, param_value_str, channel_index, raw_value, err))
+        if (!ResolveSourceValue(ph_rule.source, param_value, channel_index, scratch, raw_value, err))
         {
             out_error = "ResolveSourceValue failed for <" + ph_key + ">: " + err;
             return false;
         }
 
-        if (!ApplyPlaceholderRuleBytes(ph_rule, raw_value, out_bytes, err))
+        if (!ApplyPlaceholderRuleBytes(ph_rule, *raw_value, out_bytes, err))
         {
             out_error = "ApplyPlaceholderRuleBytes failed for <" + ph_key + ">: " + err;
             return false;
@@ -250,41 +276,36 @@ bool SS_LightProtocolFactory::ContainsPlaceholder(std::string_view tpl, std::str
 
 bool SS_LightProtocolFactory::ResolveSourceValue(
     const std::string& source,
-    const std::string& param_value_str,
+    const SS_LightParamValue& param_value,
     int channel_index,
-    std::string& out_value,
+    SS_LightParamValue& scratch,
+    const SS_LightParamValue*& out_value,
     std::string& out_error)
 {
     out_error.clear();
-    out_value.clear();
+    out_value = &scratch;
+    scratch = SS_LightParamValue{};
 
     const std::string src = ToLowerCopy(source);
 
     if (src == "param_value")
     {
-        out_value = param_value_str;
+        out_value = &param_value;
         return true;
     }
 
     // 建议：channel_num = 1-based（兼容旧 NumberToUpperAlpha 1..26）
-    if (src == "channel_num")
+    if (src == "channel_num" || src == "channel_index")
     {
-        out_value = std::to_string(channel_index + 1);
-        return true;
-    }
-
-    if (src == "channel_index")
-    {
-        out_value = std::to_string(channel_index);
+        scratch.type = SS_LIGHT_VALUE_TYPE::INT;
+        scratch.i = src == "channel_num" ? channel_index + 1 : channel_index;
+        scratch.text = std::to_string(scratch.i);
         return true;
     }
 
     // 允许 source 为空：返回空串（给 GetRawData / 固定值工具用）
     if (src.empty() || src == "empty")
-    {
-        out_value.clear();
         return true;
-    }
 
     out_error = "Unsupported placeholder source: " + source;
     return false;
@@ -292,7 +313,7 @@ bool SS_LightProtocolFactory::ResolveSourceValue(
 
 bool SS_LightProtocolFactory::ApplyPlaceholderRuleString(
     const SS_LightPlaceholderRule& ph_rule,
-    const std::string& raw_value,
+    const SS_LightParamValue& raw_value,
     std::string& out_value,
     std::string& out_error) const
 {
@@ -323,7 +344,7 @@ bool SS_LightProtocolFactory::ApplyPlaceholderRuleString(
 
 bool SS_LightProtocolFactory::ApplyPlaceholderRuleBytes(
     const SS_LightPlaceholderRule& ph_rule,
-    const std::string& raw_value,
+    const SS_LightParamValue& raw_value,
     std::vector<uint8_t>& out_bytes,
     std::string& out_error) const
 {
@@ -411,25 +432,35 @@ bool SS_LightProtocolFactory::AppendHexBytesFromText(std::string_view text, std:
     return true;
 }
 
+bool SS_LightProtocolFactory::InputToInt64(const SS_LightParamValue& input, int64_t& out_value)
+{
+    if (input.type == SS_LIGHT_VALUE_TYPE::INT)
+    {
+        out_value = input.i;
+        return true;
+    }
+
+    const std::string v = TrimCopy(input.text);
+    auto* f = v.data();
+    auto* l = v.data() + v.size();
+    auto res = std::from_chars(f, l, out_value, 10);
+    return !v.empty() && res.ec == std::errc{} && res.ptr == l;
+}
+
 // ---------------- string tools ----------------
 
-std::string SS_LightProtocolFactory::ToolDoNothing(std::string_view input, const std::vector<std::string>&)
+std::string SS_LightProtocolFactory::ToolDoNothing(const SS_LightParamValue& input, const std::vector<std::string>&)
 {
-    return TrimCopy(input);
+    return TrimCopy(input.text);
 }
 
-std::string SS_LightProtocolFactory::ToolNumberToUpperAlpha(std::string_view input, const std::vector<std::string>& extra_param)
+std::string SS_LightProtocolFactory::ToolNumberToUpperAlpha(const SS_LightParamValue& input, const std::vector<std::string>& extra_param)
 {
-    const std::string v = TrimCopy(input);
-    if (v.empty()) throw std::runtime_error("NumberToUpperAlpha: empty input");
+    if (input.type != SS_LIGHT_VALUE_TYPE::INT && TrimCopy(input.text).empty())
+        throw std::runtime_error("NumberToUpperAlpha: empty input");
 
-    int n = 0;
-    {
-        auto* f = v.data();
-        auto* l = v.data() + v.size();
-        auto res = std::from_chars(f, l, n, 10);
-        if (res.ec != std::errc{} || res.ptr != l) throw std::runtime_error("NumberToUpperAlpha: invalid decimal");
-    }
+    int64_t n = 0;
+    if (!InputToInt64(input, n)) throw std::runtime_error("NumberToUpperAlpha: invalid decimal");
     if (n < 1 || n > 26) throw std::runtime_error("NumberToUpperAlpha: out of range [1..26]");
 
     if (extra_param.empty()) throw std::runtime_error("NumberToUpperAlpha: missing extra_param[0]=true/false");
@@ -444,9 +475,9 @@ std::string SS_LightProtocolFactory::ToolNumberToUpperAlpha(std::string_view inp
     return std::string(1, (char)(base + (n - 1)));
 }
 
-std::string SS_LightProtocolFactory::ToolNumberToFixedDec(std::string_view input, const std::vector<std::string>& extra_param)
+std::string SS_LightProtocolFactory::ToolNumberToFixedDec(const SS_LightParamValue& input, const std::vector<std::string>& extra_param)
 {
-    const std::string sv = TrimCopy(input);
+    const std::string sv = TrimCopy(input.text);
     if (sv.empty()) throw std::runtime_error("NumberToFixedDec: empty input");
     if (extra_param.empty()) throw std::runtime_error("NumberToFixedDec: missing extra_param[0]=width");
 
@@ -472,8 +503,12 @@ std::string SS_LightProtocolFactory::ToolNumberToFixedDec(std::string_view input
     }
     else digits = v;
 
-    for (unsigned char c : digits)
-        if (std::isdigit(c) == 0) throw std::runtime_error("NumberToFixedDec: invalid decimal string");
+    // INT 的 text 已是规范化十进制，不必再逐位校验
+    if (input.type != SS_LIGHT_VALUE_TYPE::INT)
+    {
+        for (unsigned char c : digits)
+            if (std::isdigit(c) == 0) throw std::runtime_error("NumberToFixedDec: invalid decimal string");
+    }
 
     if (digits.size() >= target) return sv;
 
@@ -485,9 +520,9 @@ std::string SS_LightProtocolFactory::ToolNumberToFixedDec(std::string_view input
     return out;
 }
 
-std::string SS_LightProtocolFactory::ToolGetStringMapValue(std::string_view input, const std::vector<std::string>& extra_param)
+std::string SS_LightProtocolFactory::ToolGetStringMapValue(const SS_LightParamValue& input, const std::vector<std::string>& extra_param)
 {
-    const std::string key = TrimCopy(input);
+    const std::string key = TrimCopy(input.text);
     if (key.empty()) throw std::runtime_error("GetStringMapValue: empty input");
     if (extra_param.empty()) throw std::runtime_error("GetStringMapValue: extra_param empty");
 
@@ -521,10 +556,10 @@ std::string SS_LightProtocolFactory::ToolGetStringMapValue(std::string_view inpu
     throw std::runtime_error("GetStringMapValue: no mapping for '" + key + "'");
 }
 
-std::string SS_LightProtocolFactory::ToolDigitalCharacterCalculation(std::string_view input, const std::vector<std::string>& extra_param)
+std::string SS_LightProtocolFactory::ToolDigitalCharacterCalculation(const SS_LightParamValue& input, const std::vector<std::string>& extra_param)
 {
-    const std::string lhs = TrimCopy(input);
-    if (lhs.empty()) throw std::runtime_error("DigitalCharacterCalculation: empty lhs");
+    if (input.type != SS_LIGHT_VALUE_TYPE::INT && TrimCopy(input.text).empty())
+        throw std::runtime_error("DigitalCharacterCalculation: empty lhs");
     if (extra_param.size() < 2) throw std::runtime_error("DigitalCharacterCalculation: need extra_param[0]=operand, [1]=operator");
 
     auto parse_i64 = [](const std::string& s)->std::int64_t {
@@ -536,7 +571,8 @@ std::string SS_LightProtocolFactory::ToolDigitalCharacterCalculation(std::string
         return v;
     };
 
-    const std::int64_t a = parse_i64(lhs);
+    std::int64_t a = 0;
+    if (!InputToInt64(input, a)) throw std::runtime_error("invalid integer: " + TrimCopy(input.text));
     const std::int64_t b = parse_i64(TrimCopy(extra_param[0]));
     const std::string op = ToLowerCopy(extra_param[1]);
 
@@ -593,7 +629,7 @@ std::vector<uint8_t> SS_LightProtocolFactory::HexStringToBytes(const std::string
     return bytes;
 }
 
-bool SS_LightProtocolFactory::ToolByteConversion(std::string_view input, const std::vector<std::string>& extra_param,
+bool SS_LightProtocolFactory::ToolByteConversion(const SS_LightParamValue& input, const std::vector<std::string>& extra_param,
     std::vector<uint8_t>& out_bytes, bool endian)
 {
     if (extra_param.size() < 3) throw std::runtime_error("ByteConversion: need extra_param[0]=bytes,[1]=base_hex,[2]=inc_dec");
@@ -647,9 +683,17 @@ bool SS_LightProtocolFactory::ToolByteConversion(std::string_view input, const s
 
     const uint64_t base = parse_hex_u64(extra_param[1]);
 
-    std::string inc_src = TrimCopy(input);
-    if (inc_src.empty()) inc_src = extra_param[2];
-    const uint64_t inc = parse_dec_u64(inc_src);
+    uint64_t inc = 0;
+    if (input.type == SS_LIGHT_VALUE_TYPE::INT && input.i >= 0)
+    {
+        inc = static_cast<uint64_t>(input.i);
+    }
+    else
+    {
+        std::string inc_src = TrimCopy(input.text);
+        if (inc_src.empty()) inc_src = extra_param[2];
+        inc = parse_dec_u64(inc_src);
+    }
 
     const uint64_t maxv = (nbytes == 8) ? UINT64_MAX : ((1ULL << (8 * nbytes)) - 1ULL);
     if (base > maxv) throw std::runtime_error("ByteConversion: base exceeds width");
@@ -675,7 +719,7 @@ bool SS_LightProtocolFactory::ToolByteConversion(std::string_view input, const s
     return true;
 }
 
-bool SS_LightProtocolFactory::ToolGetRawData(std::string_view, const std::vector<std::string>& extra_param,
+bool SS_LightProtocolFactory::ToolGetRawData(const SS_LightParamValue&, const std::vector<std::string>& extra_param,
     std::vector<uint8_t>& out_bytes, bool)
 {
     if (extra_param.empty()) throw std::runtime_error("GetRawData: extra_param[0] required");
@@ -685,10 +729,10 @@ bool SS_LightProtocolFactory::ToolGetRawData(std::string_view, const std::vector
 }
 
 // endian=true => BE endian=false => LE
-bool SS_LightProtocolFactory::ToolGetStringMapValueToBytes(std::string_view input, const std::vector<std::string>& extra_param,
+bool SS_LightProtocolFactory::ToolGetStringMapValueToBytes(const SS_LightParamValue& input, const std::vector<std::string>& extra_param,
     std::vector<uint8_t>& out_bytes, bool endian)
 {
-    const std::string key = ToLowerCopy(input);
+    const std::string key = ToLowerCopy(input.text);
     if (key.empty()) throw std::runtime_error("GetStringMapValueToBytes: empty input");
     if (extra_param.empty()) throw std::runtime_error("GetStringMapValueToBytes: extra_param empty");
 
@@ -722,5 +766,5 @@ bool SS_LightProtocolFactory::ToolGetStringMapValueToBytes(std::string_view inpu
         }
     }
 
-    throw std::runtime_error("GetStringMapValueToBytes: no mapping for '" + std::string(input) + "'");
+    throw std::runtime_error("GetStringMapValueToBytes: no mapping for '" + input.text + "'");
 }
\ No newline at end of file
@@ -15,15 +15,31 @@ public:
     SS_LightProtocolFactory();
 
     // STRING 协议：输出字符串命令（<xxx> 替换回字符串）
+    // param_value 已按 value_type 解析：数值类工具直接用 param_value.i，不再重复解析字符串
     bool BuildCommand(
         const SS_LightCommandRule& rule,
-        const std::string& param_value_str,
+        const SS_LightParamValue& param_value,
         int channel_index,
         std::string& out_cmd,
         std::string& out_error) const;
 
     // BYTE 协议：输出字节命令（pipeline：按 <xxx> 顺序把 bytes 追加到 out_bytes）
     // 重要约定：这里输出的是“裸 PDU”（不包含地址/MBAP/CRC），这些由 transmission wrapper 统一加
+    bool BuildBytesCommand(
+        const SS_LightCommandRule& rule,
+        const SS_LightParamValue& param_value,
+        int channel_index,
+        std::vector<uint8_t>& out_bytes,
+        std::string& out_error) const;
+
+    // 兼容：未解析的字符串值（按 UNKNOWN 类型处理，工具内部自行解析）
+    bool BuildCommand(
+        const SS_LightCommandRule& rule,
+        const std::string& param_value_str,
+        int channel_index,
+        std::string& out_cmd,
+        std::string& out_error) const;
+
     bool BuildBytesCommand(
         const SS_LightCommandRule& rule,
         const std::string& param_value_str,
@@ -43,50 +59,55 @@ private:
     static bool ContainsPlaceholder(std::string_view tpl, std::string_view name);
 
     // 从 source 解析 raw_value：param_value/channel_num/channel_index/empty
+    // param_value 直接指向入参；通道号等生成到 scratch（INT 类型）
     static bool ResolveSourceValue(
         const std::string& source,
-        const std::string& param_value_str,
+        const SS_LightParamValue& param_value,
         int channel_index,
-        std::string& out_value,
+        SS_LightParamValue& scratch,
+        const SS_LightParamValue*& out_value,
         std::string& out_error);
 
     bool ApplyPlaceholderRuleString(
         const SS_LightPlaceholderRule& ph_rule,
-        const std::string& raw_value,
+        const SS_LightParamValue& raw_value,
         std::string& out_value,
         std::string& out_error) const;
 
     bool ApplyPlaceholderRuleBytes(
         const SS_LightPlaceholderRule& ph_rule,
-        const std::string& raw_value,
+        const SS_LightParamValue& raw_value,
         std::vector<uint8_t>& out_bytes,
         std::string& out_error) const;
 
+    // 工具输入取整数：已解析的 INT 直接用，否则按十进制解析 text（失败返回 false）
+    static bool InputToInt64(const SS_LightParamValue& input, int64_t& out_value);
+
     // BYTE 模板辅助：把模板中“普通段落”解析为 hex 字节追加
     static bool AppendHexBytesFromText(std::string_view text, std::vector<uint8_t>& out_bytes, std::string& out_error);
 
     // ---- tools (string) ----
-    static std::string ToolDoNothing(std::string_view input, const std::vector<std::string>& extra_param);
-    static std::string ToolNumberToUpperAlpha(std::string_view input, const std::vector<std::string>& extra_param);
-    static std::string ToolNumberToFixedDec(std::string_view input, const std::vector<std::string>& extra_param);
-    static std::string ToolGetStringMapValue(std::string_view input, const std::vector<std::string>& extra_param);
-    static std::string ToolDigitalCharacterCalculation(std::string_view input, const std::vector<std::string>& extra_param);
+    static std::string ToolDoNothing(const SS_LightParamValue& input, const std::vector<std::string>& extra_param);
+    static std::string ToolNumberToUpperAlpha(const SS_LightParamValue& input, const std::vector<std::string>& extra_param);
+    static std::string ToolNumberToFixedDec(const SS_LightParamValue& input, const std::vector<std::string>& extra_param);
+    static std::string ToolGetStringMapValue(const SS_LightParamValue& input, const std::vector<std::string>& extra_param);
+    static std::string ToolDigitalCharacterCalculation(const SS_LightParamValue& input, const std::vector<std::string>& extra_param);
 
     // ---- tools (bytes) ----
     static std::vector<uint8_t> HexStringToBytes(const std::string& hex_str);
 
-    static bool ToolByteConversion(std::string_view input, const std::vector<std::string>& extra_param,
+    static bool ToolByteConversion(const SS_LightParamValue& input, const std::vector<std::string>& extra_param,
         std::vector<uint8_t>& out_bytes, bool endian);
 
-    static bool ToolGetRawData(std::string_view input, const std::vector<std::string>& extra_param,
+    static bool ToolGetRawData(const SS_LightParamValue& input, const std::vector<std::string>& extra_param,
         std::vector<uint8_t>& out_bytes, bool endian);
 
-    static bool ToolGetStringMapValueToBytes(std::string_view input, const std::vector<std::string>& extra_param,
+    static bool ToolGetStringMapValueToBytes(const SS_LightParamValue& input, const std::vector<std::string>& extra_param,
         std::vector<uint8_t>& out_bytes, bool endian);
 
 private:
-    using StringToolFn = std::function<std::string(std::string_view input, const std::vector<std::string>& extra_param)>;
-    using BytesToolFn = std::function<bool(std::string_view input, const std::vector<std::string>& extra_param, std::vector<uint8_t>& out_bytes, bool endian)>;
+    using StringToolFn = std::function<std::string(const SS_LightParamValue& input, const std::vector<std::string>& extra_param)>;
+    using BytesToolFn = std::function<bool(const SS_LightParamValue& input, const std::vector<std::string>& extra_param, std::vector<uint8_t>& out_bytes, bool endian)>;
 
     std::unordered_map<std::string, StringToolFn> string_tool_map_;
     std::unordered_map<std::string, BytesToolFn>  bytes_tool_map_;
@@ -0,0 +1,855 @@
+// ss_light_resource_serial_bus.cpp
+#include "ss_light_resource_serial_bus.h"
+
+#include <sstream>
+#include <cctype>
+#include <algorithm>
+
+#include "../../include/Communication_Library/ss_communicate_interface.h"
+#include "../../include/Communication_Library/ss_communicate_library.h"
+
+#include "ss_light_resource_connection_stats.h"
+
+static std::string NormalizePortKey_(const std::string& s)
+{
+    std::string out;
+    out.reserve(s.size());
+    for (unsigned char c : s)
+    {
+        if (std::isspace(c)) continue;
+        out.push_back(static_cast<char>(std::toupper(c)));
+    }
+    return out;
+}
+
+static std::string ToLowerCopy_(const std::string& s)
+{
+    std::string out;
+    out.reserve(s.size());
+    for (unsigned char c : s) out.push_back(static_cast<char>(std::tolower(c)));
+    return out;
+}
+
+// ============================
+// SS_LightSerialBus
+// ============================
+
+// 当前线程正在执行回调的 endpoint（可嵌套）；Detach 不等本线程自己的派发
+static thread_local std::vector<const SS_LightSerialBus::Endpoint*> t_dispatching;
+
+std::shared_ptr<SS_LightSerialBus> SS_LightSerialBus::Acquire(const std::string& com_port_num)
+{
+    static std::mutex s_mtx;
+    static std::unordered_map<std::string, std::weak_ptr<SS_LightSerialBus>> s_buses;
+
+    const std::string key = NormalizePortKey_(com_port_num);
+
+    std::lock_guard<std::mutex> lk(s_mtx);
+
+    // 顺手清理已经释放的总线
+    for (auto it = s_buses.begin(); it != s_buses.end();)
+    {
+        if (it->second.expired()) it = s_buses.erase(it);
+        else ++it;
+    }
+
+    auto it = s_buses.find(key);
+    if (it != s_buses.end())
+    {
+        if (auto sp = it->second.lock())
+            return sp;
+    }
+
+    std::shared_ptr<SS_LightSerialBus> bus(new SS_LightSerialBus(com_port_num), &SS_LightSerialBus::Release_);
+    s_buses[key] = bus;
+    return bus;
+}
+
+void SS_LightSerialBus::Release_(SS_LightSerialBus* bus)
+{
+    // 回调里 Disconnect 释放了最后一个引用：当前线程就是 worker 或串口读线程，析构不能在这里 join
+    if (!t_dispatching.empty() || std::this_thread::get_id() == bus->worker_.get_id())
+    {
+        std::thread([bus]() { delete bus; }).detach();
+        return;
+    }
+    delete bus;
+}
+
+SS_LightSerialBus::SS_LightSerialBus(std::string com_port_num)
+    : com_port_num_(std::move(com_port_num))
+{
+    worker_ = std::thread(&SS_LightSerialBus::WorkerLoop_, this);
+}
+
+SS_LightSerialBus::~SS_LightSerialBus()
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (worker_.joinable())
+        worker_.join();
+
+    open_.store(false);
+    if (comm_)
+    {
+        comm_->Disconnect();
+        comm_.reset(); // 这里会 join 串口读线程
+    }
+}
+
+bool SS_LightSerialBus::Open(const SS_LightSerialConfig& cfg, std::string& out_error)
+{
+    out_error.clear();
+
+    // 并发连接时同一总线上的多个实例可能同时打开串口
+    std::lock_guard<std::mutex> olk(open_mtx_);
+
+    if (open_.load())
+    {
+        if (!SameSerialConfig_(cfg_, cfg))
+        {
+            out_error = "SerialBus: " + com_port_num_ +
+                " is already opened with different serial parameters (baud/data/stop/parity).";
+            return false;
+        }
+        return true;
+    }
+
+    if (cfg.com_port_num.empty())
+    {
+        out_error = "SerialBus: com_port_num is empty.";
+        return false;
+    }
+    if (cfg.baud_rate <= 0)
+    {
+        out_error = "SerialBus: baud_rate is invalid.";
+        return false;
+    }
+
+    if (!comm_)
+    {
+        comm_ = CommunicateLibrary::Instance().CreateCommunicateFactory(CommunicateType::SERIAL);
+        if (!comm_)
+        {
+            out_error = "SerialBus: CreateCommunicateFactory failed (nullptr).";
+            return false;
+        }
+        comm_->Init();
+
+        // 直接在池化缓冲上解析，不经过 vector 拷贝
+        comm_->SetRxBufferCallback([this](const std::string& /*port*/, const CommunicateRxBufferPtr& buffer) {
+            if (!buffer || buffer->empty()) return;
+            OnRxBytes_(reinterpret_cast<const uint8_t*>(buffer->data()), buffer->size());
+        });
+
+        comm_->SetErrorCallback([this](int code, const std::string& msg) {
+            OnCommError_(code, msg);
+        });
+    }
+
+    ConnectionInfo ci;
+    ci.com_port_ = cfg.com_port_num;
+    ci.baud_rate_ = cfg.baud_rate;
+    ci.character_size_ = cfg.character_size > 0 ? cfg.character_size : 8;
+    ci.stop_bits_ = cfg.stop_bits > 0 ? cfg.stop_bits : 1;
+    ci.parity_ = cfg.parity;
+
+    if (!comm_->Connect(ci))
+    {
+        out_error = "SerialBus: open " + cfg.com_port_num + " failed.";
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        cfg_ = cfg;
+        parser_.Reset();
+    }
+    open_.store(true);
+    return true;
+}
+
+void SS_LightSerialBus::Attach(const std::shared_ptr<Endpoint>& ep)
+{
+    if (!ep) return;
+    std::lock_guard<std::mutex> lk(mtx_);
+    for (const auto& e : endpoints_)
+        if (e == ep) return;
+    endpoints_.push_back(ep);
+}
+
+void SS_LightSerialBus::Detach(const std::shared_ptr<Endpoint>& ep)
+{
+    if (!ep) return;
+
+    std::unique_lock<std::mutex> lk(mtx_);
+
+    for (size_t i = 0; i < endpoints_.size(); ++i)
+    {
+        if (endpoints_[i] != ep) continue;
+        endpoints_.erase(endpoints_.begin() + static_cast<std::ptrdiff_t>(i));
+        if (rr_cursor_ > i) --rr_cursor_;
+        if (rr_cursor_ >= endpoints_.size()) rr_cursor_ = 0;
+        break;
+    }
+
+    ep->pending.clear();
+    ep->detached = true;
+    ep->rx_cb = nullptr;
+    ep->disc_cb = nullptr;
+    ep->err_cb = nullptr;
+
+    if (outstanding_ == ep)
+    {
+        outstanding_.reset();
+        reply_arrived_ = true;
+        cv_.notify_all();
+    }
+
+    // 等其它线程上正在执行的回调结束（回调捕获了 transport 的 this）；
+    // 本线程正在执行的（回调里 Disconnect）不等，否则自锁
+    const int self = static_cast<int>(std::count(t_dispatching.begin(), t_dispatching.end(), ep.get()));
+    dispatch_cv_.wait(lk, [&] { return ep->in_flight <= self; });
+}
+
+bool SS_LightSerialBus::Submit(const std::shared_ptr<Endpoint>& ep, const std::vector<uint8_t>& bytes, std::string& out_error)
+{
+    out_error.clear();
+
+    if (!ep)
+    {
+        out_error = "SerialBus: endpoint is null.";
+        return false;
+    }
+    if (!open_.load())
+    {
+        out_error = "SerialBus: " + com_port_num_ + " is not open.";
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        ep->pending.push_back(bytes);
+    }
+    cv_.notify_all();
+    return true;
+}
+
+bool SS_LightSerialBus::PickNext_(std::shared_ptr<Endpoint>& out_ep, std::vector<uint8_t>& out_bytes)
+{
+    // 调用方持有 mtx_
+    const size_t n = endpoints_.size();
+    for (size_t k = 0; k < n; ++k)
+    {
+        const size_t i = (rr_cursor_ + k) % n;
+        auto& ep = endpoints_[i];
+        if (ep->pending.empty()) continue;
+
+        out_ep = ep;
+        out_bytes = std::move(ep->pending.front());
+        ep->pending.pop_front();
+
+        // 下一轮从下一个设备开始，保证多设备公平
+        rr_cursor_ = (i + 1) % n;
+        return true;
+    }
+    return false;
+}
+
+int64_t SS_LightSerialBus::ComputeCharTimeUs(const SS_LightSerialConfig& cfg)
+{
+    if (cfg.baud_rate <= 0) return 0;
+
+    // 起始位 + 数据位 + 校验位 + 停止位
+    const int data_bits = cfg.character_size > 0 ? cfg.character_size : 8;
+    const int parity_bits = cfg.parity != 0 ? 1 : 0;
+    const int stop_bits = cfg.stop_bits > 0 ? cfg.stop_bits : 1;
+    const int64_t bits = 1 + data_bits + parity_bits + stop_bits;
+
+    // 向上取整，宁可多等不可溢出
+    return (bits * 1000000 + cfg.baud_rate - 1) / cfg.baud_rate;
+}
+
+int64_t SS_LightSerialBus::ComputeWireTimeUs(const SS_LightSerialConfig& cfg, size_t bytes)
+{
+    return ComputeCharTimeUs(cfg) * static_cast<int64_t>(bytes);
+}
+
+size_t SS_LightSerialBus::ExpectedReplyBytes(const std::vector<uint8_t>& request)
+{
+    constexpr size_t kMaxRtuFrame = 256;
+    if (request.size() < 8)
+        return kMaxRtuFrame;
+
+    // 地址 + 功能码 + 字节数 + 数据 + CRC
+    const uint8_t fc = request[1];
+    const size_t quantity = (static_cast<size_t>(request[4]) << 8) | request[5];
+    switch (fc)
+    {
+    case 0x01:
+    case 0x02:
+        return std::min(kMaxRtuFrame, 5 + (quantity + 7) / 8);
+    case 0x03:
+    case 0x04:
+        return std::min(kMaxRtuFrame, 5 + quantity * 2);
+    case 0x05:
+    case 0x06:
+    case 0x0F:
+    case 0x10:
+        return 8; // 写操作回显地址/数量
+    default:
+        return kMaxRtuFrame;
+    }
+}
+
+int64_t SS_LightSerialBus::EffectiveGapUs_(const Endpoint& ep) const
+{
+    // 调用方持有 mtx_
+    int64_t gap = ep.inter_command_gap_us > 0 ? ep.inter_command_gap_us : 0;
+
+    // Modbus RTU 帧间至少 3.5 个字符的静默
+    if (ToLowerCopy_(ep.byte_params.tail_check_type) == "crc_16_modbus")
+    {
+        const int64_t t35 = (ComputeCharTimeUs(cfg_) * 7 + 1) / 2;
+        if (gap < t35) gap = t35;
+    }
+    return gap;
+}
+
+void SS_LightSerialBus::WorkerLoop_()
+{
+    using Clock = std::chrono::steady_clock;
+
+    while (true)
+    {
+        std::shared_ptr<Endpoint> ep;
+        std::vector<uint8_t> bytes;
+
+        {
+            std::unique_lock<std::mutex> lk(mtx_);
+            cv_.wait(lk, [this] {
+                if (stop_) return true;
+                for (const auto& e : endpoints_)
+                    if (!e->pending.empty()) return true;
+                return false;
+            });
+            if (stop_) break;
+
+            if (!PickNext_(ep, bytes))
+                continue;
+
+            // 帧先取出备好，线路一空闲立刻写出
+            cv_.wait_until(lk, next_write_at_, [this] { return stop_; });
+            if (stop_) break;
+
+            // 等待期间可能已经 Detach
+            bool attached = false;
+            for (const auto& e : endpoints_)
+                if (e == ep) { attached = true; break; }
+            if (!attached)
+                continue;
+
+            // 先登记 outstanding，再写串口，避免应答先于登记到达
+            outstanding_ = ep->expect_reply ? ep : nullptr;
+            reply_arrived_ = false;
+        }
+
+        std::shared_ptr<CommunicateInterface> comm = comm_;
+        const int64_t n = (comm && open_.load())
+            ? comm->WriteData(reinterpret_cast<const char*>(bytes.data()), static_cast<int64_t>(bytes.size()))
+            : -1;
+
+        if (n < 0 || n != static_cast<int64_t>(bytes.size()))
+        {
+            {
+                std::lock_guard<std::mutex> lk(mtx_);
+                outstanding_.reset();
+            }
+
+            std::ostringstream oss;
+            oss << "SerialBus: write failed on " << com_port_num_
+                << ", write_size=" << n << ", expect=" << bytes.size();
+            DispatchError_(ep, 2004, oss.str(), false);
+            continue;
+        }
+
+        // WriteData 返回只代表进了驱动缓冲，按波特率推算真正上线/下线时刻
+        Clock::time_point wire_end;
+        std::chrono::microseconds gap{ 0 };
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+
+            const auto now = Clock::now();
+            const auto wire_start = now > line_idle_at_ ? now : line_idle_at_;
+            wire_end = wire_start + std::chrono::microseconds(ComputeWireTimeUs(cfg_, bytes.size()));
+            gap = std::chrono::microseconds(EffectiveGapUs_(*ep));
+
+            line_idle_at_ = wire_end + gap;
+
+            // 无间隔且不等应答：下一帧在本帧上线时就写入驱动，紧贴着发出（最多排队一帧）
+            if (gap.count() == 0 && !ep->expect_reply)
+                next_write_at_ = wire_start;
+            else
+                next_write_at_ = line_idle_at_;
+        }
+
+        if (!ep->expect_reply)
+            continue;
+
+        bool timed_out = false;
+        bool garbled = false;
+        {
+            std::unique_lock<std::mutex> lk(mtx_);
+
+            // 应答超时从应答按期望长度在线上收完时开始计：低波特率下长应答本身就要上百毫秒
+            const auto reply_wire = std::chrono::microseconds(ComputeWireTimeUs(cfg_, ExpectedReplyBytes(bytes)));
+            const auto deadline = wire_end + reply_wire + std::chrono::milliseconds(ep->reply_timeout_ms);
+            cv_.wait_until(lk, deadline, [this] { return stop_ || reply_arrived_; });
+            timed_out = !stop_ && !reply_arrived_;
+            outstanding_.reset();
+
+            // 超时时缓存里仍有残留：应答到了但校验/成帧失败；丢掉残留，避免污染下一帧
+            if (timed_out && parser_.BufferedSize() > 0)
+            {
+                garbled = true;
+                parser_.Reset();
+            }
+
+            // 应答结束后同样要留出帧间隔
+            const auto idle = Clock::now() + gap;
+            if (idle > line_idle_at_) line_idle_at_ = idle;
+            next_write_at_ = line_idle_at_;
+        }
+
+        if (timed_out)
+        {
+            if (garbled)
+                DispatchError_(ep, 2006, "SerialBus: reply CRC/framing error on " + com_port_num_ +
+                    ", device_address=" + std::to_string(ep->device_address), false);
+            else
+                DispatchError_(ep, 2005, "SerialBus: reply timeout on " + com_port_num_ +
+                    ", device_address=" + std::to_string(ep->device_address), false);
+        }
+    }
+}
+
+void SS_LightSerialBus::OnRxBytes_(const uint8_t* data, size_t len)
+{
+    // (endpoint, bytes) 在锁外派发
+    std::vector<std::pair<std::shared_ptr<Endpoint>, std::vector<uint8_t>>> deliveries;
+
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+
+        SS_LightByteTransmissionParams params;
+        if (SelectParserParams_(params))
+        {
+            std::vector<std::vector<uint8_t>> frames;
+            std::string err;
+            parser_.Feed(data, len, params, frames, err);
+
+            for (auto& f : frames)
+            {
+                if (f.empty()) continue;
+
+                // RTU 帧首字节即设备地址
+                std::shared_ptr<Endpoint> target = FindByAddress_(f[0]);
+                if (!target) target = outstanding_;
+                if (!target) continue;
+
+                if (target == outstanding_) reply_arrived_ = true;
+                deliveries.emplace_back(target, std::move(f));
+            }
+        }
+        else
+        {
+            // 无边界能力（STRING）：交给当前请求方，没有则广播
+            std::vector<uint8_t> chunk(data, data + len);
+            if (outstanding_)
+            {
+                reply_arrived_ = true;
+                deliveries.emplace_back(outstanding_, std::move(chunk));
+            }
+            else
+            {
+                for (const auto& ep : endpoints_)
+                    deliveries.emplace_back(ep, chunk);
+            }
+        }
+    }
+
+    cv_.notify_all();
+
+    for (const auto& d : deliveries)
+        DispatchRx_(d.first, d.second);
+}
+
+void SS_LightSerialBus::OnCommError_(int code, const std::string& msg)
+{
+    std::vector<std::shared_ptr<Endpoint>> eps;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        eps = endpoints_;
+    }
+
+    std::shared_ptr<CommunicateInterface> comm = comm_;
+    const bool bus_down = open_.load() && comm && !comm->IsConnected();
+    if (bus_down)
+    {
+        open_.store(false);
+        std::lock_guard<std::mutex> lk(mtx_);
+        outstanding_.reset();
+        reply_arrived_ = true;
+        for (const auto& ep : eps) ep->pending.clear();
+    }
+    cv_.notify_all();
+
+    for (const auto& ep : eps)
+        DispatchError_(ep, code, msg.empty() && bus_down ? "serial bus closed" : msg, bus_down);
+}
+
+bool SS_LightSerialBus::BeginDispatch_(const std::shared_ptr<Endpoint>& ep)
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (!ep || ep->detached)
+            return false;
+        ++ep->in_flight;
+    }
+    t_dispatching.push_back(ep.get());
+    return true;
+}
+
+void SS_LightSerialBus::EndDispatch_(const std::shared_ptr<Endpoint>& ep)
+{
+    t_dispatching.pop_back();
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (--ep->in_flight == 0)
+        dispatch_cv_.notify_all();
+}
+
+void SS_LightSerialBus::DispatchRx_(const std::shared_ptr<Endpoint>& ep, const std::vector<uint8_t>& bytes)
+{
+    if (!BeginDispatch_(ep))
+        return;
+    SS_LightTransport::RxCallback cb;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        cb = ep->rx_cb;
+    }
+    if (cb) cb(bytes);
+    EndDispatch_(ep);
+}
+
+void SS_LightSerialBus::DispatchError_(const std::shared_ptr<Endpoint>& ep, int code, const std::string& msg, bool disconnected)
+{
+    if (!BeginDispatch_(ep))
+        return;
+    SS_LightTransport::ErrorCallback err_cb;
+    SS_LightTransport::DisconnectCallback disc_cb;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        err_cb = ep->err_cb;
+        disc_cb = ep->disc_cb;
+    }
+    if (err_cb) err_cb(code, msg);
+    // 错误回调里可能已经 Disconnect（Detach 清空了回调），断线回调以那时为准
+    if (disconnected && disc_cb)
+    {
+        bool still_attached = false;
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            still_attached = !ep->detached;
+        }
+        if (still_attached) disc_cb(msg);
+    }
+    EndDispatch_(ep);
+}
+
+std::shared_ptr<SS_LightSerialBus::Endpoint> SS_LightSerialBus::FindByAddress_(int addr) const
+{
+    for (const auto& ep : endpoints_)
+        if (ep->device_address >= 0 && ep->device_address == addr) return ep;
+    return nullptr;
+}
+
+bool SS_LightSerialBus::SelectParserParams_(SS_LightByteTransmissionParams& out_params) const
+{
+    // 优先使用当前请求方的帧格式，否则取第一个 CRC 设备
+    if (outstanding_ && ToLowerCopy_(outstanding_->byte_params.tail_check_type) == "crc_16_modbus")
+    {
+        out_params = outstanding_->byte_params;
+        return true;
+    }
+    for (const auto& ep : endpoints_)
+    {
+        if (ToLowerCopy_(ep->byte_params.tail_check_type) == "crc_16_modbus")
+        {
+            out_params = ep->byte_params;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SS_LightSerialBus::SameSerialConfig_(const SS_LightSerialConfig& a, const SS_LightSerialConfig& b)
+{
+    return a.baud_rate == b.baud_rate &&
+        a.character_size == b.character_size &&
+        a.stop_bits == b.stop_bits &&
+        a.parity == b.parity;
+}
+
+// ============================
+// SS_LightSerialBusTransport
+// ============================
+
+class SS_LightSerialBusTransport;
+
+// 当前线程正在执行回调的 transport（可嵌套）；析构不等本线程自己的回调
+static thread_local std::vector<const SS_LightSerialBusTransport*> t_publishing;
+
+class SS_LightSerialBusTransport final : public SS_LightTransport
+{
+public:
+    SS_LightSerialBusTransport(SS_LIGHT_PROTOCOL_TYPE protocol_type, const SS_LightByteTransmissionParams& byte_params,
+        int inter_command_gap_ms, int reply_timeout_ms)
+        : protocol_type_(protocol_type)
+        , byte_params_(byte_params)
+        , inter_command_gap_ms_(inter_command_gap_ms)
+        , reply_timeout_ms_(reply_timeout_ms > 0 ? reply_timeout_ms : SS_LightTemplateInfo::kDefaultReplyTimeoutMs)
+    {
+    }
+
+    ~SS_LightSerialBusTransport() override
+    {
+        Detach_();
+
+        // 回调里 Disconnect 过的话总线不再替我们等：这里等其它线程上还没返回的回调
+        std::unique_lock<std::mutex> lk(cb_mtx_);
+        rx_cb_ = nullptr;
+        disc_cb_ = nullptr;
+        err_cb_ = nullptr;
+        const int self = static_cast<int>(std::count(t_publishing.begin(), t_publishing.end(), this));
+        cb_cv_.wait(lk, [&] { return in_flight_ <= self; });
+    }
+
+    bool Connect(const SS_LightConnectionConfig& cfg, std::string& out_error) override
+    {
+        out_error.clear();
+        last_tx_.clear();
+
+        if (cfg.connect_type != SS_LIGHT_CONNECT_TYPE::SERIAL)
+        {
+            out_error = "Connect: serial bus transport requires connect_type SERIAL.";
+            PublishError_(1001, out_error);
+            return false;
+        }
+        if (cfg.serial_parameter.com_port_num.empty())
+        {
+            out_error = "Connect: invalid connection config: serial com_port_num is empty.";
+            PublishError_(1002, out_error);
+            return false;
+        }
+
+        // 重连：先从旧总线上摘下来
+        Detach_();
+
+        auto bus = SS_LightSerialBus::Acquire(cfg.serial_parameter.com_port_num);
+        if (!bus->Open(cfg.serial_parameter, out_error))
+        {
+            PublishError_(1004, out_error);
+            return false;
+        }
+
+        auto ep = std::make_shared<SS_LightSerialBus::Endpoint>();
+        ep->byte_params = byte_params_;
+        ep->inter_command_gap_us = inter_command_gap_ms_ > 0 ? inter_command_gap_ms_ * 1000 : 0;
+        ep->reply_timeout_ms = reply_timeout_ms_;
+
+        uint8_t addr = 0;
+        if (protocol_type_ == SS_LIGHT_PROTOCOL_TYPE::BYTE &&
+            SS_LightTransmissionWrapper::ParseHexByte(byte_params_.device_address, addr))
+        {
+            ep->device_address = addr;
+            ep->expect_reply = addr != 0 &&
+                ToLowerCopy_(byte_params_.tail_check_type) == "crc_16_modbus";
+        }
+
+        // Detach 会等其它线程上的回调结束，这里捕获 this 是安全的
+        ep->rx_cb = [this](const std::vector<uint8_t>& bytes) { PublishRx_(bytes); };
+        ep->err_cb = [this](int code, const std::string& msg) { PublishError_(code, msg); };
+        ep->disc_cb = [this](const std::string& reason) {
+            if (connected_.exchange(false))
+                PublishDisconnected_(reason);
+        };
+
+        bus->Attach(ep);
+
+        bus_ = std::move(bus);
+        ep_ = std::move(ep);
+        connected_.store(true);
+        return true;
+    }
+
+    void Disconnect() override
+    {
+        const bool was_connected = connected_.exchange(false);
+        Detach_();
+        if (was_connected)
+            PublishDisconnected_("manual disconnect");
+    }
+
+    bool IsConnected() const override
+    {
+        return connected_.load();
+    }
+
+    bool SendBytes(const std::vector<uint8_t>& bytes, std::string& out_error) override
+    {
+        out_error.clear();
+
+        if (!bus_ || !ep_)
+        {
+            out_error = "SendBytes: serial bus is null (not connected).";
+            PublishError_(2001, out_error);
+            return false;
+        }
+        if (!connected_.load())
+        {
+            out_error = "SendBytes: not connected.";
+            PublishError_(2002, out_error);
+            return false;
+        }
+        if (bytes.empty())
+        {
+            out_error = "SendBytes: bytes is empty.";
+            PublishError_(2003, out_error);
+            return false;
+        }
+
+        last_tx_ = bytes;
+
+        if (!bus_->Submit(ep_, bytes, out_error))
+        {
+            PublishError_(2004, out_error);
+            return false;
+        }
+        return true;
+    }
+
+    std::vector<uint8_t> GetLastTxBytes() const override
+    {
+        return last_tx_;
+    }
+
+    LinkStatsSource GetLinkStatsSource() const override
+    {
+        // 共享链路：统计为整条总线合计
+        return bus_ ? MakeLinkStatsSource(bus_->GetCommunicate(), true) : nullptr;
+    }
+
+    void SetRxCallback(RxCallback cb) override
+    {
+        std::lock_guard<std::mutex> lk(cb_mtx_);
+        rx_cb_ = std::move(cb);
+    }
+
+    void SetDisconnectedCallback(DisconnectCallback cb) override
+    {
+        std::lock_guard<std::mutex> lk(cb_mtx_);
+        disc_cb_ = std::move(cb);
+    }
+
+    void SetErrorCallback(ErrorCallback cb) override
+    {
+        std::lock_guard<std::mutex> lk(cb_mtx_);
+        err_cb_ = std::move(cb);
+    }
+
+private:
+    void Detach_()
+    {
+        if (bus_ && ep_)
+            bus_->Detach(ep_);
+        ep_.reset();
+        bus_.reset(); // 最后一个持有者释放时关闭串口
+    }
+
+    // 取出回调并登记 in_flight_；回调为空返回 false
+    template <typename Cb>
+    bool BeginPublish_(const Cb& member, Cb& out_cb)
+    {
+        {
+            std::lock_guard<std::mutex> lk(cb_mtx_);
+            if (!member) return false;
+            out_cb = member;
+            ++in_flight_;
+        }
+        t_publishing.push_back(this);
+        return true;
+    }
+
+    void EndPublish_()
+    {
+        t_publishing.pop_back();
+        std::lock_guard<std::mutex> lk(cb_mtx_);
+        if (--in_flight_ == 0)
+            cb_cv_.notify_all();
+    }
+
+    void PublishError_(int code, const std::string& msg)
+    {
+        ErrorCallback cb;
+        if (!BeginPublish_(err_cb_, cb)) return;
+        cb(code, msg);
+        EndPublish_();
+    }
+
+    void PublishDisconnected_(const std::string& reason)
+    {
+        DisconnectCallback cb;
+        if (!BeginPublish_(disc_cb_, cb)) return;
+        cb(reason);
+        EndPublish_();
+    }
+
+    void PublishRx_(const std::vector<uint8_t>& bytes)
+    {
+        RxCallback cb;
+        if (!BeginPublish_(rx_cb_, cb)) return;
+        cb(bytes);
+        EndPublish_();
+    }
+
+private:
+    SS_LIGHT_PROTOCOL_TYPE protocol_type_ = SS_LIGHT_PROTOCOL_TYPE::UNKNOWN;
+    SS_LightByteTransmissionParams byte_params_;
+    int inter_command_gap_ms_ = 0;
+    int reply_timeout_ms_ = SS_LightTemplateInfo::kDefaultReplyTimeoutMs;
+
+    std::shared_ptr<SS_LightSerialBus> bus_;
+    std::shared_ptr<SS_LightSerialBus::Endpoint> ep_;
+
+    std::atomic_bool connected_{ false };
+    std::vector<uint8_t> last_tx_;
+
+    mutable std::mutex cb_mtx_;
+    std::condition_variable cb_cv_;
+    int in_flight_ = 0;
+    RxCallback rx_cb_;
+    DisconnectCallback disc_cb_;
+    ErrorCallback err_cb_;
+};
+
+std::unique_ptr<SS_LightTransport> CreateSerialBusLightTransport(
+    SS_LIGHT_PROTOCOL_TYPE protocol_type,
+    const SS_LightByteTransmissionParams& byte_params,
+    int inter_command_gap_ms,
+    int reply_timeout_ms)
+{
+    return std::make_unique<SS_LightSerialBusTransport>(protocol_type, byte_params, inter_command_gap_ms, reply_timeout_ms);
+}
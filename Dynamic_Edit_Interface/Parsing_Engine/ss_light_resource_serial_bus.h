@@ -0,0 +1,146 @@
+// ss_light_resource_serial_bus.h
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
+
+#include "ss_light_resource_models.h"
+#include "ss_light_resource_transport.h"
+#include "ss_light_resource_frame_parser.h"
+
+class CommunicateInterface;
+
+// RS-485 总线：同一个 com_port_num 上的所有控制器共享一个串口句柄
+// - 半双工仲裁：同一时刻只有一个请求在等待应答
+// - 应答按 device_address 路由回所属 runtime
+// - 多设备之间按轮询（round-robin）公平出队
+// - 按波特率/数据位/校验/停止位推算每帧线上时间，遵守帧间隔，下一帧提前备好
+// - 回调在不持有任何总线锁时调用；回调里可以 Disconnect/移除实例（同一线程重入 Detach 不等自己）
+class SS_LightSerialBus : public std::enable_shared_from_this<SS_LightSerialBus>
+{
+public:
+    // 总线上的一个挂载点（一个 runtime 一个）
+    struct Endpoint
+    {
+        // 设备地址（RTU 帧首字节）；-1 表示无地址（STRING 协议）
+        int device_address = -1;
+
+        // 是否等待应答：BYTE + CRC_16_Modbus 且非广播地址
+        bool expect_reply = false;
+
+        SS_LightByteTransmissionParams byte_params;
+
+        // 模板要求的最小帧间隔（us）；RTU 另外保证 3.5 字符静默
+        int64_t inter_command_gap_us = 0;
+
+        // 模板 reply_timeout_ms：应答按期望长度在线上收完后再等这么久
+        int reply_timeout_ms = SS_LightTemplateInfo::kDefaultReplyTimeoutMs;
+
+        SS_LightTransport::RxCallback rx_cb;
+        SS_LightTransport::DisconnectCallback disc_cb;
+        SS_LightTransport::ErrorCallback err_cb;
+
+        std::deque<std::vector<uint8_t>> pending;
+
+        // 以下由总线 mtx_ 保护：Detach 后不再派发；in_flight 为正在执行的回调数
+        bool detached = false;
+        int in_flight = 0;
+    };
+
+    // 按串口号获取（不存在则创建）；最后一个持有者释放时关闭串口
+    static std::shared_ptr<SS_LightSerialBus> Acquire(const std::string& com_port_num);
+
+    ~SS_LightSerialBus();
+
+    // 首次打开串口；已打开时只校验参数一致
+    bool Open(const SS_LightSerialConfig& cfg, std::string& out_error);
+    bool IsOpen() const { return open_.load(); }
+
+    void Attach(const std::shared_ptr<Endpoint>& ep);
+    void Detach(const std::shared_ptr<Endpoint>& ep);
+
+    // 入队，由总线线程按仲裁顺序发出
+    bool Submit(const std::shared_ptr<Endpoint>& ep, const std::vector<uint8_t>& bytes, std::string& out_error);
+
+    // 底层串口连接（链路统计用）
+    std::shared_ptr<CommunicateInterface> GetCommunicate() const { return comm_; }
+
+    // 单字符 / n 字节在线上的时间（us），按起始位+数据位+校验位+停止位计算
+    static int64_t ComputeCharTimeUs(const SS_LightSerialConfig& cfg);
+    static int64_t ComputeWireTimeUs(const SS_LightSerialConfig& cfg, size_t bytes);
+
+    // 请求对应的应答字节数：Modbus RTU 按功能码推算，推算不了时取 RTU 最大帧长 256
+    static size_t ExpectedReplyBytes(const std::vector<uint8_t>& request);
+
+private:
+    explicit SS_LightSerialBus(std::string com_port_num);
+
+    void WorkerLoop_();
+    bool PickNext_(std::shared_ptr<Endpoint>& out_ep, std::vector<uint8_t>& out_bytes);
+
+    void OnRxBytes_(const uint8_t* data, size_t len);
+    void OnCommError_(int code, const std::string& msg);
+
+    int64_t EffectiveGapUs_(const Endpoint& ep) const;
+    std::shared_ptr<Endpoint> FindByAddress_(int addr) const;
+    bool SelectParserParams_(SS_LightByteTransmissionParams& out_params) const;
+
+    // 锁外调用 ep 的回调：mtx_ 内取出回调并登记 in_flight，结束后注销并唤醒等待的 Detach
+    void DispatchRx_(const std::shared_ptr<Endpoint>& ep, const std::vector<uint8_t>& bytes);
+    void DispatchError_(const std::shared_ptr<Endpoint>& ep, int code, const std::string& msg, bool disconnected);
+    bool BeginDispatch_(const std::shared_ptr<Endpoint>& ep);
+    void EndDispatch_(const std::shared_ptr<Endpoint>& ep);
+
+    // 总线线程（worker / 串口读线程）上的回调可能释放总线的最后一个引用，析构换到临时线程做，避免 join 自己
+    static void Release_(SS_LightSerialBus* bus);
+
+    static bool SameSerialConfig_(const SS_LightSerialConfig& a, const SS_LightSerialConfig& b);
+
+private:
+    std::string com_port_num_;
+    SS_LightSerialConfig cfg_;
+
+    std::shared_ptr<CommunicateInterface> comm_;
+    std::atomic_bool open_{ false };
+
+    // 串行化 Open
+    std::mutex open_mtx_;
+
+    // 保护 endpoints_ / outstanding_ / parser_
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+
+    // 配合 Endpoint::in_flight：Detach 等其它线程上的回调结束，避免回调落到已销毁的 transport
+    std::condition_variable dispatch_cv_;
+
+    std::vector<std::shared_ptr<Endpoint>> endpoints_;
+    size_t rr_cursor_ = 0;
+
+    // 当前等待应答的请求
+    std::shared_ptr<Endpoint> outstanding_;
+    bool reply_arrived_ = false;
+
+    // 线路调度：line_idle_at_ = 上一帧下线 + 帧间隔；next_write_at_ = 下一帧允许写入驱动的时刻
+    std::chrono::steady_clock::time_point line_idle_at_{};
+    std::chrono::steady_clock::time_point next_write_at_{};
+
+    SS_LightFrameParser parser_;
+
+    std::thread worker_;
+    bool stop_ = false;
+};
+
+// 挂到共享总线上的 transport（串口连接默认走这里）
+std::unique_ptr<SS_LightTransport> CreateSerialBusLightTransport(
+    SS_LIGHT_PROTOCOL_TYPE protocol_type,
+    const SS_LightByteTransmissionParams& byte_params,
+    int inter_command_gap_ms = 0,
+    int reply_timeout_ms = SS_LightTemplateInfo::kDefaultReplyTimeoutMs);
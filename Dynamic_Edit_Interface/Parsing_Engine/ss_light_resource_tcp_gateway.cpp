@@ -0,0 +1,711 @@
+// ss_light_resource_tcp_gateway.cpp
+#include "ss_light_resource_tcp_gateway.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "../../include/Communication_Library/ss_communicate_interface.h"
+#include "../../include/Communication_Library/ss_communicate_library.h"
+
+#include "ss_light_resource_connection_stats.h"
+
+static uint16_t ReadTxId_(const uint8_t* adu)
+{
+    return static_cast<uint16_t>((adu[0] << 8) | adu[1]);
+}
+
+static void WriteTxId_(uint8_t* adu, uint16_t txid)
+{
+    adu[0] = static_cast<uint8_t>((txid >> 8) & 0xFF);
+    adu[1] = static_cast<uint8_t>(txid & 0xFF);
+}
+
+// ============================
+// SS_LightTcpGateway
+// ============================
+
+// 当前线程正在执行回调的 endpoint（可嵌套）；Detach 不等本线程自己的派发
+static thread_local std::vector<const SS_LightTcpGateway::Endpoint*> t_dispatching;
+
+std::shared_ptr<SS_LightTcpGateway> SS_LightTcpGateway::Acquire(const std::string& ip, int port)
+{
+    static std::mutex s_mtx;
+    static std::unordered_map<std::string, std::weak_ptr<SS_LightTcpGateway>> s_gateways;
+
+    const std::string key = ip + ":" + std::to_string(port);
+
+    std::lock_guard<std::mutex> lk(s_mtx);
+
+    // 顺手清理已经释放的连接
+    for (auto it = s_gateways.begin(); it != s_gateways.end();)
+    {
+        if (it->second.expired()) it = s_gateways.erase(it);
+        else ++it;
+    }
+
+    auto it = s_gateways.find(key);
+    if (it != s_gateways.end())
+    {
+        if (auto sp = it->second.lock())
+            return sp;
+    }
+
+    std::shared_ptr<SS_LightTcpGateway> gw(new SS_LightTcpGateway(ip, port), &SS_LightTcpGateway::Release_);
+    s_gateways[key] = gw;
+    return gw;
+}
+
+void SS_LightTcpGateway::Release_(SS_LightTcpGateway* gw)
+{
+    // 回调里 Disconnect 释放了最后一个引用：当前线程就是清理线程或 TCP 读线程，析构不能在这里 join
+    if (!t_dispatching.empty() || std::this_thread::get_id() == gw->expire_thread_.get_id())
+    {
+        std::thread([gw]() { delete gw; }).detach();
+        return;
+    }
+    delete gw;
+}
+
+SS_LightTcpGateway::SS_LightTcpGateway(std::string ip, int port)
+    : ip_(std::move(ip))
+    , port_(port)
+{
+    mbap_params_.message_header_type = "ModbusTCP_MBAP";
+    expire_thread_ = std::thread(&SS_LightTcpGateway::ExpireLoop_, this);
+}
+
+SS_LightTcpGateway::~SS_LightTcpGateway()
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        stop_ = true;
+    }
+    expire_cv_.notify_all();
+    if (expire_thread_.joinable())
+        expire_thread_.join();
+
+    open_.store(false);
+    if (comm_)
+    {
+        comm_->Disconnect();
+        comm_.reset(); // 这里会 join 接收线程
+    }
+}
+
+bool SS_LightTcpGateway::Open(const SS_LightSocketConfig& cfg, std::string& out_error)
+{
+    out_error.clear();
+
+    // 并发连接时多个实例可能同时打开同一条网关连接
+    std::lock_guard<std::mutex> olk(open_mtx_);
+
+    if (open_.load())
+        return true;
+
+    if (ip_.empty())
+    {
+        out_error = "TcpGateway: destination_ip_address is empty.";
+        return false;
+    }
+    if (port_ <= 0 || port_ > 65535)
+    {
+        out_error = "TcpGateway: destination_port is invalid.";
+        return false;
+    }
+
+    if (!comm_)
+    {
+        comm_ = CommunicateLibrary::Instance().CreateCommunicateFactory(CommunicateType::TCP_CLIENT);
+        if (!comm_)
+        {
+            out_error = "TcpGateway: CreateCommunicateFactory failed (nullptr).";
+            return false;
+        }
+        comm_->Init();
+
+        // 直接在池化缓冲上解析，不经过 vector 拷贝
+        comm_->SetRxBufferCallback([this](const std::string& /*ip*/, const CommunicateRxBufferPtr& buffer) {
+            if (!buffer || buffer->empty()) return;
+            OnRxBytes_(reinterpret_cast<const uint8_t*>(buffer->data()), buffer->size());
+        });
+
+        comm_->SetErrorCallback([this](int code, const std::string& msg) {
+            OnCommError_(code, msg);
+        });
+    }
+
+    ConnectionInfo ci;
+    ci.ip_ = ip_;
+    ci.port_ = port_;
+
+    // 共享连接：以首个打开者的延迟配置为准
+    const auto& lp = cfg.latency_profile;
+    ci.tcp_no_delay_ = lp.tcp_no_delay;
+    ci.tcp_quick_ack_ = lp.tcp_quick_ack;
+    ci.socket_priority_ = lp.socket_priority;
+    ci.busy_poll_us_ = lp.busy_poll_us;
+    ci.send_buffer_size_ = lp.send_buffer_size;
+    ci.recv_buffer_size_ = lp.recv_buffer_size;
+    ci.io_cpu_affinity_ = lp.io_cpu_affinity;
+    ci.connect_timeout_ms_ = cfg.connect_timeout_ms;
+
+    if (!comm_->Connect(ci))
+    {
+        out_error = "TcpGateway: connect " + ip_ + ":" + std::to_string(port_) + " failed.";
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        parser_.Reset();
+        pending_.clear();
+    }
+    open_.store(true);
+    return true;
+}
+
+void SS_LightTcpGateway::Attach(const std::shared_ptr<Endpoint>& ep)
+{
+    if (!ep) return;
+    std::lock_guard<std::mutex> lk(mtx_);
+    for (const auto& e : endpoints_)
+        if (e == ep) return;
+    endpoints_.push_back(ep);
+}
+
+void SS_LightTcpGateway::Detach(const std::shared_ptr<Endpoint>& ep)
+{
+    if (!ep) return;
+
+    std::unique_lock<std::mutex> lk(mtx_);
+
+    for (size_t i = 0; i < endpoints_.size(); ++i)
+    {
+        if (endpoints_[i] != ep) continue;
+        endpoints_.erase(endpoints_.begin() + static_cast<std::ptrdiff_t>(i));
+        break;
+    }
+
+    for (auto it = pending_.begin(); it != pending_.end();)
+    {
+        if (it->second.ep.lock() == ep) it = pending_.erase(it);
+        else ++it;
+    }
+
+    ep->detached = true;
+    ep->rx_cb = nullptr;
+    ep->disc_cb = nullptr;
+    ep->err_cb = nullptr;
+
+    // 等其它线程上正在执行的回调结束（回调捕获了 transport 的 this）；
+    // 本线程正在执行的（回调里 Disconnect）不等，否则自锁
+    const int self = static_cast<int>(std::count(t_dispatching.begin(), t_dispatching.end(), ep.get()));
+    dispatch_cv_.wait(lk, [&] { return ep->in_flight <= self; });
+}
+
+bool SS_LightTcpGateway::Submit(const std::shared_ptr<Endpoint>& ep, const std::vector<uint8_t>& adu, std::string& out_error)
+{
+    out_error.clear();
+
+    if (!ep)
+    {
+        out_error = "TcpGateway: endpoint is null.";
+        return false;
+    }
+    if (!open_.load())
+    {
+        out_error = "TcpGateway: " + ip_ + ":" + std::to_string(port_) + " is not connected.";
+        return false;
+    }
+    if (adu.size() < 8)
+    {
+        out_error = "TcpGateway: MBAP frame too short.";
+        return false;
+    }
+
+    std::vector<uint8_t> wire = adu;
+    uint16_t wire_txid = 0;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+
+        // 连接内分配 txid，跳过仍在途的值；全部在途时不能覆盖别人的登记
+        bool found = false;
+        for (size_t guard = 0; guard <= 0xFFFF; ++guard)
+        {
+            wire_txid = ++next_txid_;
+            if (pending_.find(wire_txid) == pending_.end())
+            {
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+        {
+            out_error = "TcpGateway: no free transaction id on " + ip_ + ":" + std::to_string(port_) +
+                " (" + std::to_string(pending_.size()) + " requests in flight).";
+            return false;
+        }
+
+        const bool was_idle = pending_.empty();
+
+        PendingTx p;
+        p.ep = ep;
+        p.original_txid = ReadTxId_(adu.data());
+        p.sent_at = std::chrono::steady_clock::now();
+        pending_[wire_txid] = p;
+
+        // 清理线程空闲时在睡眠，有了在途请求再叫醒它计时
+        if (was_idle)
+            expire_cv_.notify_all();
+    }
+    WriteTxId_(wire.data(), wire_txid);
+
+    std::shared_ptr<CommunicateInterface> comm = comm_;
+    int64_t n = -1;
+    {
+        std::lock_guard<std::mutex> wlk(write_mtx_);
+        if (comm)
+            n = comm->WriteData(reinterpret_cast<const char*>(wire.data()), static_cast<int64_t>(wire.size()));
+    }
+
+    if (n < 0 || n != static_cast<int64_t>(wire.size()))
+    {
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            pending_.erase(wire_txid);
+        }
+
+        std::ostringstream oss;
+        oss << "TcpGateway: write failed on " << ip_ << ":" << port_
+            << ", write_size=" << n << ", expect=" << wire.size();
+        out_error = oss.str();
+        return false;
+    }
+
+    return true;
+}
+
+void SS_LightTcpGateway::OnRxBytes_(const uint8_t* data, size_t len)
+{
+    // (endpoint, bytes) 在锁外派发
+    std::vector<std::pair<std::shared_ptr<Endpoint>, std::vector<uint8_t>>> deliveries;
+
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+
+        std::vector<std::vector<uint8_t>> frames;
+        std::string err;
+        parser_.Feed(data, len, mbap_params_, frames, err);
+
+        for (auto& f : frames)
+        {
+            if (f.size() < 8) continue;
+
+            std::shared_ptr<Endpoint> target;
+
+            auto it = pending_.find(ReadTxId_(f.data()));
+            if (it != pending_.end())
+            {
+                target = it->second.ep.lock();
+                // 还原为发送方看到的 txid
+                WriteTxId_(f.data(), it->second.original_txid);
+                pending_.erase(it);
+            }
+
+            if (!target)
+                target = FindByUnitId_(f[6]);
+
+            if (target)
+            {
+                deliveries.emplace_back(target, std::move(f));
+            }
+            else
+            {
+                // 无主应答：广播，保持与独占连接时一致的可见性
+                for (const auto& ep : endpoints_)
+                    deliveries.emplace_back(ep, f);
+            }
+        }
+    }
+
+    for (const auto& d : deliveries)
+        DispatchRx_(d.first, d.second);
+}
+
+void SS_LightTcpGateway::OnCommError_(int code, const std::string& msg)
+{
+    std::vector<std::shared_ptr<Endpoint>> eps;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        eps = endpoints_;
+    }
+
+    std::shared_ptr<CommunicateInterface> comm = comm_;
+    const bool link_down = open_.load() && comm && !comm->IsConnected();
+    if (link_down)
+    {
+        open_.store(false);
+        std::lock_guard<std::mutex> lk(mtx_);
+        pending_.clear();
+        parser_.Reset();
+    }
+
+    for (const auto& ep : eps)
+        DispatchError_(ep, code, msg.empty() && link_down ? "gateway connection closed" : msg, link_down);
+}
+
+void SS_LightTcpGateway::ExpireLoop_()
+{
+    // 不依赖后续流量：没有新请求时超时也能按时上报
+    const auto tick = std::chrono::milliseconds(std::max(kPendingExpireMs / 5, 1));
+
+    std::unique_lock<std::mutex> lk(mtx_);
+    while (!stop_)
+    {
+        if (pending_.empty())
+            expire_cv_.wait(lk, [&] { return stop_ || !pending_.empty(); });
+        else
+            expire_cv_.wait_for(lk, tick, [&] { return stop_; });
+        if (stop_) break;
+
+        std::vector<std::shared_ptr<Endpoint>> timed_out;
+        PurgeExpired_(std::chrono::steady_clock::now(), timed_out);
+        if (timed_out.empty()) continue;
+
+        lk.unlock();
+        for (const auto& ep : timed_out)
+            DispatchError_(ep, 2005, "TcpGateway: reply timeout on " + ip_ + ":" + std::to_string(port_) +
+                ", unit_id=" + std::to_string(ep->unit_id), false);
+        lk.lock();
+    }
+}
+
+void SS_LightTcpGateway::PurgeExpired_(
+    std::chrono::steady_clock::time_point now,
+    std::vector<std::shared_ptr<Endpoint>>& out_timed_out)
+{
+    // 调用方持有 mtx_
+    const auto expire = std::chrono::milliseconds(kPendingExpireMs);
+    for (auto it = pending_.begin(); it != pending_.end();)
+    {
+        std::shared_ptr<Endpoint> ep = it->second.ep.lock();
+        if (!ep)
+        {
+            it = pending_.erase(it);
+        }
+        else if (now - it->second.sent_at > expire)
+        {
+            out_timed_out.push_back(std::move(ep));
+            it = pending_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+std::shared_ptr<SS_LightTcpGateway::Endpoint> SS_LightTcpGateway::FindByUnitId_(int unit_id) const
+{
+    std::shared_ptr<Endpoint> found;
+    for (const auto& ep : endpoints_)
+    {
+        if (ep->unit_id != unit_id) continue;
+        if (found) return nullptr; // 多个实例共用一个 UnitId 时无法判定
+        found = ep;
+    }
+    return found;
+}
+
+bool SS_LightTcpGateway::BeginDispatch_(const std::shared_ptr<Endpoint>& ep)
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (!ep || ep->detached)
+            return false;
+        ++ep->in_flight;
+    }
+    t_dispatching.push_back(ep.get());
+    return true;
+}
+
+void SS_LightTcpGateway::EndDispatch_(const std::shared_ptr<Endpoint>& ep)
+{
+    t_dispatching.pop_back();
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (--ep->in_flight == 0)
+        dispatch_cv_.notify_all();
+}
+
+void SS_LightTcpGateway::DispatchRx_(const std::shared_ptr<Endpoint>& ep, const std::vector<uint8_t>& bytes)
+{
+    if (!BeginDispatch_(ep))
+        return;
+    SS_LightTransport::RxCallback cb;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        cb = ep->rx_cb;
+    }
+    if (cb) cb(bytes);
+    EndDispatch_(ep);
+}
+
+void SS_LightTcpGateway::DispatchError_(const std::shared_ptr<Endpoint>& ep, int code, const std::string& msg, bool disconnected)
+{
+    if (!BeginDispatch_(ep))
+        return;
+    SS_LightTransport::ErrorCallback err_cb;
+    SS_LightTransport::DisconnectCallback disc_cb;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        err_cb = ep->err_cb;
+        disc_cb = ep->disc_cb;
+    }
+    if (err_cb) err_cb(code, msg);
+    // 错误回调里可能已经 Disconnect（Detach 清空了回调），断线回调以那时为准
+    if (disconnected && disc_cb)
+    {
+        bool still_attached = false;
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            still_attached = !ep->detached;
+        }
+        if (still_attached) disc_cb(msg);
+    }
+    EndDispatch_(ep);
+}
+
+// ============================
+// SS_LightTcpGatewayTransport
+// ============================
+
+class SS_LightTcpGatewayTransport;
+
+// 当前线程正在执行回调的 transport（可嵌套）；析构不等本线程自己的回调
+static thread_local std::vector<const SS_LightTcpGatewayTransport*> t_publishing;
+
+class SS_LightTcpGatewayTransport final : public SS_LightTransport
+{
+public:
+    explicit SS_LightTcpGatewayTransport(const SS_LightByteTransmissionParams& byte_params)
+        : byte_params_(byte_params)
+    {
+    }
+
+    ~SS_LightTcpGatewayTransport() override
+    {
+        Detach_();
+
+        // 回调里 Disconnect 过的话网关不再替我们等：这里等其它线程上还没返回的回调
+        std::unique_lock<std::mutex> lk(cb_mtx_);
+        rx_cb_ = nullptr;
+        disc_cb_ = nullptr;
+        err_cb_ = nullptr;
+        const int self = static_cast<int>(std::count(t_publishing.begin(), t_publishing.end(), this));
+        cb_cv_.wait(lk, [&] { return in_flight_ <= self; });
+    }
+
+    bool Connect(const SS_LightConnectionConfig& cfg, std::string& out_error) override
+    {
+        out_error.clear();
+        last_tx_.clear();
+
+        if (cfg.connect_type != SS_LIGHT_CONNECT_TYPE::SOCKET)
+        {
+            out_error = "Connect: tcp gateway transport requires connect_type SOCKET.";
+            PublishError_(1001, out_error);
+            return false;
+        }
+
+        const auto& sp = cfg.socket_parameter;
+        if (sp.destination_ip_address.empty() || sp.destination_port <= 0 || sp.destination_port > 65535)
+        {
+            out_error = "Connect: invalid connection config: socket destination is invalid.";
+            PublishError_(1002, out_error);
+            return false;
+        }
+
+        // 重连：先从旧连接上摘下来
+        Detach_();
+
+        auto gw = SS_LightTcpGateway::Acquire(sp.destination_ip_address, sp.destination_port);
+        if (!gw->Open(sp, out_error))
+        {
+            PublishError_(1004, out_error);
+            return false;
+        }
+
+        auto ep = std::make_shared<SS_LightTcpGateway::Endpoint>();
+
+        uint8_t unit_id = 0;
+        if (SS_LightTransmissionWrapper::ParseHexByte(byte_params_.device_address, unit_id))
+            ep->unit_id = unit_id;
+
+        // Detach 会等其它线程上的回调结束，这里捕获 this 是安全的
+        ep->rx_cb = [this](const std::vector<uint8_t>& bytes) { PublishRx_(bytes); };
+        ep->err_cb = [this](int code, const std::string& msg) { PublishError_(code, msg); };
+        ep->disc_cb = [this](const std::string& reason) {
+            if (connected_.exchange(false))
+                PublishDisconnected_(reason);
+        };
+
+        gw->Attach(ep);
+
+        gw_ = std::move(gw);
+        ep_ = std::move(ep);
+        connected_.store(true);
+        return true;
+    }
+
+    void Disconnect() override
+    {
+        const bool was_connected = connected_.exchange(false);
+        Detach_();
+        if (was_connected)
+            PublishDisconnected_("manual disconnect");
+    }
+
+    bool IsConnected() const override
+    {
+        return connected_.load();
+    }
+
+    bool SendBytes(const std::vector<uint8_t>& bytes, std::string& out_error) override
+    {
+        out_error.clear();
+
+        if (!gw_ || !ep_)
+        {
+            out_error = "SendBytes: gateway connection is null (not connected).";
+            PublishError_(2001, out_error);
+            return false;
+        }
+        if (!connected_.load())
+        {
+            out_error = "SendBytes: not connected.";
+            PublishError_(2002, out_error);
+            return false;
+        }
+        if (bytes.empty())
+        {
+            out_error = "SendBytes: bytes is empty.";
+            PublishError_(2003, out_error);
+            return false;
+        }
+
+        last_tx_ = bytes;
+
+        if (!gw_->Submit(ep_, bytes, out_error))
+        {
+            PublishError_(2004, out_error);
+            return false;
+        }
+        return true;
+    }
+
+    std::vector<uint8_t> GetLastTxBytes() const override
+    {
+        return last_tx_;
+    }
+
+    LinkStatsSource GetLinkStatsSource() const override
+    {
+        // 共享链路：统计为整条网关连接合计
+        return gw_ ? MakeLinkStatsSource(gw_->GetCommunicate(), true) : nullptr;
+    }
+
+    void SetRxCallback(RxCallback cb) override
+    {
+        std::lock_guard<std::mutex> lk(cb_mtx_);
+        rx_cb_ = std::move(cb);
+    }
+
+    void SetDisconnectedCallback(DisconnectCallback cb) override
+    {
+        std::lock_guard<std::mutex> lk(cb_mtx_);
+        disc_cb_ = std::move(cb);
+    }
+
+    void SetErrorCallback(ErrorCallback cb) override
+    {
+        std::lock_guard<std::mutex> lk(cb_mtx_);
+        err_cb_ = std::move(cb);
+    }
+
+private:
+    void Detach_()
+    {
+        if (gw_ && ep_)
+            gw_->Detach(ep_);
+        ep_.reset();
+        gw_.reset(); // 最后一个持有者释放时断开连接
+    }
+
+    // 取出回调并登记 in_flight_；回调为空返回 false
+    template <typename Cb>
+    bool BeginPublish_(const Cb& member, Cb& out_cb)
+    {
+        {
+            std::lock_guard<std::mutex> lk(cb_mtx_);
+            if (!member) return false;
+            out_cb = member;
+            ++in_flight_;
+        }
+        t_publishing.push_back(this);
+        return true;
+    }
+
+    void EndPublish_()
+    {
+        t_publishing.pop_back();
+        std::lock_guard<std::mutex> lk(cb_mtx_);
+        if (--in_flight_ == 0)
+            cb_cv_.notify_all();
+    }
+
+    void PublishError_(int code, const std::string& msg)
+    {
+        ErrorCallback cb;
+        if (!BeginPublish_(err_cb_, cb)) return;
+        cb(code, msg);
+        EndPublish_();
+    }
+
+    void PublishDisconnected_(const std::string& reason)
+    {
+        DisconnectCallback cb;
+        if (!BeginPublish_(disc_cb_, cb)) return;
+        cb(reason);
+        EndPublish_();
+    }
+
+    void PublishRx_(const std::vector<uint8_t>& bytes)
+    {
+        RxCallback cb;
+        if (!BeginPublish_(rx_cb_, cb)) return;
+        cb(bytes);
+        EndPublish_();
+    }
+
+private:
+    SS_LightByteTransmissionParams byte_params_;
+
+    std::shared_ptr<SS_LightTcpGateway> gw_;
+    std::shared_ptr<SS_LightTcpGateway::Endpoint> ep_;
+
+    std::atomic_bool connected_{ false };
+    std::vector<uint8_t> last_tx_;
+
+    mutable std::mutex cb_mtx_;
+    std::condition_variable cb_cv_;
+    int in_flight_ = 0;
+    RxCallback rx_cb_;
+    DisconnectCallback disc_cb_;
+    ErrorCallback err_cb_;
+};
+
+std::unique_ptr<SS_LightTransport> CreateTcpGatewayLightTransport(
+    const SS_LightByteTransmissionParams& byte_params)
+{
+    return std::make_unique<SS_LightTcpGatewayTransport>(byte_params);
+}
@@ -0,0 +1,130 @@
+// ss_light_resource_tcp_gateway.h
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
+
+#include "ss_light_resource_models.h"
+#include "ss_light_resource_transport.h"
+#include "ss_light_resource_frame_parser.h"
+
+class CommunicateInterface;
+
+// Modbus TCP 网关连接池：同一个 destination ip:port 的所有实例共享一条 TCP 连接
+// - 发送时改写 MBAP TransactionId 为连接内唯一值，并记录 txid -> 实例
+// - 应答按 txid 解复用，还原原始 txid 后回给所属 runtime
+// - txid 匹配不上时按 UnitId 兜底路由
+// - 超时的 txid 由网关自己的清理线程回收并上报；回调在不持有任何网关锁时调用
+class SS_LightTcpGateway
+{
+public:
+    // 连接上的一个挂载点（一个 runtime 一个）
+    struct Endpoint
+    {
+        // MBAP UnitId（对应 device_address）
+        int unit_id = -1;
+
+        SS_LightTransport::RxCallback rx_cb;
+        SS_LightTransport::DisconnectCallback disc_cb;
+        SS_LightTransport::ErrorCallback err_cb;
+
+        // 以下由网关 mtx_ 保护：Detach 后不再派发；in_flight 为正在执行的回调数
+        bool detached = false;
+        int in_flight = 0;
+    };
+
+    // 未应答的 txid 超过该时间会被清理（网关丢包/设备离线），并向所属实例报 2005 应答超时
+    static constexpr int kPendingExpireMs = 5000;
+
+    // 按 ip:port 获取（不存在则创建）；最后一个持有者释放时断开连接
+    static std::shared_ptr<SS_LightTcpGateway> Acquire(const std::string& ip, int port);
+
+    ~SS_LightTcpGateway();
+
+    // 首次连接时使用该 socket 配置（含 latency_profile）；已连接时直接返回
+    bool Open(const SS_LightSocketConfig& cfg, std::string& out_error);
+    bool IsOpen() const { return open_.load(); }
+
+    void Attach(const std::shared_ptr<Endpoint>& ep);
+    void Detach(const std::shared_ptr<Endpoint>& ep);
+
+    // 发送一帧 MBAP ADU（bytes 至少 8 字节）；连接内 txid 全部在途时失败
+    bool Submit(const std::shared_ptr<Endpoint>& ep, const std::vector<uint8_t>& adu, std::string& out_error);
+
+    // 底层 TCP 连接（链路统计用）
+    std::shared_ptr<CommunicateInterface> GetCommunicate() const { return comm_; }
+
+private:
+    SS_LightTcpGateway(std::string ip, int port);
+
+    struct PendingTx
+    {
+        std::weak_ptr<Endpoint> ep;
+        uint16_t original_txid = 0;
+        std::chrono::steady_clock::time_point sent_at;
+    };
+
+    void OnRxBytes_(const uint8_t* data, size_t len);
+    void OnCommError_(int code, const std::string& msg);
+
+    // 清理线程：周期回收超时 txid，锁外向所属实例报 2005
+    void ExpireLoop_();
+
+    // out_timed_out：超时（而非实例已释放）的请求所属 endpoint，调用方在锁外上报
+    void PurgeExpired_(std::chrono::steady_clock::time_point now, std::vector<std::shared_ptr<Endpoint>>& out_timed_out);
+    std::shared_ptr<Endpoint> FindByUnitId_(int unit_id) const;
+
+    // 锁外调用 ep 的回调：mtx_ 内取出回调并登记 in_flight，结束后注销并唤醒等待的 Detach
+    void DispatchRx_(const std::shared_ptr<Endpoint>& ep, const std::vector<uint8_t>& bytes);
+    void DispatchError_(const std::shared_ptr<Endpoint>& ep, int code, const std::string& msg, bool disconnected);
+    bool BeginDispatch_(const std::shared_ptr<Endpoint>& ep);
+    void EndDispatch_(const std::shared_ptr<Endpoint>& ep);
+
+    // 网关线程（清理线程 / TCP 读线程）上的回调可能释放最后一个引用，析构换到临时线程做，避免 join 自己
+    static void Release_(SS_LightTcpGateway* gw);
+
+private:
+    std::string ip_;
+    int port_ = 0;
+
+    std::shared_ptr<CommunicateInterface> comm_;
+    std::atomic_bool open_{ false };
+
+    // 串行化 Open
+    std::mutex open_mtx_;
+
+    // 保护 endpoints_ / pending_ / parser_ / next_txid_ / stop_
+    mutable std::mutex mtx_;
+
+    // 唤醒清理线程（有新的在途请求 / 析构）
+    std::condition_variable expire_cv_;
+
+    // 串行化 WriteData，保证一帧 ADU 不被其它实例插入
+    std::mutex write_mtx_;
+
+    // 配合 Endpoint::in_flight：Detach 等其它线程上的回调结束，避免回调落到已销毁的 transport
+    std::condition_variable dispatch_cv_;
+
+    std::vector<std::shared_ptr<Endpoint>> endpoints_;
+
+    // 连接内 txid -> 发送方
+    std::unordered_map<uint16_t, PendingTx> pending_;
+    uint16_t next_txid_ = 0;
+
+    SS_LightFrameParser parser_;
+    SS_LightByteTransmissionParams mbap_params_;
+
+    std::thread expire_thread_;
+    bool stop_ = false;
+};
+
+// 挂到共享网关连接上的 transport（BYTE + ModbusTCP_MBAP 的网口连接走这里）
+std::unique_ptr<SS_LightTransport> CreateTcpGatewayLightTransport(
+    const SS_LightByteTransmissionParams& byte_params);
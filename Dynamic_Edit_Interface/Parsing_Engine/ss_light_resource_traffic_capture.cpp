@@ -0,0 +1,477 @@
+// ss_light_resource_traffic_capture.cpp
+#include "ss_light_resource_traffic_capture.h"
+
+#include <thread>
+#include <condition_variable>
+
+static const char kDataMagic[8] = { 'S', 'S', 'L', 'T', 'R', 'C', '0', '1' };
+// 单条记录长度上限：超过的帧不录；读取时超过即按尾部损坏处理，不按损坏的长度分配内存
+static constexpr uint32_t kMaxRecordLen = 64u << 20;
+
+static void PutLe_(std::vector<uint8_t>& out, uint64_t v, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+        out.push_back(static_cast<uint8_t>((v >> (8 * i)) & 0xFF));
+}
+
+static uint64_t GetLe_(const uint8_t* p, int bytes)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; ++i)
+        v |= static_cast<uint64_t>(p[i]) << (8 * i);
+    return v;
+}
+
+// ============================
+// SS_LightTrafficRecorder
+// ============================
+
+SS_LightTrafficRecorder::~SS_LightTrafficRecorder()
+{
+    Close();
+}
+
+bool SS_LightTrafficRecorder::Open(const std::string& capture_path, std::string& out_error)
+{
+    out_error.clear();
+
+    if (capture_path.empty())
+    {
+        out_error = "TrafficRecorder: capture_path is empty.";
+        return false;
+    }
+
+    Close();
+
+    std::lock_guard<std::mutex> lk(mtx_);
+
+    data_.open(capture_path, std::ios::binary | std::ios::out | std::ios::trunc);
+    if (!data_.is_open())
+    {
+        out_error = "TrafficRecorder: open failed: " + capture_path;
+        return false;
+    }
+
+    data_.write(kDataMagic, sizeof(kDataMagic));
+    unflushed_ = 0;
+    t0_ = std::chrono::steady_clock::now();
+
+    open_.store(true, std::memory_order_release);
+    return true;
+}
+
+void SS_LightTrafficRecorder::Close()
+{
+    open_.store(false, std::memory_order_release);
+
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (data_.is_open())
+    {
+        data_.flush();
+        data_.close();
+    }
+}
+
+void SS_LightTrafficRecorder::Record(const std::string& instance_id, SS_LightTrafficDirection dir, const uint8_t* data, size_t len)
+{
+    if (!IsOpen()) return;
+    if (data == nullptr && len != 0) return;
+
+    const auto now = std::chrono::steady_clock::now();
+    const size_t id_len = instance_id.size() > 0xFFFF ? 0xFFFF : instance_id.size();
+    if (len > kMaxRecordLen - (8 + 1 + 2 + id_len)) return;
+
+    // 头部先拼好一次写出，payload 直接写，不再拷贝
+    std::vector<uint8_t> head;
+    head.reserve(4 + 8 + 1 + 2 + id_len);
+
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (!data_.is_open()) return;
+
+    const uint64_t ts_us = now > t0_
+        ? static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now - t0_).count())
+        : 0;
+
+    PutLe_(head, static_cast<uint32_t>(8 + 1 + 2 + id_len + len), 4);
+    PutLe_(head, ts_us, 8);
+    head.push_back(static_cast<uint8_t>(dir));
+    PutLe_(head, id_len, 2);
+    head.insert(head.end(), instance_id.begin(), instance_id.begin() + static_cast<std::ptrdiff_t>(id_len));
+
+    data_.write(reinterpret_cast<const char*>(head.data()), static_cast<std::streamsize>(head.size()));
+    if (len > 0)
+        data_.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(len));
+
+    if (++unflushed_ >= kFlushEvery)
+    {
+        data_.flush();
+        unflushed_ = 0;
+    }
+}
+
+bool LoadTrafficCapture(
+    const std::string& capture_path,
+    const std::string& instance_id,
+    std::vector<SS_LightTrafficRecord>& out_records,
+    std::string& out_error)
+{
+    out_error.clear();
+    out_records.clear();
+
+    std::ifstream in(capture_path, std::ios::binary);
+    if (!in.is_open())
+    {
+        out_error = "LoadTrafficCapture: open failed: " + capture_path;
+        return false;
+    }
+
+    char magic[sizeof(kDataMagic)] = {};
+    in.read(magic, sizeof(magic));
+    if (!in || std::char_traits<char>::compare(magic, kDataMagic, sizeof(kDataMagic)) != 0)
+    {
+        out_error = "LoadTrafficCapture: bad magic: " + capture_path;
+        return false;
+    }
+
+    std::vector<uint8_t> body;
+    while (true)
+    {
+        uint8_t len_buf[4];
+        in.read(reinterpret_cast<char*>(len_buf), sizeof(len_buf));
+        if (in.gcount() == 0) break;                  // 正常结束
+        if (in.gcount() != sizeof(len_buf)) break;   // 尾部截断（录制中途退出），丢弃
+
+        const uint32_t rec_len = static_cast<uint32_t>(GetLe_(len_buf, 4));
+        if (rec_len < 8 + 1 + 2)
+        {
+            out_error = "LoadTrafficCapture: corrupted record length.";
+            return false;
+        }
+        if (rec_len > kMaxRecordLen) break;           // 长度字段本身损坏（写了一半的尾部），丢弃
+
+        body.resize(rec_len);
+        in.read(reinterpret_cast<char*>(body.data()), rec_len);
+        if (static_cast<uint32_t>(in.gcount()) != rec_len) break;
+
+        const uint64_t ts_us = GetLe_(body.data(), 8);
+        const uint8_t dir = body[8];
+        const size_t id_len = static_cast<size_t>(GetLe_(body.data() + 9, 2));
+        if (11 + id_len > rec_len)
+        {
+            out_error = "LoadTrafficCapture: corrupted instance id length.";
+            return false;
+        }
+
+        std::string id(reinterpret_cast<const char*>(body.data() + 11), id_len);
+        if (!instance_id.empty() && id != instance_id)
+            continue;
+
+        SS_LightTrafficRecord r;
+        r.timestamp_us = ts_us;
+        r.direction = dir == 0 ? SS_LightTrafficDirection::TX : SS_LightTrafficDirection::RX;
+        r.instance_id = std::move(id);
+        r.bytes.assign(body.begin() + static_cast<std::ptrdiff_t>(11 + id_len), body.end());
+        out_records.push_back(std::move(r));
+    }
+
+    return true;
+}
+
+// ============================
+// SS_LightRecordingTransport
+// ============================
+
+class SS_LightRecordingTransport final : public SS_LightTransport
+{
+public:
+    SS_LightRecordingTransport(
+        std::unique_ptr<SS_LightTransport> inner,
+        std::shared_ptr<SS_LightTrafficRecorder> recorder,
+        std::string instance_id)
+        : inner_(std::move(inner))
+        , recorder_(std::move(recorder))
+        , instance_id_(std::move(instance_id))
+    {
+        inner_->SetRxCallback([this](const std::vector<uint8_t>& bytes) {
+            if (recorder_) recorder_->Record(instance_id_, SS_LightTrafficDirection::RX, bytes.data(), bytes.size());
+
+            RxCallback cb;
+            {
+                std::lock_guard<std::mutex> lk(cb_mtx_);
+                cb = rx_cb_;
+            }
+            if (cb) cb(bytes);
+        });
+    }
+
+    ~SS_LightRecordingTransport() override
+    {
+        // 先销毁 inner，保证其回调线程不再进来
+        inner_.reset();
+    }
+
+    bool Connect(const SS_LightConnectionConfig& cfg, std::string& out_error) override
+    {
+        return inner_->Connect(cfg, out_error);
+    }
+
+    void Disconnect() override
+    {
+        inner_->Disconnect();
+    }
+
+    bool IsConnected() const override
+    {
+        return inner_->IsConnected();
+    }
+
+    bool SendBytes(const std::vector<uint8_t>& bytes, std::string& out_error) override
+    {
+        if (recorder_) recorder_->Record(instance_id_, SS_LightTrafficDirection::TX, bytes.data(), bytes.size());
+        return inner_->SendBytes(bytes, out_error);
+    }
+
+    std::vector<uint8_t> GetLastTxBytes() const override
+    {
+        return inner_->GetLastTxBytes();
+    }
+
+    LinkStatsSource GetLinkStatsSource() const override
+    {
+        return inner_->GetLinkStatsSource();
+    }
+
+    void SetRxCallback(RxCallback cb) override
+    {
+        std::lock_guard<std::mutex> lk(cb_mtx_);
+        rx_cb_ = std::move(cb);
+    }
+
+    void SetDisconnectedCallback(DisconnectCallback cb) override
+    {
+        inner_->SetDisconnectedCallback(std::move(cb));
+    }
+
+    void SetErrorCallback(ErrorCallback cb) override
+    {
+        inner_->SetErrorCallback(std::move(cb));
+    }
+
+private:
+    std::unique_ptr<SS_LightTransport> inner_;
+    std::shared_ptr<SS_LightTrafficRecorder> recorder_;
+    std::string instance_id_;
+
+    std::mutex cb_mtx_;
+    RxCallback rx_cb_;
+};
+
+std::unique_ptr<SS_LightTransport> CreateRecordingLightTransport(
+    std::unique_ptr<SS_LightTransport> inner,
+    std::shared_ptr<SS_LightTrafficRecorder> recorder,
+    const std::string& instance_id)
+{
+    if (!inner) return nullptr;
+    return std::make_unique<SS_LightRecordingTransport>(std::move(inner), std::move(recorder), instance_id);
+}
+
+// ============================
+// SS_LightReplayTransport
+// ============================
+
+class SS_LightReplayTransport final : public SS_LightTransport
+{
+public:
+    SS_LightReplayTransport(std::string capture_path, std::string instance_id, double speed)
+        : capture_path_(std::move(capture_path))
+        , instance_id_(std::move(instance_id))
+        , speed_(speed)
+    {
+    }
+
+    ~SS_LightReplayTransport() override
+    {
+        StopThread_();
+        std::lock_guard<std::mutex> lk(cb_mtx_);
+        rx_cb_ = nullptr;
+        disc_cb_ = nullptr;
+        err_cb_ = nullptr;
+    }
+
+    bool Connect(const SS_LightConnectionConfig& /*cfg*/, std::string& out_error) override
+    {
+        out_error.clear();
+        StopThread_();
+
+        std::vector<SS_LightTrafficRecord> records;
+        if (!LoadTrafficCapture(capture_path_, instance_id_, records, out_error))
+        {
+            PublishError_(1004, out_error);
+            return false;
+        }
+
+        // 只回灌 RX；TX 由 runtime 自己产生
+        std::vector<SS_LightTrafficRecord> rx;
+        for (auto& r : records)
+            if (r.direction == SS_LightTrafficDirection::RX) rx.push_back(std::move(r));
+
+        {
+            std::lock_guard<std::mutex> lk(thread_mtx_);
+            stop_ = false;
+        }
+        connected_.store(true);
+        thread_ = std::thread(&SS_LightReplayTransport::ReplayLoop_, this, std::move(rx));
+        return true;
+    }
+
+    void Disconnect() override
+    {
+        const bool was_connected = connected_.exchange(false);
+        StopThread_();
+        if (was_connected)
+            PublishDisconnected_("manual disconnect");
+    }
+
+    bool IsConnected() const override
+    {
+        return connected_.load();
+    }
+
+    bool SendBytes(const std::vector<uint8_t>& bytes, std::string& out_error) override
+    {
+        out_error.clear();
+        if (!connected_.load())
+        {
+            out_error = "SendBytes: not connected.";
+            PublishError_(2002, out_error);
+            return false;
+        }
+        if (bytes.empty())
+        {
+            out_error = "SendBytes: bytes is empty.";
+            PublishError_(2003, out_error);
+            return false;
+        }
+        last_tx_ = bytes;
+        return true;
+    }
+
+    std::vector<uint8_t> GetLastTxBytes() const override
+    {
+        return last_tx_;
+    }
+
+    void SetRxCallback(RxCallback cb) override
+    {
+        std::lock_guard<std::mutex> lk(cb_mtx_);
+        rx_cb_ = std::move(cb);
+    }
+
+    void SetDisconnectedCallback(DisconnectCallback cb) override
+    {
+        std::lock_guard<std::mutex> lk(cb_mtx_);
+        disc_cb_ = std::move(cb);
+    }
+
+    void SetErrorCallback(ErrorCallback cb) override
+    {
+        std::lock_guard<std::mutex> lk(cb_mtx_);
+        err_cb_ = std::move(cb);
+    }
+
+private:
+    void ReplayLoop_(std::vector<SS_LightTrafficRecord> rx)
+    {
+        if (rx.empty()) return;
+
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t base_us = rx.front().timestamp_us;
+
+        for (const auto& r : rx)
+        {
+            if (speed_ > 0.0)
+            {
+                const auto offset = std::chrono::microseconds(
+                    static_cast<int64_t>(static_cast<double>(r.timestamp_us - base_us) / speed_));
+
+                std::unique_lock<std::mutex> lk(thread_mtx_);
+                if (thread_cv_.wait_until(lk, start + offset, [this] { return stop_; }))
+                    return;
+            }
+            else
+            {
+                std::lock_guard<std::mutex> lk(thread_mtx_);
+                if (stop_) return;
+            }
+
+            PublishRx_(r.bytes);
+        }
+    }
+
+    void StopThread_()
+    {
+        {
+            std::lock_guard<std::mutex> lk(thread_mtx_);
+            stop_ = true;
+        }
+        thread_cv_.notify_all();
+        if (thread_.joinable())
+            thread_.join();
+    }
+
+    void PublishError_(int code, const std::string& msg)
+    {
+        ErrorCallback cb;
+        {
+            std::lock_guard<std::mutex> lk(cb_mtx_);
+            cb = err_cb_;
+        }
+        if (cb) cb(code, msg);
+    }
+
+    void PublishDisconnected_(const std::string& reason)
+    {
+        DisconnectCallback cb;
+        {
+            std::lock_guard<std::mutex> lk(cb_mtx_);
+            cb = disc_cb_;
+        }
+        if (cb) cb(reason);
+    }
+
+    void PublishRx_(const std::vector<uint8_t>& bytes)
+    {
+        RxCallback cb;
+        {
+            std::lock_guard<std::mutex> lk(cb_mtx_);
+            cb = rx_cb_;
+        }
+        if (cb) cb(bytes);
+    }
+
+private:
+    std::string capture_path_;
+    std::string instance_id_;
+    double speed_ = 1.0;
+
+    std::atomic_bool connected_{ false };
+    std::vector<uint8_t> last_tx_;
+
+    std::thread thread_;
+    std::mutex thread_mtx_;
+    std::condition_variable thread_cv_;
+    bool stop_ = false;
+
+    mutable std::mutex cb_mtx_;
+    RxCallback rx_cb_;
+    DisconnectCallback disc_cb_;
+    ErrorCallback err_cb_;
+};
+
+std::unique_ptr<SS_LightTransport> CreateReplayLightTransport(
+    const std::string& capture_path,
+    const std::string& instance_id,
+    double speed)
+{
+    return std::make_unique<SS_LightReplayTransport>(capture_path, instance_id, speed);
+}
@@ -0,0 +1,76 @@
+// ss_light_resource_traffic_capture.h
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+
+#include "ss_light_resource_transport.h"
+
+// 收发方向
+enum class SS_LightTrafficDirection : uint8_t
+{
+    TX = 0,
+    RX = 1
+};
+
+// 一条抓包记录
+struct SS_LightTrafficRecord
+{
+    uint64_t timestamp_us = 0;   // 相对录制开始的单调时间
+    SS_LightTrafficDirection direction = SS_LightTrafficDirection::TX;
+    std::string instance_id;
+    std::vector<uint8_t> bytes;
+};
+
+// 抓包文件（追加写）
+// 数据文件：magic "SSLTRC01" + N 条记录
+//   record = u32 len(之后的字节数) | u64 ts_us | u8 dir | u16 id_len | id | payload   （小端）
+class SS_LightTrafficRecorder
+{
+public:
+    SS_LightTrafficRecorder() = default;
+    ~SS_LightTrafficRecorder();
+
+    bool Open(const std::string& capture_path, std::string& out_error);
+    void Close();
+    bool IsOpen() const { return open_.load(std::memory_order_acquire); }
+
+    // 未打开时直接返回（不加锁），常驻挂在 transport 上也没有额外开销
+    void Record(const std::string& instance_id, SS_LightTrafficDirection dir, const uint8_t* data, size_t len);
+
+private:
+    static constexpr uint32_t kFlushEvery = 64;
+
+    std::atomic_bool open_{ false };
+
+    std::mutex mtx_;
+    std::ofstream data_;
+    uint32_t unflushed_ = 0;
+    std::chrono::steady_clock::time_point t0_{};
+};
+
+// 读取整份抓包（按文件顺序）；instance_id 非空时只保留该实例
+bool LoadTrafficCapture(
+    const std::string& capture_path,
+    const std::string& instance_id,
+    std::vector<SS_LightTrafficRecord>& out_records,
+    std::string& out_error);
+
+// 录制装饰器：透传给 inner，TX/RX 同时写入 recorder
+std::unique_ptr<SS_LightTransport> CreateRecordingLightTransport(
+    std::unique_ptr<SS_LightTransport> inner,
+    std::shared_ptr<SS_LightTrafficRecorder> recorder,
+    const std::string& instance_id);
+
+// 回放 transport：Connect 时载入抓包，把该实例的 RX 按原始时间间隔回灌
+// - speed = 1 原速；>1 加速；<=0 不等待尽快回放
+// - SendBytes 只记录 last_tx，不会真的发出
+std::unique_ptr<SS_LightTransport> CreateReplayLightTransport(
+    const std::string& capture_path,
+    const std::string& instance_id,
+    double speed);
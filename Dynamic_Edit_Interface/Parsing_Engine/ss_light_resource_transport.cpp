@@ -8,6 +8,8 @@
 #include "../../include/Communication_Library/ss_communicate_interface.h"
 #include "../../include/Communication_Library/ss_communicate_library.h"
 
+#include "ss_light_resource_connection_stats.h"
+
 #ifdef _DEBUG
 #pragma comment(lib, "../../lib/Debug/Communication_Library.lib")
 #else
@@ -30,6 +32,16 @@ static ConnectionInfo ToConnectionInfo_(const SS_LightConnectionConfig& cfg, std
         ci.ip_ = cfg.socket_parameter.destination_ip_address;
         ci.port_ = cfg.socket_parameter.destination_port;
 
+        const auto& lp = cfg.socket_parameter.latency_profile;
+        ci.tcp_no_delay_ = lp.tcp_no_delay;
+        ci.tcp_quick_ack_ = lp.tcp_quick_ack;
+        ci.socket_priority_ = lp.socket_priority;
+        ci.busy_poll_us_ = lp.busy_poll_us;
+        ci.send_buffer_size_ = lp.send_buffer_size;
+        ci.recv_buffer_size_ = lp.recv_buffer_size;
+        ci.io_cpu_affinity_ = lp.io_cpu_affinity;
+        ci.connect_timeout_ms_ = cfg.socket_parameter.connect_timeout_ms;
+
         if (ci.ip_.empty())
         {
             out_error = "socket destination_ip_address is empty.";
@@ -133,13 +145,13 @@ public:
         }
 
         // 每次 Connect 都重新绑回调，防止底层换对象/重连丢回调
-        comm_->SetDataCallback([this](std::string /*ip*/, std::vector<char> data) {
-            if (data.empty()) return;
+        // 池化缓冲回调：只在接收线程内转一次 uint8_t，rx_scratch_ 容量复用，稳态无分配
+        comm_->SetRxBufferCallback([this](const std::string& /*ip*/, const CommunicateRxBufferPtr& buffer) {
+            if (!buffer || buffer->empty()) return;
 
-            std::vector<uint8_t> bytes;
-            bytes.reserve(data.size());
-            for (char c : data) bytes.push_back(static_cast<uint8_t>(c));
-            PublishRx_(bytes);
+            const uint8_t* p = reinterpret_cast<const uint8_t*>(buffer->data());
+            rx_scratch_.assign(p, p + buffer->size());
+            PublishRx_(rx_scratch_);
         });
 
         comm_->SetErrorCallback([this](int code, const std::string& msg) {
@@ -229,6 +241,11 @@ public:
         return last_tx_;
     }
 
+    LinkStatsSource GetLinkStatsSource() const override
+    {
+        return MakeLinkStatsSource(comm_, false);
+    }
+
     void SetRxCallback(RxCallback cb) override
     {
         std::lock_guard<std::mutex> lk(cb_mtx_);
@@ -299,6 +316,9 @@ private:
 
     std::atomic_bool connected_{ false };
 
+    // 仅接收线程使用
+    std::vector<uint8_t> rx_scratch_;
+
     std::vector<uint8_t> last_tx_;
 
     mutable std::mutex cb_mtx_;
@@ -18,6 +18,9 @@ public:
     using DisconnectCallback = std::function<void(const std::string& reason)>;
     using ErrorCallback = std::function<void(int code, const std::string& msg)>;
 
+    // 底层链路统计来源；闭包只弱引用连接，可在任意线程调用，连接已释放时返回 false
+    using LinkStatsSource = std::function<bool(SS_LightLinkStats& out_stats)>;
+
     virtual bool Connect(const SS_LightConnectionConfig& cfg, std::string& out_error) = 0;
     virtual void Disconnect() = 0;
     virtual bool IsConnected() const = 0;
@@ -27,6 +30,9 @@ public:
     virtual void SetRxCallback(RxCallback cb) = 0;// 新增：runtime 用来接收“收包/断线/错误”
     virtual void SetDisconnectedCallback(DisconnectCallback cb) = 0;
     virtual void SetErrorCallback(ErrorCallback cb) = 0;
+
+    // Connect 成功后调用；无底层连接（回放）时返回空
+    virtual LinkStatsSource GetLinkStatsSource() const { return nullptr; }
 };
 
 std::unique_ptr<SS_LightTransport> CreateDefaultLightTransport();
\ No newline at end of file
@@ -37,6 +37,13 @@ enum class SS_LIGHT_VALUE_TYPE
     BYTES
 };
 
+// 值超出 range / step / text_max_length 时的处理
+enum class SS_LIGHT_RANGE_POLICY
+{
+    REJECT = 0,   // 拒绝，不写入不发送
+    CLAMP         // 收到边界 / 最近的步进值 / 截断
+};
+
 enum class SS_LIGHT_WIDGET_TYPE
 {
     UNKNOWN = 0,
@@ -134,6 +141,9 @@ struct SS_LightParamDef
 
     SS_LIGHT_VALUE_TYPE value_type = SS_LIGHT_VALUE_TYPE::UNKNOWN;
 
+    // 超出 widget 的 range / step / text_max_length 时拒绝还是收敛（YAML: range_policy）
+    SS_LIGHT_RANGE_POLICY range_policy = SS_LIGHT_RANGE_POLICY::REJECT;
+
     // 控件参数中也有默认值，此项作为副本，方便core调用
     std::string default_value;
 
@@ -153,6 +163,22 @@ struct SS_LightChannelItem
     int order = 0;
 };
 
+// 带类型的参数值：value_str 进入 core 时按 value_type 解析一次，之后存储/生成指令都用它
+// - INT：i；BOOL：i = 0/1；ENUM：i = options 下标；DOUBLE：d；BYTES：bytes
+// - text 始终是可直接显示/保存的字符串（INT 为规范化十进制，其余为去首尾空白后的原文）
+// - type = UNKNOWN 表示未按类型解析（模板未声明类型，或载入的旧值不合法），只有 text 有效
+struct SS_LightParamValue
+{
+    SS_LIGHT_VALUE_TYPE type = SS_LIGHT_VALUE_TYPE::UNKNOWN;
+    union
+    {
+        int64_t i = 0;
+        double d;
+    };
+    std::string text;
+    std::vector<uint8_t> bytes;
+};
+
 // 参数设置请求（UI -> core）
 struct SS_LightParamSetRequest
 {
@@ -162,6 +188,9 @@ struct SS_LightParamSetRequest
 
     // 通道类型参数时有效
     std::string channel_id;
+    // 可选：预解析的通道句柄（ResolveChannelHandle），省去按 channel_id 查找；-1 = 不使用
+    // 句柄与 channel_id 不符（期间增删过通道）时自动退回按 channel_id 查找
+    int channel_handle = -1;
 
     // 统一按照sring类型，具体数值类型由value_type区分，core负责转换和校验
     std::string value_str;
@@ -174,4 +203,65 @@ struct SS_LightParamSetResult
 
     // 解析后的指令，可保持string字符串、或转为十六进制字节流
     std::string command_out;
+
+    // 实际写入的值；与 value_str 不同时 value_adjusted = true（数值规范化或按 range_policy 收敛），UI 应回显它
+    std::string applied_value;
+    bool value_adjusted = false;
+};
+
+// 参数合并发送选项（拖动/连续输入时同一参数只发最新值）
+struct SS_LightCoalesceOptions
+{
+    bool enabled = true;
+    int flush_interval_ms = 50;   // 挂起值最长等待时间
+    bool flush_on_idle = true;    // 上一帧已应答（或超时）时立即发出，不等满间隔
+};
+
+// 实例延迟落盘选项（SaveInstanceDeferred）
+struct SS_LightPersistOptions
+{
+    bool write_behind = true;     // false：SaveInstanceDeferred 退化为同步 SaveInstanceById
+    int debounce_ms = 300;        // 最后一次修改后静默这么久才写
+    int max_delay_ms = 2000;      // 连续修改（拖动）时最长这么久也必须写一次
+
+    // 修改日志（<instance_dir>/journal/）：参数/通道修改先追加进日志，定期折叠进 *_instance.yaml
+    bool journal = true;
+    int group_commit_ms = 2;            // 一次 fsync 合并这段时间内的全部修改
+    int compact_interval_ms = 30000;    // 有新记录后最长这么久折叠一次
+    uint64_t compact_bytes = 1 << 20;   // 新记录超过这么多字节时提前折叠（最迟 1 s 内发现）
+};
+
+// 实例落盘统计
+struct SS_LightPersistStats
+{
+    uint64_t save_requests = 0;      // SaveInstanceDeferred 调用次数
+    uint64_t files_written = 0;      // 实际写文件次数（含同步 SaveInstanceById）
+    uint64_t skipped_unchanged = 0;  // 内容哈希与上次写入相同而跳过的次数
+    size_t pending = 0;              // 当前等待写出的实例数
+
+    uint64_t journal_records = 0;    // 追加进修改日志的记录数
+    uint64_t journal_commits = 0;    // 日志 fsync 次数（group commit 后远小于记录数）
+    uint64_t journal_bytes = 0;      // 已落盘的日志字节数
+    uint64_t compactions = 0;        // 折叠进 YAML 的次数
+};
+
+// 合并发送的一条实际发送结果
+struct SS_LightCoalescedResult
+{
+    SS_LightParamSetRequest request;             // 实际发送的（最新）值
+    SS_LightParamSetResult result;
+    std::vector<std::string> superseded_values;  // 被覆盖、未发送的中间值（按到达顺序）
+};
+
+// 批量参数写入结果（ApplyBatch）
+// - 先整体校验并生成全部帧，任何一项失败则整批不写入（applied = false）
+// - 写入后发送失败时 applied = true、ok = false：值已保存，设备可能只收到了前面一部分
+struct SS_LightBatchResult
+{
+    bool ok = false;
+    bool applied = false;                         // 值已写入实例
+    int failed_index = -1;                        // 校验/生成失败的请求下标，-1 表示无
+    int frames_sent = 0;                          // 实际 SendBytes 次数（STRING 命令可合并为一次）
+    std::string message;
+    std::vector<SS_LightParamSetResult> results;  // 与请求一一对应
 };
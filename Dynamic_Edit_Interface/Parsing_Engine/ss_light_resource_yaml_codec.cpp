@@ -4,6 +4,18 @@
 #include <fstream>
 #include <sstream>
 #include <cctype>
+#include <filesystem>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#endif
 
 // ----------------- public APIs -----------------
 
@@ -55,6 +67,25 @@ bool SS_LightYamlCodec::LoadTemplate(const std::string& yaml_path, SS_LightContr
     // protocol_type
     out_tpl.info.protocol_type = ParseProtocolType(GetString(info, "protocol_type", "STRING"));
 
+    // inter_command_gap_ms（可选）
+    out_tpl.info.inter_command_gap_ms = GetInt(info, "inter_command_gap_ms", 0);
+    if (out_tpl.info.inter_command_gap_ms < 0) out_tpl.info.inter_command_gap_ms = 0;
+
+    // reply_timeout_ms（可选）
+    out_tpl.info.reply_timeout_ms = GetInt(info, "reply_timeout_ms", SS_LightTemplateInfo::kDefaultReplyTimeoutMs);
+    if (out_tpl.info.reply_timeout_ms <= 0) out_tpl.info.reply_timeout_ms = SS_LightTemplateInfo::kDefaultReplyTimeoutMs;
+
+    // identify（可选，自动发现用）
+    out_tpl.info.identify = SS_LightIdentifyRule{};
+    auto idn = info["identify"];
+    if (idn && idn.IsMap()) {
+        out_tpl.info.identify.request = GetString(idn, "request", "");
+        out_tpl.info.identify.response = GetString(idn, "response", "");
+        out_tpl.info.identify.timeout_ms = GetInt(idn, "timeout_ms", 200);
+        out_tpl.info.identify.tcp_port = GetInt(idn, "tcp_port", 0);
+        if (out_tpl.info.identify.timeout_ms <= 0) out_tpl.info.identify.timeout_ms = 200;
+    }
+
 
     // 放在 template_info 下：template_info.byte_transmission_params
     {
@@ -106,6 +137,7 @@ bool SS_LightYamlCodec::LoadTemplate(const std::string& yaml_path, SS_LightContr
         def.location = ParseParamLocation(GetString(param_node, "location", "GLOBAL"));
         def.display_name = GetString(param_node, "display_name", param_key);
         def.value_type = ParseValueType(GetString(param_node, "value_type", "STRING"));
+        def.range_policy = ParseRangePolicy(GetString(param_node, "range_policy", "REJECT"));
 
         def.default_value = GetString(param_node, "default_value", "");
         def.widget.default_value = def.default_value; // 默认先同步
@@ -203,6 +235,7 @@ bool SS_LightYamlCodec::LoadTemplate(const std::string& yaml_path, SS_LightContr
         return false;
     }
 
+    out_tpl.param_index = SS_LightBuildParamIndex(out_tpl.params);
     return true;
 }
 
@@ -268,6 +301,21 @@ bool SS_LightYamlCodec::LoadInstance(const std::string& yaml_path, SS_LightContr
                 GetString(sock, "destination_ip_address", GetString(sock, "destination_ip", ""));
             out_inst.connection.socket_parameter.destination_port =
                 GetInt(sock, "destination_port", 0);
+            out_inst.connection.socket_parameter.connect_timeout_ms =
+                GetInt(sock, "connect_timeout_ms", 0);
+
+            // latency_profile（可选，缺省全关）
+            auto lp = sock["latency_profile"];
+            if (lp && lp.IsMap()) {
+                auto& p = out_inst.connection.socket_parameter.latency_profile;
+                p.tcp_no_delay = GetBool(lp, "tcp_no_delay", false);
+                p.tcp_quick_ack = GetBool(lp, "tcp_quick_ack", false);
+                p.socket_priority = GetInt(lp, "socket_priority", -1);
+                p.busy_poll_us = GetInt(lp, "busy_poll_us", 0);
+                p.send_buffer_size = GetInt(lp, "send_buffer_size", 0);
+                p.recv_buffer_size = GetInt(lp, "recv_buffer_size", 0);
+                p.io_cpu_affinity = GetInt(lp, "io_cpu_affinity", -1);
+            }
         }
     }
 
@@ -292,9 +340,8 @@ bool SS_LightYamlCodec::LoadInstance(const std::string& yaml_path, SS_LightContr
         }
     }
 
-    // parameters_value
-    out_inst.global_param_values.clear();
-    out_inst.channel_param_values.clear();
+    // parameters_value（此时尚未绑定模板 id 表，值先按 key 存放，runtime 绑定模板时转为稠密存储）
+    out_inst.param_values.Clear();
 
     auto pv = root["parameters_value"];
     if (pv && pv.IsMap())
@@ -303,7 +350,7 @@ bool SS_LightYamlCodec::LoadInstance(const std::string& yaml_path, SS_LightContr
         if (gp && gp.IsMap()) {
             for (auto it = gp.begin(); it != gp.end(); ++it) {
                 const std::string k = it->first.as<std::string>();
-                out_inst.global_param_values[k] = AsString(it->second);
+                out_inst.param_values.SetGlobal(k, AsString(it->second));
             }
         }
 
@@ -317,13 +364,10 @@ bool SS_LightYamlCodec::LoadInstance(const std::string& yaml_path, SS_LightContr
 
                 if (!channel_values.IsMap()) continue;
 
-                std::unordered_map<std::string, std::string> values;
                 for (auto cit = channel_values.begin(); cit != channel_values.end(); ++cit) {
                     const std::string channel_id = cit->first.as<std::string>();
-                    values[channel_id] = AsString(cit->second);
+                    out_inst.param_values.SetChannel(param_key, channel_id, AsString(cit->second));
                 }
-
-                out_inst.channel_param_values[param_key] = std::move(values);
             }
         }
     }
@@ -341,8 +385,17 @@ bool SS_LightYamlCodec::LoadInstance(const std::string& yaml_path, SS_LightContr
 }
 
 bool SS_LightYamlCodec::SaveInstance(const std::string& yaml_path, const SS_LightControllerInstance& inst)
+{
+    std::string text;
+    if (!EncodeInstance(inst, text))
+        return false;
+    return WriteFileAtomic(yaml_path, text);
+}
+
+bool SS_LightYamlCodec::EncodeInstance(const SS_LightControllerInstance& inst, std::string& out_text)
 {
     last_error_.clear();
+    out_text.clear();
 
     YAML::Node root;
     root["schema"]["name"] = "ss_light_controller_instance";
@@ -378,6 +431,30 @@ bool SS_LightYamlCodec::SaveInstance(const std::string& yaml_path, const SS_Ligh
     sock["port"] = inst.connection.socket_parameter.port;
     sock["destination_ip_address"] = inst.connection.socket_parameter.destination_ip_address;
     sock["destination_port"] = inst.connection.socket_parameter.destination_port;
+    if (inst.connection.socket_parameter.connect_timeout_ms > 0)
+        sock["connect_timeout_ms"] = inst.connection.socket_parameter.connect_timeout_ms;
+
+    // 只有配置过才写出，旧文件保存后保持原样
+    const auto& lp = inst.connection.socket_parameter.latency_profile;
+    const SS_LightSocketLatencyProfile lp_default;
+    if (lp.tcp_no_delay != lp_default.tcp_no_delay ||
+        lp.tcp_quick_ack != lp_default.tcp_quick_ack ||
+        lp.socket_priority != lp_default.socket_priority ||
+        lp.busy_poll_us != lp_default.busy_poll_us ||
+        lp.send_buffer_size != lp_default.send_buffer_size ||
+        lp.recv_buffer_size != lp_default.recv_buffer_size ||
+        lp.io_cpu_affinity != lp_default.io_cpu_affinity)
+    {
+        YAML::Node lpn;
+        lpn["tcp_no_delay"] = lp.tcp_no_delay;
+        lpn["tcp_quick_ack"] = lp.tcp_quick_ack;
+        lpn["socket_priority"] = lp.socket_priority;
+        lpn["busy_poll_us"] = lp.busy_poll_us;
+        lpn["send_buffer_size"] = lp.send_buffer_size;
+        lpn["recv_buffer_size"] = lp.recv_buffer_size;
+        lpn["io_cpu_affinity"] = lp.io_cpu_affinity;
+        sock["latency_profile"] = lpn;
+    }
     conn["socket_parameter"] = sock;
 
     root["connection"] = conn;
@@ -401,43 +478,228 @@ bool SS_LightYamlCodec::SaveInstance(const std::string& yaml_path, const SS_Ligh
     YAML::Node pv;
 
     YAML::Node gp;
-    for (const auto& kv : inst.global_param_values) {
-        gp[kv.first] = kv.second; // 目前 value 都是 string
+    inst.param_values.ForEachGlobal([&](const std::string& key, const std::string& value) {
+        gp[key] = value; // 目前 value 都是 string
+    });
+    pv["global_parameter"] = gp;
+
+    YAML::Node cp;
+    inst.param_values.ForEachChannel([&](const std::string& key, const std::string& channel_id, const std::string& value) {
+        cp[key][channel_id] = value; // 目前 value 都是 string
+    });
+    pv["channel_parameter"] = cp;
+
+    root["parameters_value"] = pv;
+
+    try {
+        std::ostringstream oss;
+        oss << root;
+        out_text = oss.str();
+    }
+    catch (const std::exception& e) {
+        SetError(std::string("SaveInstance failed: ") + e.what());
+        return false;
+    }
+
+    return true;
+}
+
+bool SS_LightYamlCodec::WriteFileAtomic(const std::string& path, const std::string& text)
+{
+    last_error_.clear();
+
+    const std::string tmp_path = path + ".tmp";
+
+#ifdef _WIN32
+    const std::wstring wtmp = std::filesystem::path(tmp_path).wstring();
+    const std::wstring wpath = std::filesystem::path(path).wstring();
+
+    HANDLE h = CreateFileW(wtmp.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (h == INVALID_HANDLE_VALUE)
+    {
+        SetError("SaveInstance failed: cannot open file: " + tmp_path);
+        return false;
+    }
+
+    DWORD written = 0;
+    const bool ok = (text.empty() || (WriteFile(h, text.data(), static_cast<DWORD>(text.size()), &written, nullptr) && written == text.size())) &&
+        FlushFileBuffers(h);
+    CloseHandle(h);
+    if (!ok)
+    {
+        DeleteFileW(wtmp.c_str());
+        SetError("SaveInstance failed: write error: " + tmp_path);
+        return false;
+    }
+
+    if (!MoveFileExW(wtmp.c_str(), wpath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+    {
+        DeleteFileW(wtmp.c_str());
+        SetError("SaveInstance failed: cannot replace file: " + path + " (error " + std::to_string(GetLastError()) + ")");
+        return false;
+    }
+#else
+    const int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        SetError("SaveInstance failed: cannot open file: " + tmp_path);
+        return false;
+    }
+
+    bool ok = true;
+    size_t off = 0;
+    while (ok && off < text.size())
+    {
+        const ssize_t n = ::write(fd, text.data() + off, text.size() - off);
+        if (n <= 0) ok = false;
+        else off += static_cast<size_t>(n);
+    }
+    ok = ok && ::fsync(fd) == 0;
+    ::close(fd);
+    if (!ok)
+    {
+        ::unlink(tmp_path.c_str());
+        SetError("SaveInstance failed: write error: " + tmp_path);
+        return false;
+    }
+
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0)
+    {
+        ::unlink(tmp_path.c_str());
+        SetError("SaveInstance failed: cannot replace file: " + path);
+        return false;
+    }
+
+    // rename 本身也要落盘：刷一下所在目录
+    const std::string dir = std::filesystem::path(path).parent_path().string();
+    const int dfd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY);
+    if (dfd >= 0)
+    {
+        (void)::fsync(dfd);
+        ::close(dfd);
+    }
+#endif
+
+    return true;
+}
+
+
+bool SS_LightYamlCodec::LoadRecipe(const std::string& yaml_path, SS_LightRecipe& out_recipe)
+{
+    out_recipe = SS_LightRecipe{};
+    last_error_.clear();
+
+    YAML::Node root;
+    try {
+        root = YAML::LoadFile(yaml_path);
     }
+    catch (const std::exception& e) {
+        SetError(std::string("LoadRecipe failed: ") + e.what());
+        return false;
+    }
+
+    if (!root || !root.IsMap()) {
+        SetError("LoadRecipe failed: root is not a map.");
+        return false;
+    }
+
+    auto info = root["recipe_info"];
+    if (!info || !info.IsMap()) {
+        SetError("LoadRecipe failed: missing recipe_info.");
+        return false;
+    }
+
+    out_recipe.recipe_id = GetString(info, "recipe_id");
+    out_recipe.instance_id = GetString(info, "instance_id");
+    out_recipe.display_name = GetString(info, "display_name", out_recipe.recipe_id);
+
+    // parameters_value：与实例文件同结构
+    auto pv = root["parameters_value"];
+    if (pv && pv.IsMap())
+    {
+        auto gp = pv["global_parameter"];
+        if (gp && gp.IsMap()) {
+            for (auto it = gp.begin(); it != gp.end(); ++it)
+                out_recipe.global_param_values[it->first.as<std::string>()] = AsString(it->second);
+        }
+
+        auto cp = pv["channel_parameter"];
+        if (cp && cp.IsMap())
+        {
+            for (auto it = cp.begin(); it != cp.end(); ++it)
+            {
+                const YAML::Node channel_values = it->second;
+                if (!channel_values.IsMap()) continue;
+
+                auto& values = out_recipe.channel_param_values[it->first.as<std::string>()];
+                for (auto cit = channel_values.begin(); cit != channel_values.end(); ++cit)
+                    values[cit->first.as<std::string>()] = AsString(cit->second);
+            }
+        }
+    }
+
+    if (out_recipe.recipe_id.empty()) {
+        SetError("LoadRecipe failed: recipe_info.recipe_id is empty.");
+        return false;
+    }
+    if (out_recipe.instance_id.empty()) {
+        SetError("LoadRecipe failed: recipe_info.instance_id is empty.");
+        return false;
+    }
+
+    return true;
+}
+
+bool SS_LightYamlCodec::SaveRecipe(const std::string& yaml_path, const SS_LightRecipe& recipe)
+{
+    last_error_.clear();
+
+    YAML::Node root;
+    root["schema"]["name"] = "ss_light_controller_recipe";
+    root["schema"]["version"] = "0.1";
+
+    YAML::Node info;
+    info["recipe_id"] = recipe.recipe_id;
+    info["instance_id"] = recipe.instance_id;
+    info["display_name"] = recipe.display_name;
+    root["recipe_info"] = info;
+
+    YAML::Node pv;
+
+    YAML::Node gp;
+    for (const auto& kv : recipe.global_param_values)
+        gp[kv.first] = kv.second;
     pv["global_parameter"] = gp;
 
     YAML::Node cp;
-    for (const auto& pk : inst.channel_param_values)
+    for (const auto& pk : recipe.channel_param_values)
     {
         YAML::Node m;
-        for (const auto& ck : pk.second) {
-            m[ck.first] = ck.second; // 目前 value 都是 string
-        }
+        for (const auto& ck : pk.second)
+            m[ck.first] = ck.second;
         cp[pk.first] = m;
     }
     pv["channel_parameter"] = cp;
 
     root["parameters_value"] = pv;
 
-    // dump to file
     try {
         std::ofstream ofs(yaml_path, std::ios::out | std::ios::trunc);
         if (!ofs.is_open()) {
-            SetError("SaveInstance failed: cannot open file: " + yaml_path);
+            SetError("SaveRecipe failed: cannot open file: " + yaml_path);
             return false;
         }
         ofs << root;
         ofs.close();
     }
     catch (const std::exception& e) {
-        SetError(std::string("SaveInstance failed: ") + e.what());
+        SetError(std::string("SaveRecipe failed: ") + e.what());
         return false;
     }
 
     return true;
 }
 
-
 // ----------------- helpers -----------------
 
 void SS_LightYamlCodec::SetError(const std::string& msg)
@@ -580,6 +842,13 @@ SS_LIGHT_VALUE_TYPE SS_LightYamlCodec::ParseValueType(const std::string& s)
     return SS_LIGHT_VALUE_TYPE::UNKNOWN;
 }
 
+SS_LIGHT_RANGE_POLICY SS_LightYamlCodec::ParseRangePolicy(const std::string& s)
+{
+    auto u = Upper(s);
+    if (u == "CLAMP") return SS_LIGHT_RANGE_POLICY::CLAMP;
+    return SS_LIGHT_RANGE_POLICY::REJECT;
+}
+
 SS_LIGHT_WIDGET_TYPE SS_LightYamlCodec::ParseWidgetType(const std::string& s)
 {
     auto u = Upper(s);
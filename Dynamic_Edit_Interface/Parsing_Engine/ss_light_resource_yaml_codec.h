@@ -11,6 +11,12 @@ public:
     bool LoadTemplate(const std::string& yaml_path, SS_LightControllerTemplate& out_tpl);
     bool LoadInstance(const std::string& yaml_path, SS_LightControllerInstance& out_inst);
     bool SaveInstance(const std::string& yaml_path, const SS_LightControllerInstance& inst);
+    // SaveInstance 拆成两步：序列化成文本（可在锁内做）+ 原子写文件（可在锁外做）
+    bool EncodeInstance(const SS_LightControllerInstance& inst, std::string& out_text);
+    // 先写 <path>.tmp 并刷到磁盘，再整体替换 path；中途失败/断电时 path 保持旧内容
+    bool WriteFileAtomic(const std::string& path, const std::string& text);
+    bool LoadRecipe(const std::string& yaml_path, SS_LightRecipe& out_recipe);
+    bool SaveRecipe(const std::string& yaml_path, const SS_LightRecipe& recipe);
 
     std::string GetLastError() const { return last_error_; }
 
@@ -39,6 +45,7 @@ private:
     static SS_LIGHT_PROTOCOL_TYPE ParseProtocolType(const std::string& s);
     static SS_LIGHT_PARAM_LOCATION ParseParamLocation(const std::string& s);
     static SS_LIGHT_VALUE_TYPE ParseValueType(const std::string& s);
+    static SS_LIGHT_RANGE_POLICY ParseRangePolicy(const std::string& s);
     static SS_LIGHT_WIDGET_TYPE ParseWidgetType(const std::string& s);
 
     static SS_LIGHT_COMMAND_SCOPE ParseCommandScope(const std::string& s);
@@ -20,6 +20,7 @@ static QString ToQString(const std::string& s) { return QString::fromStdString(s
 QWidget* SS_LightParamFormBuilder::Build(const BuildArgs& args, QWidget* parent)
 {
     items_.clear();
+    item_index_.clear();
 
     if (!args.tpl || !args.inst)
         return new QWidget(parent);
@@ -80,6 +81,7 @@ QWidget* SS_LightParamFormBuilder::Build(const BuildArgs& args, QWidget* parent)
             });
         }
 
+        item_index_[item.param_key] = items_.size();
         items_.push_back(item);
         form->addRow(ToQString(label), handle.widget);
     }
@@ -102,23 +104,49 @@ void SS_LightParamFormBuilder::RefreshValues(const SS_LightControllerInstance& i
         // 找 def：Refresh 只刷新值，不重新建控件，所以只能从 inst 读
         if (it.location == SS_LIGHT_PARAM_LOCATION::GLOBAL)
         {
-            auto v = inst.global_param_values.find(it.param_key);
-            if (v != inst.global_param_values.end() && it.handle.set_value)
-                it.handle.set_value(v->second);
+            const std::string* v = inst.param_values.FindGlobal(it.param_key);
+            if (v && it.handle.set_value)
+                it.handle.set_value(*v);
         }
         else if (it.location == SS_LIGHT_PARAM_LOCATION::CHANNEL)
         {
-            auto v = inst.channel_param_values.find(it.param_key);
-            if (v != inst.channel_param_values.end())
-            {
-                auto v2 = v->second.find(it.channel_id);
-                if (v2 != v->second.end() && it.handle.set_value)
-                    it.handle.set_value(v2->second);
-            }
+            const std::string* v = inst.param_values.FindChannel(it.param_key, it.channel_id);
+            if (v && it.handle.set_value)
+                it.handle.set_value(*v);
         }
     }
 }
 
+bool SS_LightParamFormBuilder::ApplyValue(const std::string& instance_id,
+    const std::string& param_key,
+    const std::string& channel_id,
+    const std::string& value)
+{
+    auto found = item_index_.find(param_key);
+    if (found == item_index_.end())
+        return false;
+
+    Item& it = items_[found->second];
+    if (it.instance_id != instance_id || it.channel_id != channel_id)
+        return false;
+
+    if (it.handle.set_value)
+        it.handle.set_value(value);
+    return true;
+}
+
+bool SS_LightParamFormBuilder::RefreshValue(const SS_LightControllerInstance& inst,
+    const std::string& param_key,
+    const std::string& channel_id)
+{
+    const std::string* v = channel_id.empty()
+        ? inst.param_values.FindGlobal(param_key)
+        : inst.param_values.FindChannel(param_key, channel_id);
+    if (!v)
+        return false;
+    return ApplyValue(inst.info.instance_id, param_key, channel_id, *v);
+}
+
 std::string SS_LightParamFormBuilder::GetInitialValue_(
     const SS_LightControllerInstance& inst,
     const SS_LightParamDef& def,
@@ -128,19 +156,13 @@ std::string SS_LightParamFormBuilder::GetInitialValue_(
     // 优先用 instance 里的值
     if (loc == SS_LIGHT_PARAM_LOCATION::GLOBAL)
     {
-        auto it = inst.global_param_values.find(def.key);
-        if (it != inst.global_param_values.end())
-            return it->second;
+        if (const std::string* v = inst.param_values.FindGlobal(def.key))
+            return *v;
     }
     else if (loc == SS_LIGHT_PARAM_LOCATION::CHANNEL)
     {
-        auto it = inst.channel_param_values.find(def.key);
-        if (it != inst.channel_param_values.end())
-        {
-            auto it2 = it->second.find(channel_id);
-            if (it2 != it->second.end())
-                return it2->second;
-        }
+        if (const std::string* v = inst.param_values.FindChannel(def.key, channel_id))
+            return *v;
     }
 
     // fallback：template default
@@ -5,6 +5,7 @@
 
 #include <vector>
 #include <string>
+#include <unordered_map>
 
 #include "ss_light_param_widget_factory.h"
 
@@ -37,6 +38,10 @@ public:
     QWidget* Build(const BuildArgs& args, QWidget* parent);
     void RefreshValues(const SS_LightControllerInstance& inst);
 
+    // 只改一个控件（PARAM_CHANGED 事件 / 单条回滚），不属于本表单时返回 false
+    bool ApplyValue(const std::string& instance_id, const std::string& param_key, const std::string& channel_id, const std::string& value);
+    bool RefreshValue(const SS_LightControllerInstance& inst, const std::string& param_key, const std::string& channel_id);
+
 signals:
     void SignalRequestReady(const SS_LightParamSetRequest& req);
 
@@ -58,5 +63,6 @@ private:
 
 private:
     std::vector<Item> items_;
+    std::unordered_map<std::string, size_t> item_index_; // param_key -> items_ 下标（一个表单只对应一个实例/通道）
     SS_LightParamWidgetFactory factory_;
 };
@@ -29,9 +29,10 @@ bool SS_LightTemplateLeafIndex::BuildFromSystem(SS_LightResourceSystem* system,
     const std::vector<std::string> ids = system->ListTemplateIds();
     for (const auto& id : ids)
     {
-        SS_LightControllerTemplate tpl;
-        if (!system->GetTemplate(id, tpl))
+        const std::shared_ptr<const SS_LightControllerTemplate> handle = system->GetTemplateShared(id);
+        if (!handle)
             continue;
+        const SS_LightControllerTemplate& tpl = *handle;
 
         // 一个模板可能支持多个 connect_types，把它“展开成多个叶子”
         if (tpl.info.connect_types.empty())
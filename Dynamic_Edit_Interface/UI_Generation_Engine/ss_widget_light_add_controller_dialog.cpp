@@ -28,10 +28,10 @@ static void FillCommonBaudRates(QComboBox* baud)
 }
 
 // ------------------------------------------------------------
-// 把弹窗选择的连接信息写入 instance.connection
+// 把弹窗选择的连接信息写入 connection 配置（instance.connection 的副本）
 // ------------------------------------------------------------
-static void ApplyConnectionToInstance_(
-    SS_LightControllerInstance& inst,
+static void ApplyConnectionToConfig_(
+    SS_LightConnectionConfig& conn,
     SS_LIGHT_CONNECT_TYPE ct,
     const std::string& com_port,
     int baud_rate,
@@ -39,28 +39,28 @@ static void ApplyConnectionToInstance_(
     int dest_port)
 {
     // connect_type 以弹窗选择为准
-    inst.connection.connect_type = ct;
+    conn.connect_type = ct;
 
     // 改配置后，连接状态肯定要归零，避免 UI 假装已连接
-    inst.connection.connect_state = false;
+    conn.connect_state = false;
 
     if (ct == SS_LIGHT_CONNECT_TYPE::SERIAL)
     {
-        inst.connection.serial_parameter.com_port_num = com_port;
-        inst.connection.serial_parameter.baud_rate = baud_rate;
+        conn.serial_parameter.com_port_num = com_port;
+        conn.serial_parameter.baud_rate = baud_rate;
 
         // 模板里没让用户选这些，给个合理默认
-        if (inst.connection.serial_parameter.character_size <= 0)
-            inst.connection.serial_parameter.character_size = 8;
-        if (inst.connection.serial_parameter.stop_bits <= 0)
-            inst.connection.serial_parameter.stop_bits = 1;
+        if (conn.serial_parameter.character_size <= 0)
+            conn.serial_parameter.character_size = 8;
+        if (conn.serial_parameter.stop_bits <= 0)
+            conn.serial_parameter.stop_bits = 1;
         // parity: 0 作为默认（None）
     }
     else if (ct == SS_LIGHT_CONNECT_TYPE::SOCKET)
     {
         // 网口只需要目标IP和目标端口
-        inst.connection.socket_parameter.destination_ip_address = dest_ip;
-        inst.connection.socket_parameter.destination_port = dest_port;
+        conn.socket_parameter.destination_ip_address = dest_ip;
+        conn.socket_parameter.destination_port = dest_port;
 
         // 其它字段暂时不用就别碰（保留已有值）
     }
@@ -162,16 +162,17 @@ void SS_WidgetLightAddControllerDialog::SlotAddClicked()
         return;
     }
 
-    // 2) 取回 instance，写 connection 配置
-    SS_LightControllerInstance inst;
-    if (!system_->GetInstance(instance_id, inst))
+    // 2) 取回 instance，写 connection 配置（只拷贝 connection，不拷贝整个实例）
+    const std::shared_ptr<const SS_LightControllerInstance> snap = system_->GetInstanceShared(instance_id);
+    if (!snap)
     {
         QMessageBox::warning(this, tr("Creation failed"), tr("The instance data cannot be read after creation."));// 创建失败 创建后无法读取实例数据。
         return;
     }
 
-    ApplyConnectionToInstance_(
-        inst,
+    SS_LightConnectionConfig conn = snap->connection;
+    ApplyConnectionToConfig_(
+        conn,
         ct,
         selected_com_port_,
         selected_baud_rate_,
@@ -180,7 +181,7 @@ void SS_WidgetLightAddControllerDialog::SlotAddClicked()
 
     // 3) 写回 runtime（UpdateConnectionConfig）并落盘
     std::string update_err;
-    if (!system_->UpdateConnectionConfig(instance_id, inst.connection, update_err))
+    if (!system_->UpdateConnectionConfig(instance_id, conn, update_err))
     {
         QMessageBox::warning(this, tr("Failed to update connection configuration"), QString::fromStdString(update_err));// 更新连接配置失败
         return;
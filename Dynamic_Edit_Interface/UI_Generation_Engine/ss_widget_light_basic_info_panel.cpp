@@ -41,6 +41,11 @@ void SS_WidgetLightBasicInfoPanel::SetInfo(const SS_LightControllerTemplate& tpl
     SetLine(protocol_value_, ProtocolTypeToText(tpl.info.protocol_type));
 }
 
+void SS_WidgetLightBasicInfoPanel::SetConnectType(SS_LIGHT_CONNECT_TYPE t)
+{
+    SetLine(connect_value_, ConnectTypeToText(t));
+}
+
 void SS_WidgetLightBasicInfoPanel::InitQSS_()
 {
 }
@@ -17,6 +17,8 @@ public:
 
     void Clear();
     void SetInfo(const SS_LightControllerTemplate& tpl, const SS_LightControllerInstance& inst);
+    // 只更新连接方式一行（CONNECTION_CONFIG_CHANGED）
+    void SetConnectType(SS_LIGHT_CONNECT_TYPE t);
 
 private:
     void InitQSS_();
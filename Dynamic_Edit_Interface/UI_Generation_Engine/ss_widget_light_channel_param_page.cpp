@@ -8,11 +8,13 @@
 #include <QtWidgets/QToolButton>
 #include <QtWidgets/QComboBox>
 #include <QtWidgets/QInputDialog>
+#include <QtCore/QTimer>
 
 #include "ss_light_param_form_builder.h"
 
 #include "../../include/Parsing_Engine/ss_light_resource_models.h"
 #include "../../include/Parsing_Engine/ss_light_resource_api.h"
+#include "../../include/Parsing_Engine/ss_light_resource_events.h"
 #include "../../include/Parsing_Engine/ss_light_resource_types.h"
 
 static QString ToQString(const std::string& s) { return QString::fromStdString(s); }
@@ -29,6 +31,8 @@ void SS_WidgetLightChannelParamPage::SetData(const SS_LightControllerTemplate& t
     const SS_LightControllerInstance& inst,
     const std::string& channel_id)
 {
+    FlushPendingNow_();
+
     instance_id_ = inst.info.instance_id;
     channel_id_ = channel_id;
 
@@ -47,34 +51,111 @@ void SS_WidgetLightChannelParamPage::SlotRequestReady(const SS_LightParamSetRequ
     if (!system_)
         return;
 
-    SS_LightParamSetResult result;
-    if (!system_->SetParameterAndSend(req, result))
+    // 连续输入时同一参数只发最新值，其余挂起等链路空闲/到期
+    std::vector<SS_LightCoalescedResult> sent;
+    std::string err;
+    if (!system_->SubmitParameterCoalesced(req, sent, err))
     {
         QMessageBox::warning(this, tr("Fail to send"),// 发送失败
             QStringLiteral("param=%1\nchannel=%2\n%3")
             .arg(ToQString(req.param_key))
             .arg(ToQString(req.channel_id))
-            .arg(ToQString(result.message)));
+            .arg(ToQString(err)));
         return;
     }
 
-    std::string save_err;
-    (void)system_->SaveInstanceById(req.instance_id, save_err);
+    HandleSentResults_(sent);
+
+    if (system_->HasPendingParameterUpdates(req.instance_id) && !flush_timer_->isActive())
+        flush_timer_->start();
+}
+
+void SS_WidgetLightChannelParamPage::SlotFlushTimeout()
+{
+    if (!system_ || !system_->HasPendingParameterUpdates(instance_id_))
+    {
+        flush_timer_->stop();
+        return;
+    }
 
-    SS_LightControllerInstance inst;
-    if (system_->GetInstance(req.instance_id, inst))
-        builder_->RefreshValues(inst);
+    std::vector<SS_LightCoalescedResult> sent;
+    system_->FlushParameterUpdates(instance_id_, false, sent);
+    HandleSentResults_(sent);
+
+    if (!system_->HasPendingParameterUpdates(instance_id_))
+        flush_timer_->stop();
+}
+
+void SS_WidgetLightChannelParamPage::FlushPendingNow_()
+{
+    flush_timer_->stop();
+    if (!system_ || instance_id_.empty() || !system_->HasPendingParameterUpdates(instance_id_))
+        return;
+
+    std::vector<SS_LightCoalescedResult> sent;
+    system_->FlushParameterUpdates(instance_id_, true, sent);
+    HandleSentResults_(sent);
+}
+
+void SS_WidgetLightChannelParamPage::ApplyParamChanged(const SS_LightEventParamChanged& e)
+{
+    if (builder_)
+        builder_->ApplyValue(e.instance_id, e.param_key, e.channel_id, e.value);
+}
+
+void SS_WidgetLightChannelParamPage::HandleSentResults_(const std::vector<SS_LightCoalescedResult>& sent)
+{
+    if (sent.empty())
+        return;
+
+    // 一批里只提示第一条失败，避免拖动时连弹
+    bool any_ok = false;
+    const SS_LightCoalescedResult* first_fail = nullptr;
+    for (const auto& r : sent)
+    {
+        if (r.result.ok) any_ok = true;
+        else if (!first_fail) first_fail = &r;
+    }
+
+    // 拖动时每批都会走到这里：只标记脏，由后台按 debounce 合并写文件（写失败走 INSTANCE_ERROR 事件）
+    if (any_ok)
+    {
+        std::string save_err;
+        (void)system_->SaveInstanceDeferred(sent.front().request.instance_id, save_err);
+    }
+
+    // 写入成功的值等 PARAM_CHANGED 逐个刷新；被拒绝（未写入）的控件按当前快照恢复原值
+    if (builder_ && first_fail)
+    {
+        if (const std::shared_ptr<const SS_LightControllerInstance> snap = system_->GetInstanceShared(instance_id_))
+        {
+            for (const auto& r : sent)
+            {
+                if (!r.result.ok)
+                    builder_->RefreshValue(*snap, r.request.param_key, r.request.channel_id);
+            }
+        }
+    }
+
+    if (first_fail)
+    {
+        QMessageBox::warning(this, tr("Fail to send"),// 发送失败
+            QStringLiteral("param=%1\nchannel=%2\n%3")
+            .arg(ToQString(first_fail->request.param_key))
+            .arg(ToQString(first_fail->request.channel_id))
+            .arg(ToQString(first_fail->result.message)));
+    }
 }
 
 void SS_WidgetLightChannelParamPage::SlotRenameChannelClicked()
 {
     if (!system_) return;
 
-    SS_LightControllerInstance inst;
-    if (!system_->GetInstance(instance_id_, inst))
+    const std::shared_ptr<const SS_LightControllerInstance> snap = system_->GetInstanceShared(instance_id_);
+    if (!snap)
         return;
 
-    const QString cur = ToQString(GetCurrentChannelDisplayName_(inst));
+    const QString cur = ToQString(GetCurrentChannelDisplayName_(*snap));
 
     bool ok = false;
     QString text = QInputDialog::getText(this,
@@ -106,9 +187,10 @@ void SS_WidgetLightChannelParamPage::SlotRenameChannelClicked()
         return;
     }
 
-    // 刷新本页显示
-    if (system_->GetInstance(instance_id_, inst))
+    // 刷新本页显示（改名后发布了新快照，重新取）
+    if (const std::shared_ptr<const SS_LightControllerInstance> updated = system_->GetInstanceShared(instance_id_))
     {
+        const SS_LightControllerInstance& inst = *updated;
         channel_name_value_->setText(ToQString(GetCurrentChannelDisplayName_(inst)));
         title_->setText(tr("Channel parameters:")//通道参数：
             + ToQString(inst.info.display_name)
@@ -171,9 +253,8 @@ void SS_WidgetLightChannelParamPage::SlotChannelIndexChanged(int /*index*/)
     // 这里也通知一下主界面（未来想在树上显示 index 的话就用得上）
     emit SignalChannelUpdated(ToQString(instance_id_), ToQString(channel_id_));
 
-    SS_LightControllerInstance inst;
-    if (system_->GetInstance(instance_id_, inst))
-        builder_->RefreshValues(inst);
+    if (const std::shared_ptr<const SS_LightControllerInstance> snap = system_->GetInstanceShared(instance_id_))
+        builder_->RefreshValues(*snap);
 }
 
 void SS_WidgetLightChannelParamPage::InitQSS_()
@@ -247,6 +328,10 @@ void SS_WidgetLightChannelParamPage::BuildUi_()
 
 void SS_WidgetLightChannelParamPage::InitConnections_()
 {
+    // 合并发送的挂起值由这里补发
+    flush_timer_ = new QTimer(this);
+    flush_timer_->setInterval(20);
+    connect(flush_timer_, &QTimer::timeout, this, &SS_WidgetLightChannelParamPage::SlotFlushTimeout);
 }
 
 void SS_WidgetLightChannelParamPage::RebuildForm_(const SS_LightControllerTemplate& tpl,
@@ -3,6 +3,7 @@
 #include <QtCore/QString>
 
 #include <string>
+#include <vector>
 
 struct SS_LightControllerTemplate;
 struct SS_LightControllerInstance;
@@ -11,9 +12,12 @@ class QLabel;
 class QWidget;
 class QComboBox;
 class QToolButton;
+class QTimer;
 
 class SS_LightResourceSystem;
 struct SS_LightParamSetRequest;
+struct SS_LightCoalescedResult;
+struct SS_LightEventParamChanged;
 
 class SS_LightParamFormBuilder;
 
@@ -27,6 +31,9 @@ public:
     void SetData(const SS_LightControllerTemplate& tpl, const SS_LightControllerInstance& inst, const std::string& channel_id);
     void SetSystem(SS_LightResourceSystem* system) { system_ = system; }
 
+    // PARAM_CHANGED：只改对应控件，不属于本页时忽略
+    void ApplyParamChanged(const SS_LightEventParamChanged& e);
+
 signals:
     // 通知主界面刷新左侧树：更新某个通道的显示名/信息
     void SignalChannelUpdated(const QString& instance_id, const QString& channel_id);
@@ -35,6 +42,7 @@ private slots:
     void SlotRequestReady(const SS_LightParamSetRequest& req);
     void SlotRenameChannelClicked();
     void SlotChannelIndexChanged(int index);
+    void SlotFlushTimeout();
 
 private:
     void InitQSS_();
@@ -44,6 +52,10 @@ private:
     void RefreshTopPanel_(const SS_LightControllerTemplate& tpl, const SS_LightControllerInstance& inst);
     int GetCurrentChannelIndex0_(const SS_LightControllerInstance& inst) const;
     std::string GetCurrentChannelDisplayName_(const SS_LightControllerInstance& inst) const;
+    // 处理合并发送的实际发送结果：报错、落盘一次、回滚被拒绝的控件（写入成功的值由 PARAM_CHANGED 刷新）
+    void HandleSentResults_(const std::vector<SS_LightCoalescedResult>& sent);
+    // 切换实例/通道前把上一个实例的挂起值发掉
+    void FlushPendingNow_();
 
 private:
     // ---- top panel widgets ----
@@ -59,6 +71,9 @@ private:
     QWidget* form_holder_ = nullptr;
     SS_LightParamFormBuilder* builder_ = nullptr;
 
+    // ---- coalescing ----
+    QTimer* flush_timer_ = nullptr;
+
     // ---- state ----
     SS_LightResourceSystem* system_ = nullptr;
     std::string instance_id_;
@@ -1,6 +1,12 @@
 #include "ss_widget_light_connection_panel.h"
 #include "moc/moc_ss_widget_light_connection_panel.cpp"
 
+#include <algorithm>
+
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QStringList>
+#include <QtConcurrent/QtConcurrentRun>
+
 #include <QtWidgets/QGroupBox>
 #include <QtWidgets/QVBoxLayout>
 #include <QtWidgets/QHBoxLayout>
@@ -22,6 +28,13 @@
 static QString ToQString(const std::string& s) { return QString::fromStdString(s); }
 static std::string ToStdString(const QString& s) { return s.toStdString(); }
 
+struct SS_WidgetLightConnectionPanel::DiscoveryResult_
+{
+    bool ok = false;
+    std::vector<SS_LightDiscoveryCandidate> candidates;
+    std::string err;
+};
+
 SS_WidgetLightConnectionPanel::SS_WidgetLightConnectionPanel(QWidget* parent)
     : QWidget(parent)
 {
@@ -29,6 +42,13 @@ SS_WidgetLightConnectionPanel::SS_WidgetLightConnectionPanel(QWidget* parent)
     InitConnections_();
 }
 
+SS_WidgetLightConnectionPanel::~SS_WidgetLightConnectionPanel()
+{
+    // 探测不能中途取消；最长为各候选的 identify.timeout_ms / connect 超时
+    if (discover_watcher_)
+        discover_watcher_->waitForFinished();
+}
+
 void SS_WidgetLightConnectionPanel::SetInstance(const SS_LightControllerInstance& inst)
 {
     instance_id_ = inst.info.instance_id;
@@ -38,6 +58,14 @@ void SS_WidgetLightConnectionPanel::SetInstance(const SS_LightControllerInstance
     name_label_->setText(tr("Controller:") + ToQString(display_name_));//控制器：
 
     SetUiFromConnection_(inst.connection);
+    UpdateDiscoverButton_(inst.info.template_id);
+}
+
+void SS_WidgetLightConnectionPanel::UpdateDiscoverButton_(const std::string& template_id)
+{
+    const std::shared_ptr<const SS_LightControllerTemplate> tpl =
+        system_ ? system_->GetTemplateShared(template_id) : nullptr;
+    discover_btn_->setVisible(tpl && !tpl->info.identify.request.empty());
 }
 
 void SS_WidgetLightConnectionPanel::SlotConnectTypeChanged(int index)
@@ -51,14 +79,14 @@ void SS_WidgetLightConnectionPanel::SlotApplyClicked()
         return;
 
     // 从 core 拉一次 instance，保留 UI 没显示的字段（byte_transmission_params 等）
-    SS_LightControllerInstance inst;
-    if (!system_->GetInstance(instance_id_, inst))
+    const std::shared_ptr<const SS_LightControllerInstance> snap = system_->GetInstanceShared(instance_id_);
+    if (!snap)
     {
         QMessageBox::warning(this, tr("Error"), tr("GetInstance failed"));//错误 GetInstance 失败
         return;
     }
 
-    SS_LightConnectionConfig new_conn = inst.connection;
+    SS_LightConnectionConfig new_conn = snap->connection;
     ReadUiToConnection_(new_conn);
 
     std::string err;
@@ -142,6 +170,121 @@ void SS_WidgetLightConnectionPanel::SlotRenameClicked()
     emit SignalConnectionUpdated(instance_id_);
 }
 
+void SS_WidgetLightConnectionPanel::SlotDiscoverClicked()
+{
+    if (!system_ || instance_id_.empty())
+        return;
+    if (discover_watcher_ && discover_watcher_->isRunning())
+        return;
+
+    const std::shared_ptr<const SS_LightControllerInstance> snap = system_->GetInstanceShared(instance_id_);
+    std::shared_ptr<const SS_LightControllerTemplate> handle;
+    if (!snap || !(handle = system_->GetTemplateShared(snap->info.template_id)))
+    {
+        QMessageBox::warning(this, tr("Error"), tr("GetInstance failed"));//错误 GetInstance 失败
+        return;
+    }
+    const SS_LightControllerInstance& inst = *snap;
+    const SS_LightControllerTemplate& tpl = *handle;
+    if (tpl.info.identify.request.empty())
+    {
+        //该型号模板未配置识别命令（template_info.identify）
+        QMessageBox::information(this, tr("Discover"), tr("This controller template has no identify command (template_info.identify)."));
+        return;
+    }
+
+    // 只探测当前型号；网段取实例的本机 IP/掩码，没有则按目标 IP 所在 /24
+    SS_LightDiscoveryOptions opts;
+    opts.template_ids.push_back(tpl.info.template_id);
+    opts.serial_format = inst.connection.serial_parameter;
+
+    SS_LightSocketConfig subnet = inst.connection.socket_parameter;
+    subnet.destination_port = 0;
+    if (subnet.ip_address.empty() || subnet.subnet_mask.empty())
+    {
+        subnet.ip_address = inst.connection.socket_parameter.destination_ip_address;
+        subnet.subnet_mask = "255.255.255.0";
+    }
+    if (!subnet.ip_address.empty() && tpl.info.identify.tcp_port > 0)
+        opts.subnets.push_back(subnet);
+
+    discover_btn_->setEnabled(false);
+    discover_btn_->setText(tr("Discovering..."));//探测中...
+
+    // 探测阻塞数秒：放到工作线程；面板析构时等它结束，finished 在 UI 线程触发
+    if (!discover_watcher_)
+    {
+        discover_watcher_ = new QFutureWatcher<void>(this);
+        connect(discover_watcher_, &QFutureWatcher<void>::finished, this, [this]() {
+            std::shared_ptr<DiscoveryResult_> r;
+            r.swap(discover_result_);
+            if (r) OnDiscoveryFinished_(r->ok, r->candidates, r->err);
+        });
+    }
+
+    auto result = std::make_shared<DiscoveryResult_>();
+    discover_result_ = result;
+    SS_LightResourceSystem* system = system_;
+    discover_watcher_->setFuture(QtConcurrent::run([system, opts, result]() {
+        result->ok = system->DiscoverDevices(opts, result->candidates, result->err);
+    }));
+}
+
+void SS_WidgetLightConnectionPanel::OnDiscoveryFinished_(
+    bool ok,
+    const std::vector<SS_LightDiscoveryCandidate>& candidates,
+    const std::string& err)
+{
+    discover_btn_->setEnabled(true);
+    discover_btn_->setText(tr("Discover"));//自动发现
+
+    if (!ok)
+    {
+        QMessageBox::warning(this, tr("Discover failed"), ToQString(err));//自动发现失败
+        return;
+    }
+    if (candidates.empty())
+    {
+        QMessageBox::information(this, tr("Discover"), tr("No device found."));//未发现设备
+        return;
+    }
+
+    size_t pick = 0;
+    if (candidates.size() > 1)
+    {
+        QStringList items;
+        for (const auto& c : candidates)
+        {
+            const auto& conn = c.connection;
+            if (conn.connect_type == SS_LIGHT_CONNECT_TYPE::SERIAL)
+                items << QString("SERIAL %1 @ %2").arg(ToQString(conn.serial_parameter.com_port_num)).arg(conn.serial_parameter.baud_rate);
+            else
+                items << QString("SOCKET %1:%2").arg(ToQString(conn.socket_parameter.destination_ip_address)).arg(conn.socket_parameter.destination_port);
+        }
+
+        bool sel_ok = false;
+        const QString sel = QInputDialog::getItem(
+            this, tr("Discover"), tr("Select a device:"), items, 0, false, &sel_ok);//选择设备：
+        if (!sel_ok)
+            return;
+        pick = static_cast<size_t>(std::max(0, items.indexOf(sel)));
+    }
+
+    // 只改命中的那一侧参数，另一侧保留界面上的值；用户确认后点“应用并保存”
+    const SS_LightConnectionConfig& found = candidates[pick].connection;
+    SS_LightConnectionConfig merged;
+    ReadUiToConnection_(merged);
+    merged.connect_type = found.connect_type;
+    if (found.connect_type == SS_LIGHT_CONNECT_TYPE::SERIAL)
+        merged.serial_parameter = found.serial_parameter;
+    else
+    {
+        merged.socket_parameter.destination_ip_address = found.socket_parameter.destination_ip_address;
+        merged.socket_parameter.destination_port = found.socket_parameter.destination_port;
+    }
+    SetUiFromConnection_(merged);
+}
+
 void SS_WidgetLightConnectionPanel::InitQSS_()
 {
 }
@@ -176,12 +319,15 @@ void SS_WidgetLightConnectionPanel::BuildUi_()
     apply_btn_ = new QPushButton(tr("Apply and save"), group_);//应用并保存
     connect_btn_ = new QPushButton(tr("Connect"), group_);//连接
     disconnect_btn_ = new QPushButton(tr("Disconnect"), group_);//断开
+    discover_btn_ = new QPushButton(tr("Discover"), group_);//自动发现
+    discover_btn_->setToolTip(tr("Probe serial ports and the local subnet for this controller model"));//按当前型号探测串口和本网段
 
     top->addWidget(name_label_, 1);
     top->addWidget(rename_btn_);
     top->addWidget(new QLabel(tr("Mode:"), group_));//方式：
     top->addWidget(connect_type_combo_);
     top->addStretch();
+    top->addWidget(discover_btn_);
     top->addWidget(apply_btn_);
     top->addWidget(connect_btn_);
     top->addWidget(disconnect_btn_);
@@ -252,6 +398,7 @@ void SS_WidgetLightConnectionPanel::InitConnections_()
     connect(apply_btn_, &QPushButton::clicked, this, &SS_WidgetLightConnectionPanel::SlotApplyClicked);
     connect(connect_btn_, &QPushButton::clicked, this, &SS_WidgetLightConnectionPanel::SlotConnectClicked);
     connect(disconnect_btn_, &QPushButton::clicked, this, &SS_WidgetLightConnectionPanel::SlotDisconnectClicked);
+    connect(discover_btn_, &QPushButton::clicked, this, &SS_WidgetLightConnectionPanel::SlotDiscoverClicked);
     connect(rename_btn_, &QToolButton::clicked, this, &SS_WidgetLightConnectionPanel::SlotRenameClicked);
 }
 
@@ -283,7 +430,12 @@ void SS_WidgetLightConnectionPanel::SetUiFromConnection_(const SS_LightConnectio
 
 void SS_WidgetLightConnectionPanel::ReadUiToConnection_(SS_LightConnectionConfig& out_conn) const
 {
+    // 低延迟配置 / 连接超时不在面板上编辑，保留原值
+    const SS_LightSocketLatencyProfile keep_profile = out_conn.socket_parameter.latency_profile;
+    const int keep_timeout_ms = out_conn.socket_parameter.connect_timeout_ms;
     out_conn = SS_LightConnectionConfig{};
+    out_conn.socket_parameter.latency_profile = keep_profile;
+    out_conn.socket_parameter.connect_timeout_ms = keep_timeout_ms;
 
     const int idx = connect_type_combo_->currentIndex();
     out_conn.connect_type = (idx == 1) ? SS_LIGHT_CONNECT_TYPE::SOCKET : SS_LIGHT_CONNECT_TYPE::SERIAL;
@@ -308,15 +460,8 @@ void SS_WidgetLightConnectionPanel::BuildBaudRateOptions_()
 
     serial_baud_combo_->clear();
 
-    // 市面常见/主流波特率（覆盖串口设备常用范围）
-    const int baud_list[] = {
-        1200, 2400, 4800, 9600,
-        14400, 19200, 38400,
-        57600, 115200,
-        230400, 460800, 921600
-    };
-
-    for (int b : baud_list)
+    // 市面常见/主流波特率（覆盖串口设备常用范围；与自动发现的默认扫描列表一致）
+    for (int b : SS_LightCommonBaudRates())
         serial_baud_combo_->addItem(QString::number(b));
 
     // 可编辑：方便遇到奇葩设备（比如 250000 这种）
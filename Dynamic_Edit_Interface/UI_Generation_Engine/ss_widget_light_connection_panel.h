@@ -2,7 +2,9 @@
 #include <QtWidgets/QWidget>
 #include <QtCore/QString>
 
+#include <memory>
 #include <string>
+#include <vector>
 
 class QGroupBox;
 class QComboBox;
@@ -13,17 +15,20 @@ class QLabel;
 class QLineEdit;
 class QSpinBox;
 class QToolButton;
+template <typename T> class QFutureWatcher;
 
 class SS_LightResourceSystem;
 struct SS_LightControllerInstance;
 struct SS_LightConnectionConfig;
+struct SS_LightDiscoveryCandidate;
 
 class SS_WidgetLightConnectionPanel : public QWidget
 {
     Q_OBJECT
 public:
     explicit SS_WidgetLightConnectionPanel(QWidget* parent = nullptr);
-    ~SS_WidgetLightConnectionPanel() override = default;
+    // 等待进行中的自动发现结束（工作线程用到 system_）
+    ~SS_WidgetLightConnectionPanel() override;
 
     void SetSystem(SS_LightResourceSystem* system) { system_ = system; }
     void SetInstance(const SS_LightControllerInstance& inst); // 用 instance 来刷新显示
@@ -37,6 +42,7 @@ private slots:
     void SlotConnectClicked();
     void SlotDisconnectClicked();
     void SlotRenameClicked();// 改名按钮
+    void SlotDiscoverClicked();// 自动发现
 
 private:
     void InitQSS_();
@@ -45,6 +51,11 @@ private:
     void SetUiFromConnection_(const SS_LightConnectionConfig& conn);
     void ReadUiToConnection_(SS_LightConnectionConfig& out_conn) const;
 
+    // 自动发现结果回到 UI 线程后：选一个候选填到界面（不自动保存）
+    void OnDiscoveryFinished_(bool ok, const std::vector<SS_LightDiscoveryCandidate>& candidates, const std::string& err);
+    // 模板没有 identify 规则时不显示“自动发现”
+    void UpdateDiscoverButton_(const std::string& template_id);
+
     void BuildBaudRateOptions_();
     void SelectBaudRate_(int baud);
 
@@ -64,6 +75,12 @@ private:
     QPushButton* apply_btn_ = nullptr;
     QPushButton* connect_btn_ = nullptr;
     QPushButton* disconnect_btn_ = nullptr;
+    QPushButton* discover_btn_ = nullptr;
+
+    // 自动发现：工作线程由 watcher 跟踪，结果写进 discover_result_，finished 后在 UI 线程读取
+    struct DiscoveryResult_;
+    QFutureWatcher<void>* discover_watcher_ = nullptr;
+    std::shared_ptr<DiscoveryResult_> discover_result_;
 
     // SERIAL/SOCKET 区域切换
     QStackedWidget* stack_ = nullptr;
@@ -4,12 +4,14 @@
 #include <QtWidgets/QVBoxLayout>
 #include <QtWidgets/QLabel>
 #include <QtWidgets/QMessageBox>
+#include <QtCore/QTimer>
 
 #include "ss_light_param_form_builder.h"
 #include "ss_widget_light_connection_panel.h"
 
 #include "../../include/Parsing_Engine/ss_light_resource_models.h"
 #include "../../include/Parsing_Engine/ss_light_resource_api.h"
+#include "../../include/Parsing_Engine/ss_light_resource_events.h"
 #include "../../include/Parsing_Engine/ss_light_resource_types.h"
 
 static QString ToQString(const std::string& s) { return QString::fromStdString(s); }
@@ -25,6 +27,8 @@ SS_WidgetLightControllerParamPage::SS_WidgetLightControllerParamPage(QWidget* pa
 void SS_WidgetLightControllerParamPage::SetData(const SS_LightControllerTemplate& tpl,
     const SS_LightControllerInstance& inst)
 {
+    FlushPendingNow_();
+
     instance_id_ = inst.info.instance_id;
 
     RefreshTitle_(inst);
@@ -42,22 +46,98 @@ void SS_WidgetLightControllerParamPage::SlotRequestReady(const SS_LightParamSetR
     if (!system_)
         return;
 
-    SS_LightParamSetResult result;
-    if (!system_->SetParameterAndSend(req, result))
+    // 连续输入时同一参数只发最新值，其余挂起等链路空闲/到期
+    std::vector<SS_LightCoalescedResult> sent;
+    std::string err;
+    if (!system_->SubmitParameterCoalesced(req, sent, err))
     {
         QMessageBox::warning(this, tr("Fail to send"),//发送失败
             QStringLiteral("param=%1\n%2")
             .arg(ToQString(req.param_key))
-            .arg(ToQString(result.message)));
+            .arg(ToQString(err)));
+        return;
+    }
+
+    HandleSentResults_(sent);
+
+    if (system_->HasPendingParameterUpdates(req.instance_id) && !flush_timer_->isActive())
+        flush_timer_->start();
+}
+
+void SS_WidgetLightControllerParamPage::SlotFlushTimeout()
+{
+    if (!system_ || !system_->HasPendingParameterUpdates(instance_id_))
+    {
+        flush_timer_->stop();
         return;
     }
 
-    std::string save_err;
-    (void)system_->SaveInstanceById(req.instance_id, save_err);
+    std::vector<SS_LightCoalescedResult> sent;
+    system_->FlushParameterUpdates(instance_id_, false, sent);
+    HandleSentResults_(sent);
 
-    SS_LightControllerInstance inst;
-    if (system_->GetInstance(req.instance_id, inst))
-        builder_->RefreshValues(inst);
+    if (!system_->HasPendingParameterUpdates(instance_id_))
+        flush_timer_->stop();
+}
+
+void SS_WidgetLightControllerParamPage::FlushPendingNow_()
+{
+    flush_timer_->stop();
+    if (!system_ || instance_id_.empty() || !system_->HasPendingParameterUpdates(instance_id_))
+        return;
+
+    std::vector<SS_LightCoalescedResult> sent;
+    system_->FlushParameterUpdates(instance_id_, true, sent);
+    HandleSentResults_(sent);
+}
+
+void SS_WidgetLightControllerParamPage::ApplyParamChanged(const SS_LightEventParamChanged& e)
+{
+    if (builder_)
+        builder_->ApplyValue(e.instance_id, e.param_key, e.channel_id, e.value);
+}
+
+void SS_WidgetLightControllerParamPage::HandleSentResults_(const std::vector<SS_LightCoalescedResult>& sent)
+{
+    if (sent.empty())
+        return;
+
+    // 一批里只提示第一条失败，避免拖动时连弹
+    bool any_ok = false;
+    const SS_LightCoalescedResult* first_fail = nullptr;
+    for (const auto& r : sent)
+    {
+        if (r.result.ok) any_ok = true;
+        else if (!first_fail) first_fail = &r;
+    }
+
+    // 拖动时每批都会走到这里：只标记脏，由后台按 debounce 合并写文件（写失败走 INSTANCE_ERROR 事件）
+    if (any_ok)
+    {
+        std::string save_err;
+        (void)system_->SaveInstanceDeferred(sent.front().request.instance_id, save_err);
+    }
+
+    // 写入成功的值等 PARAM_CHANGED 逐个刷新；被拒绝（未写入）的控件按当前快照恢复原值
+    if (builder_ && first_fail)
+    {
+        if (const std::shared_ptr<const SS_LightControllerInstance> snap = system_->GetInstanceShared(instance_id_))
+        {
+            for (const auto& r : sent)
+            {
+                if (!r.result.ok)
+                    builder_->RefreshValue(*snap, r.request.param_key, r.request.channel_id);
+            }
+        }
+    }
+
+    if (first_fail)
+    {
+        QMessageBox::warning(this, tr("Fail to send"),//发送失败
+            QStringLiteral("param=%1\n%2")
+            .arg(ToQString(first_fail->request.param_key))
+            .arg(ToQString(first_fail->result.message)));
+    }
 }
 
 void SS_WidgetLightControllerParamPage::SlotConnectionUpdated(const std::string& instance_id)
@@ -65,9 +145,10 @@ void SS_WidgetLightControllerParamPage::SlotConnectionUpdated(const std::string&
     if (!system_)
         return;
 
-    SS_LightControllerInstance inst;
-    if (!system_->GetInstance(instance_id, inst))
+    const std::shared_ptr<const SS_LightControllerInstance> snap = system_->GetInstanceShared(instance_id);
+    if (!snap)
         return;
+    const SS_LightControllerInstance& inst = *snap;
 
     // 侧标题立即刷新
     RefreshTitle_(inst);
@@ -113,6 +194,9 @@ void SS_WidgetLightControllerParamPage::BuildUi_()
 
 void SS_WidgetLightControllerParamPage::InitConnections_()
 {
+    flush_timer_ = new QTimer(this);
+    flush_timer_->setInterval(20);
+    connect(flush_timer_, &QTimer::timeout, this, &SS_WidgetLightControllerParamPage::SlotFlushTimeout);
 }
 
 void SS_WidgetLightControllerParamPage::RebuildForm_(const SS_LightControllerTemplate& tpl,
@@ -1,14 +1,18 @@
 #pragma once
 #include <QtWidgets/QWidget>
 #include <string>
+#include <vector>
 
 struct SS_LightControllerTemplate;
 struct SS_LightControllerInstance;
 struct SS_LightParamSetRequest;
+struct SS_LightCoalescedResult;
+struct SS_LightEventParamChanged;
 
 class QLabel;
 class QWidget;
 class QVBoxLayout;
+class QTimer;
 
 class SS_LightResourceSystem;
 
@@ -23,6 +27,9 @@ public:
     ~SS_WidgetLightControllerParamPage() override = default;
 
     void SetSystem(SS_LightResourceSystem* system) { system_ = system; }
+
+    // PARAM_CHANGED：只改对应控件，不属于本页时忽略
+    void ApplyParamChanged(const SS_LightEventParamChanged& e);
     void SetData(const SS_LightControllerTemplate& tpl, const SS_LightControllerInstance& inst);
 
 signals:
@@ -32,6 +39,7 @@ signals:
 private slots:
     void SlotRequestReady(const SS_LightParamSetRequest& req);
     void SlotConnectionUpdated(const std::string& instance_id);
+    void SlotFlushTimeout();
 
 private:
     void InitQSS_();
@@ -40,6 +48,10 @@ private:
     void RebuildForm_(const SS_LightControllerTemplate& tpl, const SS_LightControllerInstance& inst);
     void ClearParamsArea_();
     void RefreshTitle_(const SS_LightControllerInstance& inst);
+    // 处理合并发送的实际发送结果：报错、落盘一次、回滚被拒绝的控件（写入成功的值由 PARAM_CHANGED 刷新）
+    void HandleSentResults_(const std::vector<SS_LightCoalescedResult>& sent);
+    // 切换实例前把上一个实例的挂起值发掉
+    void FlushPendingNow_();
 
 private:
     QLabel* title_ = nullptr;
@@ -54,6 +66,9 @@ private:
 
     SS_LightParamFormBuilder* builder_ = nullptr;
 
+    // 合并发送的挂起值定时补发
+    QTimer* flush_timer_ = nullptr;
+
     SS_LightResourceSystem* system_ = nullptr;
     std::string instance_id_;
 };
@@ -110,6 +110,26 @@ void SS_WidgetLightControllerTree::AddChannel(const std::string& instance_id,
     ctrl->setExpanded(true);
 }
 
+bool SS_WidgetLightControllerTree::RemoveChannel(const QString& instance_id, const QString& channel_id)
+{
+    QTreeWidgetItem* ctrl = FindControllerItem(instance_id);
+    if (!ctrl)
+        return false;
+
+    for (int i = 0; i < ctrl->childCount(); ++i)
+    {
+        QTreeWidgetItem* ch = ctrl->child(i);
+        if (!ch) continue;
+        if (ch->data(0, kRoleType).toInt() == (int)SS_TREE_ITEM_TYPE::CHANNEL &&
+            ch->data(0, kRoleChannelId).toString() == channel_id)
+        {
+            delete ctrl->takeChild(i);
+            return true;
+        }
+    }
+    return false;
+}
+
 void SS_WidgetLightControllerTree::Clear()
 {
     tree_->clear();
@@ -18,6 +18,7 @@ public:
 
     void AddController(const std::string& instance_id, const std::string& display_name, bool connected);
     void AddChannel(const std::string& instance_id, const std::string& channel_id, const std::string& channel_display_name);
+    bool RemoveChannel(const QString& instance_id, const QString& channel_id);
     void Clear();
 
     // 外部按 instance_id 选中控制器（用于新增后自动定位、重命名后保持选中等）
@@ -9,6 +9,7 @@
 
 #include "../../include/Parsing_Engine/ss_light_resource_models.h"
 #include "../../include/Parsing_Engine/ss_light_resource_api.h"
+#include "../../include/Parsing_Engine/ss_light_resource_events.h"
 
 SS_WidgetLightParamHost::SS_WidgetLightParamHost(QWidget* parent)
     : QWidget(parent)
@@ -94,6 +95,37 @@ void SS_WidgetLightParamHost::ShowChannelParams(const SS_LightControllerTemplate
     stacked_->setCurrentWidget(page);
 }
 
+void SS_WidgetLightParamHost::ApplyParamChanged(const SS_LightEventParamChanged& e)
+{
+    if (e.location == SS_LIGHT_PARAM_LOCATION::CHANNEL)
+    {
+        auto it = pages_.find(MakeChannelKey(e.instance_id, e.channel_id));
+        if (it == pages_.end()) return;
+        if (auto* page = qobject_cast<SS_WidgetLightChannelParamPage*>(it->second))
+            page->ApplyParamChanged(e);
+        return;
+    }
+
+    auto it = pages_.find(MakeControllerKey(e.instance_id));
+    if (it == pages_.end()) return;
+    if (auto* page = qobject_cast<SS_WidgetLightControllerParamPage*>(it->second))
+        page->ApplyParamChanged(e);
+}
+
+void SS_WidgetLightParamHost::RemoveChannelPage(const std::string& instance_id, const std::string& channel_id)
+{
+    auto it = pages_.find(MakeChannelKey(instance_id, channel_id));
+    if (it == pages_.end()) return;
+
+    QWidget* w = it->second;
+    pages_.erase(it);
+    if (w)
+    {
+        stacked_->removeWidget(w);
+        w->deleteLater();
+    }
+}
+
 void SS_WidgetLightParamHost::InitQSS_()
 {
 }
@@ -11,6 +11,7 @@ class SS_LightResourceSystem;
 
 struct SS_LightControllerTemplate;
 struct SS_LightControllerInstance;
+struct SS_LightEventParamChanged;
 
 class SS_WidgetLightControllerParamPage;
 class SS_WidgetLightChannelParamPage;
@@ -29,6 +30,11 @@ public:
     void ShowControllerParams(const SS_LightControllerTemplate& tpl, const SS_LightControllerInstance& inst);
     void ShowChannelParams(const SS_LightControllerTemplate& tpl, const SS_LightControllerInstance& inst, const std::string& channel_id);
 
+    // 模型变更补丁：按 key 直接找到缓存的页面，只改受影响的控件
+    void ApplyParamChanged(const SS_LightEventParamChanged& e);
+    // 通道被删除：丢掉它的缓存页面
+    void RemoveChannelPage(const std::string& instance_id, const std::string& channel_id);
+
 private:
     void InitQSS_();
     void BuildUi_();
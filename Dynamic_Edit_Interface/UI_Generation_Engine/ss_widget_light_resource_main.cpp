@@ -59,6 +59,11 @@ void SS_WidgetLightResourceMain::SetSystem(SS_LightResourceSystem* system)
             OnLightEventUiThread_(ev);
         }, Qt::QueuedConnection);
     });
+
+    // 启动时后台并发连接所有启用的控制器，不阻塞 UI；进度显示在列表标题上
+    std::string conn_err;
+    if (!system_->ConnectAll(SS_LightConnectBatchOptions{}, connect_batch_id_, conn_err))
+        connect_batch_id_ = 0;
 }
 
 bool SS_WidgetLightResourceMain::RefreshControllers(QString& out_error)
@@ -76,9 +81,10 @@ bool SS_WidgetLightResourceMain::RefreshControllers(QString& out_error)
     std::vector<std::string> instance_ids = system_->ListInstanceIds();
     for (const auto& id : instance_ids)
     {
-        SS_LightControllerInstance inst;
-        if (!system_->GetInstance(id, inst))
+        const std::shared_ptr<const SS_LightControllerInstance> snap = system_->GetInstanceShared(id);
+        if (!snap)
             continue;
+        const SS_LightControllerInstance& inst = *snap;
 
         controller_tree_->AddController(
             inst.info.instance_id,
@@ -166,13 +172,14 @@ void SS_WidgetLightResourceMain::SlotAddChannelClicked(const QString& instance_i
     }
 
     // 3) 重新拉 instance 拿 display_name
-    SS_LightControllerInstance inst;
-    if (!system_->GetInstance(inst_id, inst))
+    const std::shared_ptr<const SS_LightControllerInstance> snap = system_->GetInstanceShared(inst_id);
+    if (!snap)
     {
         QMessageBox::warning(this, tr("Error"),// 错误
             tr("Adding the channel was successful, but refreshing the instance failed: GetInstance() failed."));//添加通道成功但刷新实例失败：GetInstance() 失败。
         return;
     }
+    const SS_LightControllerInstance& inst = *snap;
 
     std::string channel_display_name = new_channel_id;
     for (const auto& ch : inst.channels)
@@ -198,48 +205,6 @@ void SS_WidgetLightResourceMain::SlotAddChannelClicked(const QString& instance_i
     }
 }
 
-void SS_WidgetLightResourceMain::SlotInstanceUpdated(const QString& instance_id)
-{
-    if (!system_ || !controller_tree_)
-        return;
-
-    SS_LightControllerInstance inst;
-    if (!system_->GetInstance(instance_id.toStdString(), inst))
-        return;
-
-    controller_tree_->UpdateControllerTitle(instance_id, ToQString(inst.info.display_name));
-
-
-    // 如果当前右侧正显示这个控制器页，顺手刷新
-    if (current_instance_id_ == instance_id && current_channel_id_.isEmpty())
-    {
-        QString err;
-        (void)ShowController(instance_id, err);
-    }
-}
-
-void SS_WidgetLightResourceMain::SlotChannelUpdated(const QString& instance_id, const QString& channel_id)
-{
-    if (!system_ || !controller_tree_)
-        return;
-
-    SS_LightControllerInstance inst;
-    if (!system_->GetInstance(instance_id.toStdString(), inst))
-        return;
-
-    std::string name = channel_id.toStdString();
-    for (const auto& ch : inst.channels)
-    {
-        if (ch.channel_id == channel_id.toStdString())
-        {
-            name = ch.display_name;
-            break;
-        }
-    }
-
-    controller_tree_->AddChannel(inst.info.instance_id, channel_id.toStdString(), name);
-}
-
 void SS_WidgetLightResourceMain::InitQSS()
 {
 }
@@ -314,10 +279,8 @@ void SS_WidgetLightResourceMain::InitConnections()
     connect(controller_tree_, &SS_WidgetLightControllerTree::SignalAddChannelClicked,
         this, &SS_WidgetLightResourceMain::SlotAddChannelClicked);
 
-    connect(param_host_, &SS_WidgetLightParamHost::SignalChannelUpdated,
-        this, &SS_WidgetLightResourceMain::SlotChannelUpdated);
-    connect(param_host_, &SS_WidgetLightParamHost::SignalInstanceUpdated,
-        this, &SS_WidgetLightResourceMain::SlotInstanceUpdated);
+    // 控制器/通道改名、改通道号、改连接配置后的刷新由模型变更事件驱动（HandleEvent_），
+    // 不再监听 param_host_ 的 SignalInstanceUpdated / SignalChannelUpdated 整体重拉
 }
 
 void SS_WidgetLightResourceMain::ClearUiState()
@@ -340,19 +303,21 @@ bool SS_WidgetLightResourceMain::ShowController(const QString& instance_id, QStr
         return false;
     }
 
-    SS_LightControllerInstance inst;
-    if (!system_->GetInstance(ToStdString(instance_id), inst))
+    const std::shared_ptr<const SS_LightControllerInstance> snap = system_->GetInstanceShared(ToStdString(instance_id));
+    if (!snap)
     {
         out_error = "ShowController: GetInstance failed: " + instance_id;
         return false;
     }
+    const SS_LightControllerInstance& inst = *snap;
 
-    SS_LightControllerTemplate tpl;
-    if (!system_->GetTemplate(inst.info.template_id, tpl))
+    const std::shared_ptr<const SS_LightControllerTemplate> handle = system_->GetTemplateShared(inst.info.template_id);
+    if (!handle)
     {
         out_error = "ShowController: GetTemplate failed: " + ToQString(inst.info.template_id);
         return false;
     }
+    const SS_LightControllerTemplate& tpl = *handle;
 
     if (basic_info_panel_) basic_info_panel_->SetInfo(tpl, inst);
     if (param_host_) param_host_->ShowControllerParams(tpl, inst);
@@ -372,19 +337,21 @@ bool SS_WidgetLightResourceMain::ShowChannel(const QString& instance_id, const Q
         return false;
     }
 
-    SS_LightControllerInstance inst;
-    if (!system_->GetInstance(ToStdString(instance_id), inst))
+    const std::shared_ptr<const SS_LightControllerInstance> snap = system_->GetInstanceShared(ToStdString(instance_id));
+    if (!snap)
     {
         out_error = "ShowChannel: GetInstance failed: " + instance_id;
         return false;
     }
+    const SS_LightControllerInstance& inst = *snap;
 
-    SS_LightControllerTemplate tpl;
-    if (!system_->GetTemplate(inst.info.template_id, tpl))
+    const std::shared_ptr<const SS_LightControllerTemplate> handle = system_->GetTemplateShared(inst.info.template_id);
+    if (!handle)
     {
         out_error = "ShowChannel: GetTemplate failed: " + ToQString(inst.info.template_id);
         return false;
     }
+    const SS_LightControllerTemplate& tpl = *handle;
 
     if (basic_info_panel_) basic_info_panel_->SetInfo(tpl, inst);
     if (param_host_) param_host_->ShowChannelParams(tpl, inst, ToStdString(channel_id));
@@ -414,10 +381,38 @@ void SS_WidgetLightResourceMain::HandleEvent_(const SS_LightEventConnect& e)
     // 需要的话，把 e.message 打到日志面板
 }
 
+void SS_WidgetLightResourceMain::HandleEvent_(const SS_LightEventConnectBatch& e)
+{
+    if (!group_list_ || e.batch_id != connect_batch_id_) return;
+
+    if (e.type == SS_LightEventType::CONNECT_BATCH_FINISHED)
+    {
+        group_list_->setTitle(tr("List of Light Sources"));//光源列表
+        connect_batch_id_ = 0;
+        return;
+    }
+
+    //光源列表（连接中 done/total，失败 n）
+    group_list_->setTitle(tr("List of Light Sources (connecting %1/%2, failed %3)")
+        .arg(e.done).arg(e.total).arg(e.failed));
+}
+
 void SS_WidgetLightResourceMain::HandleEvent_(const SS_LightEventError& e)
 {
+    // 修改日志写不进磁盘：退回每次修改同步写 YAML（关闭日志前会先把已记录的修改折叠进 YAML）
+    if (e.code == SS_LIGHT_PERSIST_JOURNAL_FAILED && system_)
+    {
+        SS_LightPersistOptions opts;
+        system_->GetPersistOptions(opts);
+        if (opts.journal || opts.write_behind)
+        {
+            opts.journal = false;
+            opts.write_behind = false;
+            system_->SetPersistOptions(opts);
+        }
+    }
+
     // TODO: 打日志面板，不弹窗
-    (void)e;
 }
 
 void SS_WidgetLightResourceMain::HandleEvent_(const SS_LightEventFrame& e)
@@ -425,3 +420,60 @@ void SS_WidgetLightResourceMain::HandleEvent_(const SS_LightEventFrame& e)
     // TODO: TX/RX 打日志面板
     (void)e;
 }
+
+void SS_WidgetLightResourceMain::HandleEvent_(const SS_LightEventParamChanged& e)
+{
+    if (param_host_)
+        param_host_->ApplyParamChanged(e);
+}
+
+void SS_WidgetLightResourceMain::HandleEvent_(const SS_LightEventChannel& e)
+{
+    if (!controller_tree_) return;
+
+    const QString inst_id = QString::fromStdString(e.instance_id);
+    const QString ch_id = QString::fromStdString(e.channel_id);
+
+    switch (e.type)
+    {
+    case SS_LightEventType::CHANNEL_ADDED:
+    case SS_LightEventType::CHANNEL_RENAMED:
+        // AddChannel 已存在时只改名
+        controller_tree_->AddChannel(e.instance_id, e.channel_id, e.display_name);
+        break;
+
+    case SS_LightEventType::CHANNEL_REMOVED:
+        controller_tree_->RemoveChannel(inst_id, ch_id);
+        if (param_host_) param_host_->RemoveChannelPage(e.instance_id, e.channel_id);
+        if (current_instance_id_ == inst_id && current_channel_id_ == ch_id)
+        {
+            QString err;
+            (void)ShowController(inst_id, err);
+        }
+        break;
+
+    case SS_LightEventType::CHANNEL_REINDEXED:
+        // 树上不显示通道号；通道页的下拉框本身就是修改入口
+        break;
+
+    default:
+        break;
+    }
+}
+
+void SS_WidgetLightResourceMain::HandleEvent_(const SS_LightEventInstanceRenamed& e)
+{
+    if (controller_tree_)
+        controller_tree_->UpdateControllerTitle(QString::fromStdString(e.instance_id), QString::fromStdString(e.display_name));
+}
+
+void SS_WidgetLightResourceMain::HandleEvent_(const SS_LightEventConnectionConfig& e)
+{
+    if (!controller_tree_) return;
+
+    const QString id = QString::fromStdString(e.instance_id);
+    controller_tree_->SetControllerConnected(id, false); // 改配置会先断开
+
+    if (basic_info_panel_ && current_instance_id_ == id)
+        basic_info_panel_->SetConnectType(e.connection.connect_type);
+}
@@ -32,8 +32,6 @@ private slots:
     void SlotChannelSelected(const QString& instance_id, const QString& channel_id);
     void SlotAddControllerClicked();
     void SlotAddChannelClicked(const QString& instance_id);
-    void SlotInstanceUpdated(const QString& instance_id);
-    void SlotChannelUpdated(const QString& instance_id, const QString& channel_id);
 
 private:
     void InitQSS();
@@ -50,9 +48,17 @@ private:
     // variant handlers
     void HandleEvent_(const SS_LightEventBase&) {} // ignore
     void HandleEvent_(const SS_LightEventConnect& e);
+    void HandleEvent_(const SS_LightEventConnectBatch& e);
+    void HandleEvent_(const SS_LightEventStats&) {} // 定时统计默认关闭，暂不展示
     void HandleEvent_(const SS_LightEventError& e);
     void HandleEvent_(const SS_LightEventFrame& e);
 
+    // 模型变更：只改受影响的树节点/控件，不重新拉整个实例
+    void HandleEvent_(const SS_LightEventParamChanged& e);
+    void HandleEvent_(const SS_LightEventChannel& e);
+    void HandleEvent_(const SS_LightEventInstanceRenamed& e);
+    void HandleEvent_(const SS_LightEventConnectionConfig& e);
+
 private:
     SS_LightResourceSystem* system_ = nullptr;
 
@@ -66,6 +72,9 @@ private:
     SS_WidgetLightBasicInfoPanel* basic_info_panel_ = nullptr;
     SS_WidgetLightParamHost* param_host_ = nullptr;
 
+    // 启动时批量连接的批次号（只显示本窗口发起的批次进度）
+    uint64_t connect_batch_id_ = 0;
+
     QString current_instance_id_;
     QString current_channel_id_;
 
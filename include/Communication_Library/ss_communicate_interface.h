@@ -2,8 +2,12 @@
 
 #include <string>
 #include <functional>
+#include <algorithm>
 #include <vector>
 
+#include "ss_communicate_rx_buffer.h"
+#include "ss_communicate_stats.h"
+
 enum class CommunicateType
 {
     TCP_CLIENT,
@@ -35,6 +39,17 @@ struct ConnectionInfo
     int stop_bits_ = 1;        // 1/2
     int parity_ = 0;           // 0=None,1=Odd,2=Even
 
+    // TCP 低延迟选项（默认全关，沿用系统默认行为）
+    bool tcp_no_delay_ = false;   // TCP_NODELAY
+    bool tcp_quick_ack_ = false;  // TCP_QUICKACK（仅 Linux）
+    int socket_priority_ = -1;    // SO_PRIORITY（仅 Linux），-1 不设置
+    int busy_poll_us_ = 0;        // SO_BUSY_POLL（仅 Linux），0 不设置
+    int send_buffer_size_ = 0;    // SO_SNDBUF，0 不设置
+    int recv_buffer_size_ = 0;    // SO_RCVBUF，0 不设置
+    int io_cpu_affinity_ = -1;    // 接收线程绑定的 CPU 序号，-1 不绑定
+
+    int connect_timeout_ms_ = 0;  // TCP 解析+连接超时，0 阻塞（系统默认）
+
     ConnectionInfo& operator = (const ConnectionInfo& info)
     {
         if (this != &info) {
@@ -45,12 +60,22 @@ struct ConnectionInfo
             character_size_ = info.character_size_;
             stop_bits_ = info.stop_bits_;
             parity_ = info.parity_;
+            tcp_no_delay_ = info.tcp_no_delay_;
+            tcp_quick_ack_ = info.tcp_quick_ack_;
+            socket_priority_ = info.socket_priority_;
+            busy_poll_us_ = info.busy_poll_us_;
+            send_buffer_size_ = info.send_buffer_size_;
+            recv_buffer_size_ = info.recv_buffer_size_;
+            io_cpu_affinity_ = info.io_cpu_affinity_;
+            connect_timeout_ms_ = info.connect_timeout_ms_;
         }
         return *this;
     }
 };
 
 using DataCallback = std::function<void(std::string ip, std::vector<char>)>;
+// peer_id: TCP 为对端 ip，串口为 com 口；buffer 来自连接内缓冲池，回调内可直接持有，无需拷贝
+using RxBufferCallback = std::function<void(const std::string& peer_id, const CommunicateRxBufferPtr& buffer)>;
 using ErrorCallback = std::function<void(int, const std::string&)>;
 
 class CommunicateInterface
@@ -121,6 +146,34 @@ public:
      */
     virtual void SetDataCallback(DataCallback callback) = 0;
 
+    /**
+     * @brief call back data without copy
+     * @param  RxBufferCallback, buffer is a ref-counted block from the per-connection pool
+     * @return
+     * @note   default implementation adapts on top of SetDataCallback (one copy);
+     *         TCP client / serial override it with the pooled zero-copy path
+     */
+    virtual void SetRxBufferCallback(RxBufferCallback callback)
+    {
+        if (!callback)
+        {
+            SetDataCallback(nullptr);
+            return;
+        }
+        SetDataCallback([callback](std::string ip, std::vector<char> data) {
+            auto buffer = std::make_shared<CommunicateRxBuffer>(data.size());
+            std::copy(data.begin(), data.end(), buffer->WritableData());
+            buffer->SetSize(data.size());
+            callback(ip, buffer);
+        });
+    }
+
+    /**
+     * @brief traffic statistics of this connection (lock-free counters, snapshot copy)
+     * @return CommunicateStats; default implementation returns all zero
+     */
+    virtual CommunicateStats GetStats() const { return CommunicateStats{}; }
+
     /**
      * @brief call back erroe information
      * @param  std::function<void(int, const std::string&)>;, int is error index, string is error description
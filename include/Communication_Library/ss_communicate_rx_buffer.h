@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief 接收缓冲块：由连接内的 CommunicateRxBufferPool 分配，引用计数管理
+ *        回调方持有 shared_ptr 期间数据有效；全部引用释放后该块回到池中复用
+ */
+class CommunicateRxBuffer
+{
+public:
+    explicit CommunicateRxBuffer(size_t capacity) : bytes_(capacity) {}
+
+    const char* data() const { return bytes_.data(); }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    // 以下只给接收线程（生产者）用
+    char* WritableData() { return bytes_.data(); }
+    size_t Capacity() const { return bytes_.size(); }
+    void SetSize(size_t n) { size_ = n < bytes_.size() ? n : bytes_.size(); }
+
+private:
+    std::vector<char> bytes_;
+    size_t size_ = 0;
+};
+
+using CommunicateRxBufferPtr = std::shared_ptr<const CommunicateRxBuffer>;
+
+/**
+ * @brief 每个连接一个的接收缓冲池
+ *        池里保存 shared_ptr，use_count()==1 说明没有回调方还在引用，可直接复用
+ *        稳态下收包不再产生堆分配；Acquire 只能由单个接收线程调用
+ */
+class CommunicateRxBufferPool
+{
+public:
+    explicit CommunicateRxBufferPool(size_t block_size = 4096, size_t max_blocks = 64)
+        : block_size_(block_size)
+        , max_blocks_(max_blocks)
+    {
+    }
+
+    std::shared_ptr<CommunicateRxBuffer> Acquire()
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+
+        const size_t n = blocks_.size();
+        for (size_t k = 0; k < n; ++k)
+        {
+            const size_t i = (cursor_ + k) % n;
+            if (blocks_[i].use_count() == 1)
+            {
+                // 与回调方最后一次读取同步后再复写
+                std::atomic_thread_fence(std::memory_order_acquire);
+                cursor_ = (i + 1) % n;
+                blocks_[i]->SetSize(0);
+                return blocks_[i];
+            }
+        }
+
+        auto block = std::make_shared<CommunicateRxBuffer>(block_size_);
+        // 池满（回调方长期持有）时退化为一次性分配，不阻塞接收
+        if (blocks_.size() < max_blocks_)
+            blocks_.push_back(block);
+        return block;
+    }
+
+    size_t BlockSize() const { return block_size_; }
+
+    // 调试/统计：池中已分配的块数
+    size_t PooledCount() const
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        return blocks_.size();
+    }
+
+private:
+    size_t block_size_;
+    size_t max_blocks_;
+
+    mutable std::mutex mtx_;
+    std::vector<std::shared_ptr<CommunicateRxBuffer>> blocks_;
+    size_t cursor_ = 0;
+};
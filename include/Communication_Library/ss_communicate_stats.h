@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief 延迟直方图快照：桶 i 统计落在 [2^i, 2^(i+1)) 微秒内的样本数（桶 0 含 0us）
+ */
+struct CommunicateLatencySnapshot
+{
+    static constexpr size_t kBuckets = 32;
+
+    uint64_t count = 0;
+    uint64_t total_us = 0;
+    uint64_t max_us = 0;
+    std::array<uint64_t, kBuckets> buckets{};
+
+    uint64_t AverageUs() const { return count ? total_us / count : 0; }
+
+    // 按桶上界估算分位数（q = 0.5 / 0.99 ...）
+    uint64_t PercentileUs(double q) const
+    {
+        if (count == 0) return 0;
+        const uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i)
+        {
+            seen += buckets[i];
+            if (seen >= rank)
+            {
+                const uint64_t upper = (uint64_t(1) << (i + 1)) - 1;
+                return upper < max_us ? upper : max_us;
+            }
+        }
+        return max_us;
+    }
+};
+
+/**
+ * @brief 无锁延迟直方图：Record 只有几次 relaxed 原子操作，可在收发线程直接调用
+ */
+class CommunicateLatencyHistogram
+{
+public:
+    void Record(uint64_t us)
+    {
+        size_t idx = 0;
+        for (uint64_t v = us; v > 1 && idx + 1 < CommunicateLatencySnapshot::kBuckets; v >>= 1)
+            ++idx;
+
+        buckets_[idx].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        total_us_.fetch_add(us, std::memory_order_relaxed);
+
+        uint64_t prev = max_us_.load(std::memory_order_relaxed);
+        while (us > prev && !max_us_.compare_exchange_weak(prev, us, std::memory_order_relaxed)) {}
+    }
+
+    CommunicateLatencySnapshot Snapshot() const
+    {
+        CommunicateLatencySnapshot s;
+        s.count = count_.load(std::memory_order_relaxed);
+        s.total_us = total_us_.load(std::memory_order_relaxed);
+        s.max_us = max_us_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < CommunicateLatencySnapshot::kBuckets; ++i)
+            s.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, CommunicateLatencySnapshot::kBuckets> buckets_{};
+    std::atomic<uint64_t> count_{ 0 };
+    std::atomic<uint64_t> total_us_{ 0 };
+    std::atomic<uint64_t> max_us_{ 0 };
+};
+
+/**
+ * @brief 连接级统计快照（GetStats 返回）
+ */
+struct CommunicateStats
+{
+    uint64_t bytes_tx = 0;
+    uint64_t bytes_rx = 0;
+    uint64_t writes = 0;          // 成功的 WriteData 次数
+    uint64_t reads = 0;           // 收到数据的读取次数
+    uint64_t write_errors = 0;
+    uint64_t read_errors = 0;
+    uint64_t connects = 0;        // 成功连接次数，> 1 表示发生过重连
+
+    CommunicateLatencySnapshot write_latency;   // 单次 WriteData 阻塞耗时
+};
+
+/**
+ * @brief 连接内部持有的计数器（全部 relaxed 原子，读快照不加锁）
+ */
+class CommunicateStatsCounters
+{
+public:
+    void OnWrite(uint64_t bytes, uint64_t latency_us)
+    {
+        bytes_tx_.fetch_add(bytes, std::memory_order_relaxed);
+        writes_.fetch_add(1, std::memory_order_relaxed);
+        write_latency_.Record(latency_us);
+    }
+    void OnRead(uint64_t bytes)
+    {
+        bytes_rx_.fetch_add(bytes, std::memory_order_relaxed);
+        reads_.fetch_add(1, std::memory_order_relaxed);
+    }
+    void OnWriteError() { write_errors_.fetch_add(1, std::memory_order_relaxed); }
+    void OnReadError() { read_errors_.fetch_add(1, std::memory_order_relaxed); }
+    void OnConnected() { connects_.fetch_add(1, std::memory_order_relaxed); }
+
+    CommunicateStats Snapshot() const
+    {
+        CommunicateStats s;
+        s.bytes_tx = bytes_tx_.load(std::memory_order_relaxed);
+        s.bytes_rx = bytes_rx_.load(std::memory_order_relaxed);
+        s.writes = writes_.load(std::memory_order_relaxed);
+        s.reads = reads_.load(std::memory_order_relaxed);
+        s.write_errors = write_errors_.load(std::memory_order_relaxed);
+        s.read_errors = read_errors_.load(std::memory_order_relaxed);
+        s.connects = connects_.load(std::memory_order_relaxed);
+        s.write_latency = write_latency_.Snapshot();
+        return s;
+    }
+
+    static uint64_t ElapsedUs(std::chrono::steady_clock::time_point since)
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - since).count());
+    }
+
+private:
+    std::atomic<uint64_t> bytes_tx_{ 0 };
+    std::atomic<uint64_t> bytes_rx_{ 0 };
+    std::atomic<uint64_t> writes_{ 0 };
+    std::atomic<uint64_t> reads_{ 0 };
+    std::atomic<uint64_t> write_errors_{ 0 };
+    std::atomic<uint64_t> read_errors_{ 0 };
+    std::atomic<uint64_t> connects_{ 0 };
+    CommunicateLatencyHistogram write_latency_;
+};
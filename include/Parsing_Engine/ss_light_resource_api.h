@@ -18,6 +18,8 @@ class SS_LightResourceManager;
 class SS_LightEventBus;
 
 // - 所有错误通过 out_error 返回
+// - Init / Shutdown 之外的接口可在任意线程调用：同一实例的写操作按实例串行，
+//   GetInstance 等读接口读取不可变快照，不会被连接/发送中的写操作阻塞
 class SS_LIGHT_RESOURCE_API SS_LightResourceSystem
 {
 public:
@@ -30,12 +32,17 @@ public:
     bool ReloadTemplates(std::string& out_error);
     std::vector<std::string> ListTemplateIds() const;
     bool GetTemplate(const std::string& template_id, SS_LightControllerTemplate& out_tpl) const;
+    // 共享只读句柄，不拷贝模板（UI 展示优先用这个）；未找到返回空
+    std::shared_ptr<const SS_LightControllerTemplate> GetTemplateShared(const std::string& template_id) const;
 
     // -------- Instances --------
     bool ReloadInstances(std::string& out_error);
     bool LoadInstanceFile(const std::string& instance_yaml_path, std::string& out_error);
     std::vector<std::string> ListInstanceIds() const;
     bool GetInstance(const std::string& instance_id, SS_LightControllerInstance& out_inst) const;
+    // 共享只读快照，不拷贝实例（UI 展示优先用这个）；未找到返回空
+    // 快照不随后续修改变化，修改后需重新获取
+    std::shared_ptr<const SS_LightControllerInstance> GetInstanceShared(const std::string& instance_id) const;
 
     bool CreateInstanceFromTemplate(const std::string& template_id, const std::string& display_name, std::string& out_instance_id, std::string& out_error);
 
@@ -43,6 +50,24 @@ public:
     bool ResolveInstancePath(const std::string& instance_id, std::string& out_path, std::string& out_error) const;
     bool SaveInstanceById(const std::string& instance_id, std::string& out_error);
     bool DeleteInstanceById(const std::string& instance_id, std::string& out_error);
+    // 延迟保存：频繁修改（拖动）时用，后台 debounce 后合并写一次；Shutdown 前自动写完
+    bool SaveInstanceDeferred(const std::string& instance_id, std::string& out_error);
+    bool FlushPendingSaves(std::string& out_error);
+    void SetPersistOptions(const SS_LightPersistOptions& opts);
+    void GetPersistOptions(SS_LightPersistOptions& out_opts) const;
+    void GetPersistStats(SS_LightPersistStats& out_stats) const;
+    // 修改日志（<instance_dir>/journal/）立即折叠进 *_instance.yaml；平时后台按 compact_interval_ms 自动执行
+    bool CompactJournal(std::string& out_error);
+
+    // -------- Recipes --------
+    // 配方：实例的一组命名参数值，存放在 <instance_dir>/recipes/<instance_id>/
+    // 保存时按模板校验并预编译帧；应用时只写入/发送与当前值不同的项（full = true 时全部），实例只保存一次
+    bool SaveRecipe(const SS_LightRecipe& recipe, std::string& out_error);
+    bool CaptureRecipe(const std::string& instance_id, const std::string& recipe_id, const std::string& display_name, std::string& out_error);
+    bool DeleteRecipe(const std::string& instance_id, const std::string& recipe_id, std::string& out_error);
+    std::vector<std::string> ListRecipeIds(const std::string& instance_id) const;
+    bool GetRecipe(const std::string& instance_id, const std::string& recipe_id, SS_LightRecipe& out_recipe) const;
+    bool ApplyRecipe(const std::string& instance_id, const std::string& recipe_id, bool full, SS_LightRecipeApplyResult& out_result, std::string& out_error);
 
     // -------- UI-ish ops (metadata / channels) --------
     bool RenameController(const std::string& instance_id, const std::string& new_display_name);
@@ -56,15 +81,53 @@ public:
 
     bool SetChannelIndex(const std::string& instance_id, const std::string& channel_id, int new_channel_index, std::string& out_error);
 
+    // 预解析通道句柄，填入 SS_LightParamSetRequest::channel_handle 可省去每次按 channel_id 查找
+    // 增删通道后句柄可能失效（请求会自动退回按 channel_id 查找），需要时重新解析
+    bool ResolveChannelHandle(const std::string& instance_id, const std::string& channel_id, int& out_handle, std::string& out_error) const;
+
     // -------- Minimal send loop --------
     bool ConnectInstance(const std::string& instance_id, std::string& out_error);
     bool DisconnectInstance(const std::string& instance_id, std::string& out_error);
+
+    // 批量并发连接：立即返回，进度走 CONNECT_BATCH_PROGRESS / CONNECT_BATCH_FINISHED 事件
+    bool ConnectAll(const SS_LightConnectBatchOptions& opts, uint64_t& out_batch_id, std::string& out_error);
+    bool ConnectInstances(const std::vector<std::string>& instance_ids, const SS_LightConnectBatchOptions& opts, uint64_t& out_batch_id, std::string& out_error);
+    void CancelConnectBatch();
+    bool IsConnectBatchRunning() const;
     bool SetParameterValue(const SS_LightParamSetRequest& req, SS_LightParamSetResult& out_result);      // build only
     bool SetParameterAndSend(const SS_LightParamSetRequest& req, SS_LightParamSetResult& out_result);   // build + send
 
+    // 批量写入（配方/导入）：先整体校验并生成全部帧，任一项失败整批不写入（out_result.failed_index）
+    // 通过后一次写入、按顺序发送（STRING 命令可合并为一次写入），整批只保存一次
+    bool ApplyBatch(const std::string& instance_id, const std::vector<SS_LightParamSetRequest>& reqs, SS_LightBatchResult& out_result, std::string& out_error);
+
+    // 合并发送（拖动/连续输入）：同一 (参数, 通道) 只发最新值，被覆盖的中间值记在 superseded_values
+    // out_sent 为本次实际发出的结果（为空 = 已挂起）；有挂起值时 UI 需定时调用 FlushParameterUpdates
+    bool SubmitParameterCoalesced(const SS_LightParamSetRequest& req, std::vector<SS_LightCoalescedResult>& out_sent, std::string& out_error);
+    void FlushParameterUpdates(const std::string& instance_id, bool force, std::vector<SS_LightCoalescedResult>& out_sent);
+    bool HasPendingParameterUpdates(const std::string& instance_id) const;
+    void SetCoalesceOptions(const SS_LightCoalesceOptions& opts);
+
+    // 自动发现：并发探测串口 x 波特率、网段 x 端口，返回命中的 (template_id, connection)
+    // 阻塞数秒，UI 请在工作线程调用
+    bool DiscoverDevices(const SS_LightDiscoveryOptions& opts, std::vector<SS_LightDiscoveryCandidate>& out_candidates, std::string& out_error);
+
     // 更新连接配置（给 UI 用）
     bool UpdateConnectionConfig(const std::string& instance_id, const SS_LightConnectionConfig& conn, std::string& out_error);
 
+    // -------- Traffic capture (record / replay) --------
+    // 录制所有实例的收发到 capture_path（二进制追加，单文件）
+    bool StartTrafficRecording(const std::string& capture_path, std::string& out_error);
+    void StopTrafficRecording();
+    // 实例下次 Connect 改为回放 capture_path 中该实例的 RX；capture_path 为空恢复真实连接
+    bool SetInstanceReplaySource(const std::string& instance_id, const std::string& capture_path, double speed, std::string& out_error);
+
+    // -------- Connection statistics --------
+    // 快照：收发帧/字节、发送耗时与 RTT 直方图、超时/校验失败/重试/重连，及底层链路计数（共享总线/网关为整条链路）
+    bool GetConnectionStats(const std::string& instance_id, SS_LightConnectionStats& out_stats, std::string& out_error) const;
+    // 每 interval_ms 发布 CONNECTION_STATS 事件（统计线程回调，UI 需自行切线程）；<= 0 关闭，默认关闭
+    void SetStatsEventInterval(int interval_ms);
+
     SS_LightEventBus::Subscription SubscribeEvents(SS_LightEventBus::Handler cb);
     SS_LightEventBus& GetEventBus() { return event_bus_; }
     const SS_LightEventBus& GetEventBus() const { return event_bus_; }
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "ss_light_resource_types.h"
+#include "ss_light_resource_param_values.h"
 
 // BYTE模式下数据包封装参数，如：ModbusTCP的MBAP头，CRC/LRC校验等
 struct SS_LightByteTransmissionParams
@@ -15,9 +16,22 @@ struct SS_LightByteTransmissionParams
     bool crc_endian = false;
 };
 
+// 设备识别规则（自动发现用）：向候选连接发送 request，应答中包含 response 即认定为该模板
+// - STRING：request / response 为原样字符串
+// - BYTE：request 为裸 PDU 的 hex（按 byte_transmission_params 封装地址/MBAP/CRC），response 为应答中应包含的 hex 片段
+struct SS_LightIdentifyRule
+{
+    std::string request;
+    std::string response;
+    int timeout_ms = 200;   // 单个候选连接上的等待时间
+    int tcp_port = 0;       // 网口探测端口；0 表示该模板不做网口探测
+};
+
 // 模板模型信息，包含控制器层面的信息
 struct SS_LightTemplateInfo
 {
+    static constexpr int kDefaultReplyTimeoutMs = 200;
+
     std::string template_id;
     std::string template_version;
 
@@ -33,6 +47,15 @@ struct SS_LightTemplateInfo
     SS_LIGHT_PROTOCOL_TYPE protocol_type = SS_LIGHT_PROTOCOL_TYPE::UNKNOWN;
 
     SS_LightByteTransmissionParams byte_transmission_params;
+
+    // 串口两条命令之间的最小间隔（ms），部分型号命令过密会丢帧；0 表示不限制
+    int inter_command_gap_ms = 0;
+
+    // 应答超时（ms）：串口总线从应答应当收完时起算，连接统计按同一值判定超时
+    int reply_timeout_ms = kDefaultReplyTimeoutMs;
+
+    // 可选：request 为空表示该模板不参与自动发现
+    SS_LightIdentifyRule identify;
 };
 
 struct SS_LightControllerTemplate
@@ -42,6 +65,9 @@ struct SS_LightControllerTemplate
     // key -> param definition
     std::unordered_map<std::string, SS_LightParamDef> params;
 
+    // params 的稠密 id 表（载入时由 SS_LightBuildParamIndex 生成，实例按它存值）
+    std::shared_ptr<const SS_LightParamIndex> param_index;
+
     // optional UI hints (keep minimal now)
     std::vector<std::string> global_order;
     std::vector<std::string> channel_order;
@@ -68,6 +94,30 @@ struct SS_LightSerialConfig
     int parity = 0;
 };
 
+// 常用波特率（连接面板下拉框 / 自动发现默认扫描列表共用）
+inline const std::vector<int>& SS_LightCommonBaudRates()
+{
+    static const std::vector<int> baud_list = {
+        1200, 2400, 4800, 9600,
+        14400, 19200, 38400,
+        57600, 115200,
+        230400, 460800, 921600
+    };
+    return baud_list;
+}
+
+// 网口低延迟配置（频闪/触发类控制器用）；默认全关，沿用系统默认行为
+struct SS_LightSocketLatencyProfile
+{
+    bool tcp_no_delay = false;   // 关闭 Nagle，小包立即发出
+    bool tcp_quick_ack = false;  // TCP_QUICKACK（仅 Linux）
+    int socket_priority = -1;    // SO_PRIORITY 0~6（仅 Linux），-1 不设置
+    int busy_poll_us = 0;        // SO_BUSY_POLL 微秒（仅 Linux），0 不设置
+    int send_buffer_size = 0;    // SO_SNDBUF 字节，0 不设置
+    int recv_buffer_size = 0;    // SO_RCVBUF 字节，0 不设置
+    int io_cpu_affinity = -1;    // 接收线程绑定的 CPU 序号，-1 不绑定
+};
+
 struct SS_LightSocketConfig
 {
     std::string ip_address;
@@ -77,6 +127,11 @@ struct SS_LightSocketConfig
 
     std::string destination_ip_address;
     int destination_port = 0;
+
+    // 单次 TCP 连接（含 DNS 解析）超时；0 = 阻塞直到系统超时
+    int connect_timeout_ms = 0;
+
+    SS_LightSocketLatencyProfile latency_profile;
 };
 
 // 控制器通讯连接模型
@@ -97,9 +152,116 @@ struct SS_LightControllerInstance
     // 控制器列表中已经添加的通道（光源）子条目
     std::vector<SS_LightChannelItem> channels;
 
-    // 全局通道的值（key -> value_str）
-    std::unordered_map<std::string, std::string> global_param_values;
+    // 参数值：绑定模板 param_index 后按 [param_id][通道槽位] 稠密存储
+    // 按字符串读写用 FindGlobal / FindChannel / SetGlobal / SetChannel
+    SS_LightParamValues param_values;
+};
+
+// 配方：某个实例的一组命名参数值（产品换型时整体切换）
+// 持久化在 <instance_dir>/recipes/<instance_id>/<recipe_id>_recipe.yaml
+struct SS_LightRecipe
+{
+    std::string recipe_id;
+    std::string instance_id;
+    std::string display_name;
 
-    // 通道级参数值(channel_id -> value_str)
+    // 与实例 YAML 中 parameters_value 相同的结构；只列出配方关心的参数
+    std::unordered_map<std::string, std::string> global_param_values;
     std::unordered_map<std::string, std::unordered_map<std::string, std::string>> channel_param_values;
 };
+
+// 配方应用结果
+struct SS_LightRecipeApplyResult
+{
+    int total = 0;                                 // 配方中的参数项数
+    bool recompiled = false;                       // 本次是否重新生成了预编译帧（模板/配方/通道布局变化）
+    std::vector<SS_LightParamSetRequest> changed;  // 与当前值不同、实际写入的项（full 时为全部）
+    SS_LightBatchResult batch;                     // batch.results 与 changed 一一对应
+};
+
+// 自动发现选项
+struct SS_LightDiscoveryOptions
+{
+    // 串口：空 = 枚举本机串口；baud_rates 空 = SS_LightCommonBaudRates()
+    bool scan_serial = true;
+    std::vector<std::string> serial_ports;
+    std::vector<int> baud_rates;
+    SS_LightSerialConfig serial_format;   // 只取数据位/停止位/校验
+
+    // 网口：每项按 ip_address + subnet_mask 展开网段内主机
+    // destination_port > 0 时所有模板都探测该端口，否则用模板 identify.tcp_port
+    std::vector<SS_LightSocketConfig> subnets;
+    int max_hosts_per_subnet = 1024;
+
+    // 空 = 所有配置了 identify 的模板
+    std::vector<std::string> template_ids;
+
+    int max_concurrency = 32;   // 同时探测的候选连接数上限
+};
+
+// 自动发现结果
+struct SS_LightDiscoveryCandidate
+{
+    std::string template_id;
+    SS_LightConnectionConfig connection;
+    std::string response_printable;   // 命中的应答（STRING 原样 / BYTE 为 hex）
+};
+
+// 批量连接选项（ConnectAll / ConnectInstances）
+struct SS_LightConnectBatchOptions
+{
+    int max_concurrency = 8;        // 同时进行的连接尝试数上限
+    int attempt_timeout_ms = 3000;  // 单次尝试超时（仅网口；实例自身配置了 connect_timeout_ms 时以实例为准）
+    int max_attempts = 1;           // 每个实例最多尝试次数
+    bool skip_disabled = true;      // ConnectAll 跳过 enabled=false 的实例
+};
+
+// 延迟统计（log2 直方图：buckets[i] 为落在 [2^i, 2^(i+1)) us 的样本数）
+struct SS_LightLatencyStats
+{
+    uint64_t count = 0;
+    uint64_t total_us = 0;
+    uint64_t max_us = 0;
+    uint64_t p50_us = 0;   // 按桶上界估算
+    uint64_t p99_us = 0;
+    std::vector<uint64_t> buckets;
+};
+
+// 底层链路统计（CommunicateLibrary 连接）
+// shared = true 时链路由多个实例共用（RS-485 总线 / Modbus TCP 网关），数值为整条链路合计
+struct SS_LightLinkStats
+{
+    bool available = false;
+    bool shared = false;
+    uint64_t bytes_tx = 0;
+    uint64_t bytes_rx = 0;
+    uint64_t writes = 0;
+    uint64_t reads = 0;
+    uint64_t write_errors = 0;
+    uint64_t read_errors = 0;
+    uint64_t connects = 0;
+    SS_LightLatencyStats write_latency;   // 单次写入驱动/socket 的阻塞耗时
+};
+
+// 实例连接统计（GetConnectionStats / CONNECTION_STATS 事件）
+struct SS_LightConnectionStats
+{
+    std::string instance_id;
+    bool connected = false;
+
+    uint64_t frames_tx = 0;
+    uint64_t frames_rx = 0;
+    uint64_t bytes_tx = 0;
+    uint64_t bytes_rx = 0;
+    uint64_t send_failures = 0;
+
+    uint64_t timeouts = 0;       // 应答超时（2005）
+    uint64_t crc_failures = 0;   // 应答校验/成帧失败（2006）
+    uint64_t retries = 0;        // 批量连接中的重试次数
+    uint64_t reconnects = 0;     // 第二次及以后的成功连接
+
+    SS_LightLatencyStats send_latency;   // SendBytes 耗时（共享链路上为入队耗时）
+    SS_LightLatencyStats rtt;            // 发送到收到首个应答
+
+    SS_LightLinkStats link;
+};